@@ -0,0 +1,93 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "benchmark/benchmark.h"
+#include "ingest/order_columns.h"
+#include "ingest/order_reader.h"
+
+namespace kitchen_sim {
+namespace {
+
+constexpr const char* kNames[] = {"Banana Split", "Cheese Pizza", "Pad See Ew",
+                                  "Pressed Juice", "Spicy Ramen"};
+constexpr const char* kTemps[] = {"hot", "cold", "frozen"};
+
+// Writes |count| orders with UUID IDs to temporary files, as
+// newline-delimited JSON and as order columns, and removes them once done.
+class OrderFiles {
+ public:
+  explicit OrderFiles(size_t count)
+      : json_path_(absl::StrCat("/tmp/ingest_benchmark_", count, ".ndjson")),
+        columns_path_(
+            absl::StrCat("/tmp/ingest_benchmark_", count, ".columns")) {
+    std::ofstream json(json_path_);
+    for (size_t i = 0; i < count; ++i) {
+      json << absl::StrFormat(
+          "{\"id\": \"%08x-7f24-4420-a5ba-%012x\", \"name\": \"%s\", "
+          "\"temp\": \"%s\", \"shelfLife\": %d, \"decayRate\": %.2f}\n",
+          i * 2654435761u % (1ull << 32), i, kNames[i % 5], kTemps[i % 3],
+          100 + i % 300, 0.1 + (i % 90) / 100.);
+    }
+    json.close();
+
+    const RealClock clock;
+    auto reader = OpenOrderReader(json_path_, &clock, {});
+    OrderColumnsWriter writer;
+    for (auto it = reader->begin(); it != reader->end(); ++it) {
+      writer.Add(**it);
+    }
+    std::ofstream columns(columns_path_, std::ios::binary);
+    writer.WriteTo(columns);
+  }
+  ~OrderFiles() {
+    std::remove(json_path_.c_str());
+    std::remove(columns_path_.c_str());
+  }
+
+  const std::string& JsonPath() const { return json_path_; }
+  const std::string& ColumnsPath() const { return columns_path_; }
+
+ private:
+  const std::string json_path_;
+  const std::string columns_path_;
+};
+
+// Parses |state.range(0)| orders from newline-delimited JSON.
+void BM_LoadJson(benchmark::State& state) {
+  const OrderFiles files(state.range(0));
+  const VirtualClock clock;
+  for (auto _ : state) {
+    auto reader = OpenOrderReader(files.JsonPath(), &clock, {});
+    for (auto it = reader->begin(); it != reader->end(); ++it) {
+      benchmark::DoNotOptimize((*it).get());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LoadJson)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Unit(benchmark::kMillisecond);
+
+// Loads the same orders from an order columns file.
+void BM_LoadColumns(benchmark::State& state) {
+  const OrderFiles files(state.range(0));
+  const VirtualClock clock;
+  for (auto _ : state) {
+    OrderColumnsReader reader(files.ColumnsPath(), &clock);
+    for (auto it = reader.begin(); it != reader.end(); ++it) {
+      benchmark::DoNotOptimize((*it).get());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LoadColumns)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace kitchen_sim
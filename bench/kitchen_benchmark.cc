@@ -0,0 +1,300 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench/synthetic_orders.h"
+#include "benchmark/benchmark.h"
+#include "events/event_sink.h"
+#include "model/kitchen.h"
+#include "model/value_curves.h"
+#include "runtime/binary_io.h"
+#include "runtime/eventual.h"
+#include "runtime/scheduler.h"
+
+namespace kitchen_sim {
+namespace {
+
+// Orders taken per timed batch where a kitchen's steady state allows it.
+constexpr size_t kBatchSize = 1024;
+
+// A kitchen whose shelves (overflow included) each hold |capacity| orders, with
+// logging disabled.
+struct KitchenFixture {
+  explicit KitchenFixture(int capacity)
+      : kitchen(
+            [&] {
+              Kitchen::Options options = {
+                  "bench", KitchenLayout::Uniform(capacity, capacity),
+                  /*seed=*/1};
+              options.event_sink = &sink;
+              options.shelf_log_interval = absl::InfiniteDuration();
+              return options;
+            }(),
+            &scheduler) {}
+
+  NullEventSink sink;
+  VirtualScheduler scheduler;
+  Kitchen kitchen;
+};
+
+// Fills an empty temperature shelf.
+void BM_TakeOrder(benchmark::State& state) {
+  const int capacity = state.range(0);
+  std::unique_ptr<KitchenFixture> fixture;
+  for (auto _ : state) {
+    state.PauseTiming();
+    fixture = std::make_unique<KitchenFixture>(capacity);
+    auto orders =
+        SyntheticOrders(capacity, /*seed=*/1, 0, TemperatureType::HOT);
+    state.ResumeTiming();
+    for (auto& order : orders) {
+      benchmark::DoNotOptimize(
+          fixture->kitchen.TakeOrder(std::move(order), absl::UnixEpoch()));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * capacity);
+}
+BENCHMARK(BM_TakeOrder)->RangeMultiplier(8)->Range(8, 4096);
+
+// Like BM_TakeOrder, but takes the orders as a single batch.
+void BM_TakeOrders(benchmark::State& state) {
+  const int capacity = state.range(0);
+  std::unique_ptr<KitchenFixture> fixture;
+  for (auto _ : state) {
+    state.PauseTiming();
+    fixture = std::make_unique<KitchenFixture>(capacity);
+    auto orders =
+        SyntheticOrders(capacity, /*seed=*/1, 0, TemperatureType::HOT);
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(
+        fixture->kitchen.TakeOrders(absl::MakeSpan(orders), absl::UnixEpoch()));
+  }
+  state.SetItemsProcessed(state.iterations() * capacity);
+}
+BENCHMARK(BM_TakeOrders)->RangeMultiplier(8)->Range(8, 4096);
+
+// Empties a full temperature shelf.
+void BM_PickupOrder(benchmark::State& state) {
+  const int capacity = state.range(0);
+  std::vector<std::string> ids;
+  for (int i = 0; i < capacity; ++i) {
+    ids.push_back(std::to_string(i));
+  }
+  std::unique_ptr<KitchenFixture> fixture;
+  for (auto _ : state) {
+    state.PauseTiming();
+    fixture = std::make_unique<KitchenFixture>(capacity);
+    for (auto& order :
+         SyntheticOrders(capacity, /*seed=*/1, 0, TemperatureType::HOT)) {
+      fixture->kitchen.TakeOrder(std::move(order), absl::UnixEpoch());
+    }
+    state.ResumeTiming();
+    for (const std::string& id : ids) {
+      benchmark::DoNotOptimize(
+          fixture->kitchen.PickupOrder(id, absl::UnixEpoch()));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * capacity);
+}
+BENCHMARK(BM_PickupOrder)->RangeMultiplier(8)->Range(8, 4096);
+
+// Takes orders into a kitchen whose HOT and overflow shelves are full, so that
+// each one has to make overflow room by discarding.
+void BM_MakeOverflowRoom(benchmark::State& state) {
+  const int capacity = state.range(0);
+  std::unique_ptr<KitchenFixture> fixture;
+  std::vector<std::unique_ptr<Order>> orders;
+  size_t next = 0;
+  uint32_t batch = 0;
+  for (auto _ : state) {
+    if (next == orders.size()) {
+      // Every discard cancels an expiry timer that stays queued in the
+      // scheduler until due, so each batch starts over with a fresh kitchen
+      // rather than let them pile up.
+      state.PauseTiming();
+      fixture.reset();
+      fixture = std::make_unique<KitchenFixture>(capacity);
+      for (auto& order :
+           SyntheticOrders(2 * capacity, /*seed=*/1, 0, TemperatureType::HOT)) {
+        fixture->kitchen.TakeOrder(std::move(order), absl::UnixEpoch());
+      }
+      orders = SyntheticOrders(kBatchSize, ++batch, 2 * capacity,
+                               TemperatureType::HOT);
+      next = 0;
+      state.ResumeTiming();
+    }
+    benchmark::DoNotOptimize(fixture->kitchen.TakeOrder(
+        std::move(orders[next++]), absl::UnixEpoch()));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MakeOverflowRoom)->RangeMultiplier(8)->Range(8, 4096);
+
+// Fills every shelf of a kitchen, overflow included, with orders of random
+// temperatures, some of which get discarded.
+void FillShelves(KitchenFixture* fixture, int capacity) {
+  for (auto& order : SyntheticOrders(4 * capacity, /*seed=*/1)) {
+    fixture->kitchen.TakeOrder(std::move(order), absl::UnixEpoch());
+  }
+}
+
+// Checkpoints a kitchen with full shelves.
+void BM_CheckpointKitchen(benchmark::State& state) {
+  const int capacity = state.range(0);
+  KitchenFixture fixture(capacity);
+  FillShelves(&fixture, capacity);
+  std::string checkpoint;
+  for (auto _ : state) {
+    checkpoint.clear();
+    BinaryWriter writer(&checkpoint);
+    fixture.kitchen.Checkpoint(&writer);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          fixture.scheduler.PendingCount());
+  state.SetBytesProcessed(state.iterations() * checkpoint.size());
+}
+BENCHMARK(BM_CheckpointKitchen)->RangeMultiplier(8)->Range(512, 32768);
+
+// Restores the checkpoint of a kitchen with full shelves, rearming the
+// orders' expiry timers.
+void BM_RestoreKitchen(benchmark::State& state) {
+  const int capacity = state.range(0);
+  KitchenFixture original(capacity);
+  FillShelves(&original, capacity);
+  std::string checkpoint;
+  BinaryWriter writer(&checkpoint);
+  original.kitchen.Checkpoint(&writer);
+
+  std::unique_ptr<KitchenFixture> fixture;
+  for (auto _ : state) {
+    state.PauseTiming();
+    fixture.reset();
+    fixture = std::make_unique<KitchenFixture>(capacity);
+    state.ResumeTiming();
+    RestoredTimers timers;
+    BinaryReader reader(checkpoint);
+    fixture->kitchen.Restore(&reader, &timers);
+    timers.ScheduleAll(&fixture->scheduler);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          original.scheduler.PendingCount());
+  state.SetBytesProcessed(state.iterations() * checkpoint.size());
+}
+BENCHMARK(BM_RestoreKitchen)
+    ->RangeMultiplier(8)
+    ->Range(512, 32768)
+    ->Unit(benchmark::kMillisecond);
+
+// Cost of handing back an already available result through a promise and
+// future, as TakeOrder() and PickupCurrentOrder() used to, versus an Eventual.
+void BM_ReadyFuture(benchmark::State& state) {
+  Order* order = nullptr;
+  for (auto _ : state) {
+    fibers::promise<Order*> promise;
+    promise.set_value(order);
+    benchmark::DoNotOptimize(WaitAndGet(promise.get_future()));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ReadyFuture);
+
+void BM_ReadyEventual(benchmark::State& state) {
+  Order* order = nullptr;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(WaitAndGet(Eventual<Order*>(order)));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ReadyEventual);
+
+void BM_OrderValue(benchmark::State& state) {
+  auto order = Order::CreateOrder("1", "bench", TemperatureType::HOT, 300,
+                                  0.5, absl::UnixEpoch());
+  order->SetFulfillmentTime(absl::UnixEpoch());
+  int64_t ms = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        order->Value(1, absl::UnixEpoch() + absl::Milliseconds(ms)));
+    ms = (ms + 1) % 300000;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_OrderValue);
+
+void BM_OrderExpiry(benchmark::State& state) {
+  auto order = Order::CreateOrder("1", "bench", TemperatureType::HOT, 300,
+                                  0.5, absl::UnixEpoch());
+  order->SetFulfillmentTime(absl::UnixEpoch());
+  int modifier = 1;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(order->Expiry(modifier));
+    modifier = 3 - modifier;  // Alternate between shelf kinds.
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_OrderExpiry);
+
+// Values every order on a shelf of |capacity| orders one at a time, as shelf
+// logging and lowest-value eviction used to, versus in one pass over their
+// value curves.
+std::vector<std::unique_ptr<Order>> CookedOrders(size_t count) {
+  auto orders = SyntheticOrders(count, /*seed=*/1, 0, TemperatureType::HOT);
+  for (auto& order : orders) {
+    order->SetFulfillmentTime(absl::UnixEpoch());
+  }
+  return orders;
+}
+
+void BM_ValueShelfPerOrder(benchmark::State& state) {
+  const auto orders = CookedOrders(state.range(0));
+  std::vector<double> values(orders.size());
+  int64_t ms = 0;
+  for (auto _ : state) {
+    const absl::Time at_time = absl::UnixEpoch() + absl::Milliseconds(ms);
+    for (size_t i = 0; i < orders.size(); ++i) {
+      values[i] = orders[i]->Value(2, at_time);
+    }
+    benchmark::DoNotOptimize(values.data());
+    ms = (ms + 1) % 300000;
+  }
+  state.SetItemsProcessed(state.iterations() * orders.size());
+}
+BENCHMARK(BM_ValueShelfPerOrder)->RangeMultiplier(8)->Range(8, 4096);
+
+void BM_ValueShelfCurves(benchmark::State& state) {
+  const auto orders = CookedOrders(state.range(0));
+  ValueCurves curves;
+  for (const auto& order : orders) {
+    curves.Add(*order, 2);
+  }
+  std::vector<double> values;
+  int64_t ms = 0;
+  for (auto _ : state) {
+    curves.Values(absl::UnixEpoch() + absl::Milliseconds(ms), &values);
+    benchmark::DoNotOptimize(values.data());
+    ms = (ms + 1) % 300000;
+  }
+  state.SetItemsProcessed(state.iterations() * orders.size());
+}
+BENCHMARK(BM_ValueShelfCurves)->RangeMultiplier(8)->Range(8, 4096);
+
+// Finds the lowest-valued order and earliest expiry on a shelf, as
+// lowest-value eviction does for each discard.
+void BM_SummarizeShelfCurves(benchmark::State& state) {
+  const auto orders = CookedOrders(state.range(0));
+  ValueCurves curves;
+  for (const auto& order : orders) {
+    curves.Add(*order, 2);
+  }
+  int64_t ms = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        curves.Summarize(absl::UnixEpoch() + absl::Milliseconds(ms)));
+    ms = (ms + 1) % 300000;
+  }
+  state.SetItemsProcessed(state.iterations() * orders.size());
+}
+BENCHMARK(BM_SummarizeShelfCurves)->RangeMultiplier(8)->Range(8, 4096);
+
+}  // namespace
+}  // namespace kitchen_sim
@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "bench/synthetic_orders.h"
+#include "benchmark/benchmark.h"
+#include "events/event_sink.h"
+#include "kitchen_sim_lib.h"
+
+namespace kitchen_sim {
+namespace {
+
+// Measures the wall time each kitchen spends between receiving an order and
+// handing it to a courier, i.e. cooking, shelving and dispatch.
+class LatencyEventSink : public EventSink {
+ public:
+  explicit LatencyEventSink(size_t kitchen_count) : kitchens_(kitchen_count) {}
+
+  // Each kitchen handles one order at a time, from one thread at a time.
+  void Record(const Event& event, const Order& order) override {
+    PerKitchen& kitchen = kitchens_[event.kitchen];
+    if (event.type == EventType::RECEIVED) {
+      kitchen.received = std::chrono::steady_clock::now();
+    } else if (event.type == EventType::ACCEPTED) {
+      kitchen.latencies.push_back(std::chrono::steady_clock::now() -
+                                  kitchen.received);
+    }
+  }
+
+  // Moves all latencies measured so far into |latencies|.
+  void Drain(std::vector<std::chrono::nanoseconds>* latencies) {
+    for (PerKitchen& kitchen : kitchens_) {
+      latencies->insert(latencies->end(), kitchen.latencies.begin(),
+                        kitchen.latencies.end());
+      kitchen.latencies.clear();
+    }
+  }
+
+ private:
+  // Padded so kitchens on different threads don't share cache lines.
+  struct alignas(64) PerKitchen {
+    std::chrono::steady_clock::time_point received;
+    std::vector<std::chrono::nanoseconds> latencies;
+  };
+
+  std::vector<PerKitchen> kitchens_;
+};
+
+double PercentileMicros(std::vector<std::chrono::nanoseconds>* latencies,
+                        double percentile) {
+  if (latencies->empty()) {
+    return 0.;
+  }
+  auto nth = latencies->begin() + static_cast<size_t>(percentile *
+                                                      (latencies->size() - 1));
+  std::nth_element(latencies->begin(), nth, latencies->end());
+  return std::chrono::duration<double, std::micro>(*nth).count();
+}
+
+// Runs |state.range(0)| synthetic orders through a fleet of |state.range(1)|
+// kitchens on a virtual clock.
+void BM_Simulation(benchmark::State& state) {
+  const size_t order_count = state.range(0);
+  const unsigned int kitchen_count = state.range(1);
+  std::vector<std::chrono::nanoseconds> latencies;
+  for (auto _ : state) {
+    state.PauseTiming();
+    LatencyEventSink sink(kitchen_count);
+    KitchenSimulation::Options options;
+    options.kitchen_name = "bench";
+    options.orders_per_second = 10.;
+    options.clock = ClockType::VIRTUAL;
+    options.seed = 1;
+    options.kitchen_count = kitchen_count;
+    options.routing = RoutingType::ROUND_ROBIN;
+    options.event_sink = &sink;
+    options.shelf_log_interval = absl::InfiniteDuration();
+    options.print_summary = false;
+    auto simulation = std::make_unique<KitchenSimulation>(options);
+    auto orders = SyntheticOrders(order_count, /*seed=*/1);
+    state.ResumeTiming();
+
+    simulation->Run(orders.begin(), orders.end());
+
+    state.PauseTiming();
+    simulation.reset();
+    sink.Drain(&latencies);
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * order_count);
+  state.counters["p50_us"] = PercentileMicros(&latencies, 0.5);
+  state.counters["p99_us"] = PercentileMicros(&latencies, 0.99);
+}
+BENCHMARK(BM_Simulation)
+    ->Args({10000, 1})
+    ->Args({10000, 4})
+    ->Args({100000, 1})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Runs the same overloaded workload through a SMALL kitchen under each
+// eviction policy (|state.range(0)| indexes EvictionPolicyType), reporting how
+// much was wasted and how much value reached customers.
+void BM_EvictionPolicy(benchmark::State& state) {
+  constexpr size_t kOrderCount = 20000;
+  const auto policy = static_cast<EvictionPolicyType>(state.range(0));
+  state.SetLabel(std::string(EvictionPolicyName(policy)));
+  Kitchen::Stats stats;
+  for (auto _ : state) {
+    state.PauseTiming();
+    NullEventSink sink;
+    KitchenSimulation::Options options;
+    options.kitchen_name = "bench";
+    options.kitchen_size = "SMALL";
+    options.orders_per_second = 5.;
+    options.clock = ClockType::VIRTUAL;
+    options.seed = 1;
+    options.eviction_policy = policy;
+    options.event_sink = &sink;
+    options.shelf_log_interval = absl::InfiniteDuration();
+    options.print_summary = false;
+    auto simulation = std::make_unique<KitchenSimulation>(options);
+    auto orders = SyntheticOrders(kOrderCount, /*seed=*/1);
+    state.ResumeTiming();
+
+    simulation->Run(orders.begin(), orders.end());
+
+    state.PauseTiming();
+    stats = simulation->Fleet().AggregateStats();
+    simulation.reset();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * kOrderCount);
+  state.counters["waste_rate"] = stats.WasteRate();
+  state.counters["delivered_value"] = stats.delivered_value;
+}
+BENCHMARK(BM_EvictionPolicy)
+    ->DenseRange(static_cast<int>(EvictionPolicyType::RANDOM),
+                 static_cast<int>(EvictionPolicyType::LOWEST_PICKUP_VALUE))
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Runs a steady workload past a courier fleet of |state.range(0)| couriers (0
+// for unbounded) dispatched per DispatchType |state.range(1)|, each carrying
+// up to |state.range(2)| orders and taking 10s to deliver them. Reports how
+// busy couriers were and what the kitchen wasted while orders waited.
+void BM_CourierFleet(benchmark::State& state) {
+  constexpr size_t kOrderCount = 20000;
+  const auto dispatch = static_cast<DispatchType>(state.range(1));
+  state.SetLabel(std::string(DispatchName(dispatch)));
+  Kitchen::Stats stats;
+  CourierFleet::Stats courier_stats;
+  double utilization = 0.;
+  for (auto _ : state) {
+    state.PauseTiming();
+    NullEventSink sink;
+    KitchenSimulation::Options options;
+    options.kitchen_name = "bench";
+    options.orders_per_second = 5.;
+    options.clock = ClockType::VIRTUAL;
+    options.seed = 1;
+    options.couriers_per_kitchen = state.range(0);
+    options.dispatch = dispatch;
+    options.courier_capacity = state.range(2);
+    options.courier_delivery_time = absl::Seconds(10);
+    options.event_sink = &sink;
+    options.shelf_log_interval = absl::InfiniteDuration();
+    options.print_summary = false;
+    auto simulation = std::make_unique<KitchenSimulation>(options);
+    auto orders = SyntheticOrders(kOrderCount, /*seed=*/1);
+    state.ResumeTiming();
+
+    simulation->Run(orders.begin(), orders.end());
+
+    state.PauseTiming();
+    stats = simulation->Fleet().AggregateStats();
+    courier_stats = simulation->Couriers(0).GetStats();
+    utilization = simulation->Couriers(0).Utilization();
+    simulation.reset();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * kOrderCount);
+  state.counters["waste_rate"] = stats.WasteRate();
+  state.counters["orders_per_trip"] = courier_stats.OrdersPerTrip();
+  state.counters["peak_busy"] = courier_stats.peak_busy;
+  state.counters["utilization"] = utilization;
+}
+BENCHMARK(BM_CourierFleet)
+    ->Args({0, static_cast<int>(DispatchType::MATCHED), 1})
+    ->Args({50, static_cast<int>(DispatchType::MATCHED), 1})
+    ->Args({50, static_cast<int>(DispatchType::FIFO), 1})
+    ->Args({50, static_cast<int>(DispatchType::MATCHED), 2})
+    ->Args({50, static_cast<int>(DispatchType::FIFO), 2})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace kitchen_sim
@@ -0,0 +1,32 @@
+#include "bench/synthetic_orders.h"
+
+#include <random>
+#include <string>
+
+namespace kitchen_sim {
+
+std::vector<std::unique_ptr<Order>> SyntheticOrders(size_t count,
+                                                    uint32_t seed,
+                                                    uint64_t first_id,
+                                                    TemperatureType temp,
+                                                    absl::Time receipt_time) {
+  static constexpr TemperatureType kTemps[] = {
+      TemperatureType::HOT, TemperatureType::COLD, TemperatureType::FROZEN};
+  std::mt19937 rand(seed);
+  std::uniform_int_distribution<int> temp_dist(0, 2);
+  std::uniform_int_distribution<int> shelf_life_dist(100, 400);
+  std::uniform_real_distribution<double> decay_rate_dist(0.1, 1.);
+
+  std::vector<std::unique_ptr<Order>> orders;
+  orders.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    const TemperatureType order_temp =
+        temp != TemperatureType::UNKNOWN ? temp : kTemps[temp_dist(rand)];
+    orders.push_back(Order::CreateOrder(
+        std::to_string(first_id + i), "synthetic", order_temp,
+        shelf_life_dist(rand), decay_rate_dist(rand), receipt_time));
+  }
+  return orders;
+}
+
+}  // namespace kitchen_sim
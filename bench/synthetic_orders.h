@@ -0,0 +1,24 @@
+#ifndef KITCHEN_SIM_BENCH_SYNTHETIC_ORDERS_H_
+#define KITCHEN_SIM_BENCH_SYNTHETIC_ORDERS_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "model/order.h"
+
+namespace kitchen_sim {
+
+// Returns |count| valid orders with IDs "<first_id>".."<first_id + count - 1>"
+// received at |receipt_time|. Temperatures are drawn uniformly, shelf lives
+// from 100-400 seconds and decay rates from 0.1-1. If |temp| is set, every
+// order has that temperature instead.
+std::vector<std::unique_ptr<Order>> SyntheticOrders(
+    size_t count, uint32_t seed, uint64_t first_id = 0,
+    TemperatureType temp = TemperatureType::UNKNOWN,
+    absl::Time receipt_time = absl::UnixEpoch());
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_BENCH_SYNTHETIC_ORDERS_H_
@@ -0,0 +1,141 @@
+#include "events/async_event_log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include "absl/strings/str_cat.h"
+
+namespace kitchen_sim {
+namespace {
+
+// Records formatted per write to |output_|.
+constexpr size_t kWriteBatchSize = 4096;
+
+// How long the writer sleeps when it finds nothing to do.
+constexpr auto kIdleBackoff = std::chrono::microseconds(200);
+
+absl::string_view TemperatureName(TemperatureType temp) {
+  switch (temp) {
+    case TemperatureType::HOT:
+      return "hot";
+    case TemperatureType::COLD:
+      return "cold";
+    case TemperatureType::FROZEN:
+      return "frozen";
+    default:
+      return "unknown";
+  }
+}
+
+// Appends |value| as the body of a JSON string.
+void AppendEscaped(absl::string_view value, std::string* out) {
+  for (const char c : value) {
+    if (c == '"' || c == '\\') {
+      out->push_back('\\');
+      out->push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      static constexpr char kHex[] = "0123456789abcdef";
+      out->append("\\u00");
+      out->push_back(kHex[(c >> 4) & 0xf]);
+      out->push_back(kHex[c & 0xf]);
+    } else {
+      out->push_back(c);
+    }
+  }
+}
+
+}  // namespace
+
+constexpr char AsyncEventLog::kBinaryMagic[8];
+
+AsyncEventLog::AsyncEventLog(std::unique_ptr<std::ostream> output,
+                             Format format, size_t queue_capacity)
+    : output_(std::move(output)), format_(format), queue_(queue_capacity) {
+  if (format_ == Format::BINARY) {
+    output_->write(kBinaryMagic, sizeof(kBinaryMagic));
+  }
+  writer_ = std::thread([this] { WriterLoop(); });
+}
+
+AsyncEventLog::~AsyncEventLog() {
+  stopping_.store(true, std::memory_order_release);
+  writer_.join();
+}
+
+void AsyncEventLog::Record(const Event& event, const Order& order) {
+  EventRecord record;
+  record.unix_nanos = absl::ToUnixNanos(event.at_time);
+  record.value = event.value;
+  record.kitchen = event.kitchen;
+  record.type = event.type;
+  record.temp = static_cast<uint8_t>(order.temp_);
+  record.overflow = event.overflow;
+  record.id_size = static_cast<uint8_t>(
+      order.id_.CopyTo(record.id, EventRecord::kMaxIdSize));
+  if (queue_.TryPush(record)) {
+    return;
+  }
+  stalls_.fetch_add(1, std::memory_order_relaxed);
+  while (!queue_.TryPush(record)) {
+    std::this_thread::yield();
+  }
+}
+
+void AsyncEventLog::WriterLoop() {
+  std::string buffer;
+  EventRecord record;
+  while (true) {
+    // Read before draining so that events recorded before destruction began
+    // are always written.
+    const bool stopping = stopping_.load(std::memory_order_acquire);
+    size_t drained = 0;
+    while (drained < kWriteBatchSize && queue_.TryPop(&record)) {
+      Append(record, &buffer);
+      ++drained;
+    }
+    if (drained > 0) {
+      output_->write(buffer.data(), buffer.size());
+      buffer.clear();
+    } else if (stopping) {
+      break;
+    } else {
+      std::this_thread::sleep_for(kIdleBackoff);
+    }
+  }
+  output_->flush();
+}
+
+void AsyncEventLog::Append(const EventRecord& record,
+                           std::string* buffer) const {
+  if (format_ == Format::BINARY) {
+    buffer->append(reinterpret_cast<const char*>(&record), sizeof(record));
+    return;
+  }
+  absl::StrAppend(buffer, "{\"time_ns\":", record.unix_nanos,
+                  ",\"kitchen\":", record.kitchen, ",\"event\":\"",
+                  EventTypeName(record.type), "\",\"id\":\"");
+  AppendEscaped(absl::string_view(record.id, record.id_size), buffer);
+  absl::StrAppend(buffer, "\",\"temp\":\"",
+                  TemperatureName(static_cast<TemperatureType>(record.temp)),
+                  "\",\"overflow\":", record.overflow ? "true" : "false",
+                  ",\"value\":", record.value, "}\n");
+}
+
+std::vector<AsyncEventLog::EventRecord> AsyncEventLog::ReadBinary(
+    std::istream& input) {
+  char magic[sizeof(kBinaryMagic)];
+  if (!input.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, kBinaryMagic, sizeof(magic)) != 0) {
+    throw std::invalid_argument("Not a binary event log!");
+  }
+  std::vector<EventRecord> records;
+  EventRecord record;
+  while (input.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+    records.push_back(record);
+  }
+  return records;
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,86 @@
+#ifndef KITCHEN_SIM_EVENTS_ASYNC_EVENT_LOG_H_
+#define KITCHEN_SIM_EVENTS_ASYNC_EVENT_LOG_H_
+
+#include <atomic>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+#include "events/event_sink.h"
+#include "runtime/bounded_queue.h"
+
+namespace kitchen_sim {
+
+// Event sink that copies each event into a fixed-size record on a lock-free
+// queue and leaves formatting and I/O to a background writer thread, so
+// recording costs a few stores rather than a formatted, synchronized log
+// write.
+class AsyncEventLog : public EventSink {
+ public:
+  enum class Format {
+    // One JSON object per line.
+    NDJSON,
+    // |kBinaryMagic| followed by raw EventRecords in host byte order.
+    BINARY
+  };
+
+  // Fixed-size copy of an event, and the BINARY on-disk layout.
+  struct EventRecord {
+    static constexpr size_t kMaxIdSize = 42;
+
+    int64_t unix_nanos = 0;
+    double value = 0.;
+    uint16_t kitchen = 0;
+    EventType type = EventType::RECEIVED;
+    // A TemperatureType.
+    uint8_t temp = 0;
+    bool overflow = false;
+    // Longer IDs are truncated.
+    uint8_t id_size = 0;
+    char id[kMaxIdSize] = {};
+  };
+  static_assert(sizeof(EventRecord) == 64, "EventRecord must fill one line");
+
+  static constexpr char kBinaryMagic[8] = {'K', 'S', 'E', 'V',
+                                           'L', 'O', 'G', '1'};
+
+  // Writes to |output| until destroyed. |queue_capacity| must be a power of
+  // two.
+  AsyncEventLog(std::unique_ptr<std::ostream> output, Format format,
+                size_t queue_capacity = 1 << 16);
+  // Writes out all recorded events before returning.
+  ~AsyncEventLog() override;
+  AsyncEventLog(AsyncEventLog const&) = delete;
+  AsyncEventLog& operator=(AsyncEventLog const&) = delete;
+
+  // Never formats or writes; only waits if the writer has fallen a full
+  // queue behind.
+  void Record(const Event& event, const Order& order) override;
+
+  // Number of times Record() found the queue full and had to wait.
+  uint64_t StallCount() const {
+    return stalls_.load(std::memory_order_relaxed);
+  }
+
+  // Parses a BINARY log. Throws if |input| doesn't start with
+  // |kBinaryMagic|.
+  static std::vector<EventRecord> ReadBinary(std::istream& input);
+
+ private:
+  void WriterLoop();
+  void Append(const EventRecord& record, std::string* buffer) const;
+
+  const std::unique_ptr<std::ostream> output_;
+  const Format format_;
+  BoundedQueue<EventRecord> queue_;
+  std::atomic<bool> stopping_{false};
+  std::atomic<uint64_t> stalls_{0};
+  std::thread writer_;
+};
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_EVENTS_ASYNC_EVENT_LOG_H_
@@ -0,0 +1,75 @@
+#include "events/async_event_log.h"
+
+#include <sstream>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+namespace {
+
+// Stream that stays readable after the log takes ownership of it.
+class SharedStream : public std::ostream {
+ public:
+  explicit SharedStream(std::stringstream* target)
+      : std::ostream(target->rdbuf()) {}
+};
+
+}  // namespace
+
+TEST(AsyncEventLogTest, WritesNdjsonInRecordOrder) {
+  auto order = Order::CreateOrder("a1", "Tacos", TemperatureType::HOT, 300,
+                                  0.5, absl::UnixEpoch());
+  std::stringstream output;
+  {
+    AsyncEventLog log(std::make_unique<SharedStream>(&output),
+                      AsyncEventLog::Format::NDJSON, /*queue_capacity=*/2);
+    // More events than the queue holds.
+    log.Record({EventType::RECEIVED, absl::FromUnixNanos(5)}, *order);
+    Event cooked = {EventType::COOKED, absl::FromUnixNanos(7), 1.};
+    cooked.kitchen = 2;
+    cooked.overflow = true;
+    log.Record(cooked, *order);
+    log.Record({EventType::DELIVERED, absl::FromUnixNanos(9), 0.5}, *order);
+  }
+
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(output, line);) {
+    lines.push_back(line);
+  }
+  EXPECT_THAT(
+      lines,
+      testing::ElementsAre(
+          "{\"time_ns\":5,\"kitchen\":0,\"event\":\"RECEIVED\",\"id\":\"a1\","
+          "\"temp\":\"hot\",\"overflow\":false,\"value\":0}",
+          "{\"time_ns\":7,\"kitchen\":2,\"event\":\"COOKED\",\"id\":\"a1\","
+          "\"temp\":\"hot\",\"overflow\":true,\"value\":1}",
+          "{\"time_ns\":9,\"kitchen\":0,\"event\":\"DELIVERED\",\"id\":\"a1\","
+          "\"temp\":\"hot\",\"overflow\":false,\"value\":0.5}"));
+}
+
+TEST(AsyncEventLogTest, BinaryRoundTrip) {
+  auto order = Order::CreateOrder("b2", "Soup", TemperatureType::COLD, 300,
+                                  0.5, absl::UnixEpoch());
+  std::stringstream output;
+  {
+    AsyncEventLog log(std::make_unique<SharedStream>(&output),
+                      AsyncEventLog::Format::BINARY);
+    log.Record({EventType::EXPIRED, absl::FromUnixNanos(42)}, *order);
+  }
+
+  auto records = AsyncEventLog::ReadBinary(output);
+  ASSERT_EQ(records.size(), 1);
+  EXPECT_EQ(records[0].unix_nanos, 42);
+  EXPECT_EQ(records[0].type, EventType::EXPIRED);
+  EXPECT_EQ(static_cast<TemperatureType>(records[0].temp),
+            TemperatureType::COLD);
+  EXPECT_EQ(absl::string_view(records[0].id, records[0].id_size), "b2");
+}
+
+TEST(AsyncEventLogTest, ReadBinaryRejectsOtherFormats) {
+  std::stringstream input("{\"time_ns\":1}\n");
+  EXPECT_THROW(AsyncEventLog::ReadBinary(input), std::invalid_argument);
+}
+
+}  // namespace kitchen_sim
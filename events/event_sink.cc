@@ -0,0 +1,57 @@
+#include "events/event_sink.h"
+
+#include "boost/log/trivial.hpp"
+
+namespace kitchen_sim {
+
+absl::string_view EventTypeName(EventType type) {
+  switch (type) {
+    case EventType::RECEIVED:
+      return "RECEIVED";
+    case EventType::COOKED:
+      return "COOKED";
+    case EventType::EXPIRY_SCHEDULED:
+      return "EXPIRY_SCHEDULED";
+    case EventType::ACCEPTED:
+      return "ACCEPTED";
+    case EventType::MOVED:
+      return "MOVED";
+    case EventType::DISCARDED:
+      return "DISCARDED";
+    case EventType::EXPIRED:
+      return "EXPIRED";
+    case EventType::DELIVERED:
+      return "DELIVERED";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+TextEventSink* TextEventSink::Default() {
+  static TextEventSink* sink = new TextEventSink();
+  return sink;
+}
+
+void TextEventSink::Record(const Event& event, const Order& order) {
+  // Messages are only built if the record passes the logger's filter.
+  const absl::string_view type = EventTypeName(event.type);
+  switch (event.type) {
+    case EventType::COOKED:
+    case EventType::DISCARDED:
+    case EventType::DELIVERED:
+      BOOST_LOG_TRIVIAL(info) << order.LogMessage(type);
+      break;
+    case EventType::EXPIRY_SCHEDULED:
+      BOOST_LOG_TRIVIAL(info)
+          << order.LogMessage(type) << " @ "
+          << absl::FormatTime(
+                 "%H:%M:%S", event.at_time,
+                 absl::FixedTimeZone(-7 * 60 * 60));  // It's always LA time.
+      break;
+    default:
+      BOOST_LOG_TRIVIAL(debug) << order.LogMessage(type);
+      break;
+  }
+}
+
+}  // namespace kitchen_sim
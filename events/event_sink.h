@@ -0,0 +1,71 @@
+#ifndef KITCHEN_SIM_EVENTS_EVENT_SINK_H_
+#define KITCHEN_SIM_EVENTS_EVENT_SINK_H_
+
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "model/order.h"
+
+namespace kitchen_sim {
+
+// Steps in an order's lifecycle.
+enum class EventType : uint8_t {
+  RECEIVED,
+  COOKED,
+  EXPIRY_SCHEDULED,
+  ACCEPTED,
+  MOVED,
+  DISCARDED,
+  EXPIRED,
+  DELIVERED
+};
+
+absl::string_view EventTypeName(EventType type);
+
+// Something that happened to an order.
+struct Event {
+  EventType type;
+  // When it happened, or for EXPIRY_SCHEDULED, when the order will expire.
+  absl::Time at_time;
+  // Order value at |at_time|, 0 if not (or no longer) on a shelf.
+  double value = 0.;
+  // Index of the kitchen holding the order within its fleet.
+  uint16_t kitchen = 0;
+  // Whether the order is on the overflow shelf.
+  bool overflow = false;
+};
+
+// Receives order events. Called from kitchen schedulers, so implementations
+// must be thread-safe and should return quickly.
+class EventSink {
+ public:
+  virtual ~EventSink() = default;
+
+  // |order| is only valid for the duration of the call.
+  virtual void Record(const Event& event, const Order& order) = 0;
+
+  // False if Record() drops every event, so callers can skip building them.
+  virtual bool IsEnabled() const { return true; }
+};
+
+// Synchronously renders each event as a human-readable line on the Boost.Log
+// trivial logger. Convenient for watching a simulation, but slow at scale.
+class TextEventSink : public EventSink {
+ public:
+  // Shared instance; the sink is stateless.
+  static TextEventSink* Default();
+
+  void Record(const Event& event, const Order& order) override;
+};
+
+// Drops every event.
+class NullEventSink : public EventSink {
+ public:
+  void Record(const Event& event, const Order& order) override {}
+  bool IsEnabled() const override { return false; }
+};
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_EVENTS_EVENT_SINK_H_
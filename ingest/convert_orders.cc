@@ -0,0 +1,42 @@
+#include <fstream>
+#include <iostream>
+
+#include "gflags/gflags.h"
+#include "ingest/order_columns.h"
+#include "ingest/order_reader.h"
+
+DEFINE_string(input, "",
+              "JSON array or newline-delimited JSON orders to convert.");
+DEFINE_string(output, "", "Order columns file to write.");
+DEFINE_bool(skip_invalid_orders, false,
+            "Whether to drop invalid orders instead of failing.");
+
+// Converts JSON orders to an order columns file, for kitchen_sim
+// --columns_path. JSON orders carry no arrivals, so none are recorded.
+int main(int argc, char* argv[]) {
+  gflags::SetUsageMessage(
+      "convert_orders --input=orders.json --output=orders.columns "
+      "[ --skip_invalid_orders ]");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  if (FLAGS_input.empty() || FLAGS_output.empty()) {
+    std::cerr << "--input and --output are required." << std::endl;
+    return -1;
+  }
+
+  try {
+    const kitchen_sim::RealClock clock;
+    auto reader = kitchen_sim::OpenOrderReader(FLAGS_input, &clock,
+                                               {FLAGS_skip_invalid_orders});
+    kitchen_sim::OrderColumnsWriter writer;
+    for (auto it = reader->begin(); it != reader->end(); ++it) {
+      writer.Add(**it);
+    }
+    std::ofstream out(FLAGS_output, std::ios::binary | std::ios::trunc);
+    writer.WriteTo(out);
+    std::cout << "Converted " << writer.Size() << " orders." << std::endl;
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return -1;
+  }
+  return 0;
+}
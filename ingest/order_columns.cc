@@ -0,0 +1,382 @@
+#include "ingest/order_columns.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "absl/strings/str_cat.h"
+
+namespace kitchen_sim {
+namespace {
+
+constexpr char kMagic[8] = {'K', 'S', 'O', 'R', 'D', 'C', 'O', 'L'};
+constexpr uint32_t kVersion = 1;
+
+// Header flags.
+constexpr uint32_t kHasArrivals = 1 << 0;
+constexpr uint32_t kHasRegions = 1 << 1;
+constexpr uint32_t kPackedUuids = 1 << 2;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t flags;
+  uint64_t order_count;
+  // Strings in the dictionary: names, then regions.
+  uint32_t name_count;
+  uint32_t region_count;
+  // Unpadded sizes of the concatenated ID and dictionary strings.
+  uint64_t id_bytes;
+  uint64_t dictionary_bytes;
+  uint64_t reserved[2];
+};
+static_assert(sizeof(Header) == 64, "Header layout changed");
+
+size_t Padded(size_t bytes) { return (bytes + 7) & ~size_t{7}; }
+
+// Byte offset of each section in a file with |header|, and the file's size.
+struct Layout {
+  explicit Layout(const Header& header) {
+    const size_t count = header.order_count;
+    size_t offset = sizeof(Header);
+    const auto section = [&](size_t bytes) {
+      const size_t start = offset;
+      offset += Padded(bytes);
+      return start;
+    };
+    decay_rates = section(count * sizeof(double));
+    arrival_ns =
+        section(header.flags & kHasArrivals ? count * sizeof(int64_t) : 0);
+    shelf_lives_s = section(count * sizeof(int32_t));
+    names = section(count * sizeof(uint32_t));
+    regions =
+        section(header.flags & kHasRegions ? count * sizeof(uint32_t) : 0);
+    temps = section(count);
+    if (header.flags & kPackedUuids) {
+      packed_uuids = section(count * OrderId::kPackedUuidSize);
+    } else {
+      id_ends = section(count * sizeof(uint64_t));
+      id_bytes = section(header.id_bytes);
+    }
+    const size_t strings = size_t{header.name_count} + header.region_count;
+    dictionary_ends = section(strings * sizeof(uint64_t));
+    dictionary_bytes = section(header.dictionary_bytes);
+    size = offset;
+  }
+
+  size_t decay_rates;
+  size_t arrival_ns;
+  size_t shelf_lives_s;
+  size_t names;
+  size_t regions;
+  size_t temps;
+  size_t packed_uuids = 0;
+  size_t id_ends = 0;
+  size_t id_bytes = 0;
+  size_t dictionary_ends;
+  size_t dictionary_bytes;
+  size_t size;
+};
+
+// Writes |bytes| of |data| and pads them to the next section.
+void WriteSection(const void* data, size_t bytes, std::ostream& out) {
+  static constexpr char kPadding[8] = {};
+  out.write(static_cast<const char*>(data), bytes);
+  out.write(kPadding, Padded(bytes) - bytes);
+}
+
+template <typename T>
+void WriteSection(const std::vector<T>& column, std::ostream& out) {
+  WriteSection(column.data(), column.size() * sizeof(T), out);
+}
+
+// Writes |strings| as end offsets followed by their concatenated bytes.
+void WriteStrings(const std::vector<const std::string*>& strings,
+                  std::ostream& out) {
+  std::vector<uint64_t> ends;
+  ends.reserve(strings.size());
+  uint64_t end = 0;
+  for (const std::string* string : strings) {
+    end += string->size();
+    ends.push_back(end);
+  }
+  WriteSection(ends, out);
+  std::string bytes;
+  bytes.reserve(end);
+  for (const std::string* string : strings) {
+    bytes += *string;
+  }
+  WriteSection(bytes.data(), bytes.size(), out);
+}
+
+// Whether |ends| are non-decreasing, each string is non-empty if
+// |non_empty|, and the last ends within |bytes|.
+bool ValidEnds(const uint64_t* ends, size_t count, uint64_t bytes,
+               bool non_empty) {
+  uint64_t start = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (ends[i] < start || (non_empty && ends[i] == start)) {
+      return false;
+    }
+    start = ends[i];
+  }
+  return start <= bytes;
+}
+
+std::invalid_argument InvalidFile(const std::string& path,
+                                  absl::string_view reason) {
+  return std::invalid_argument(
+      absl::StrCat("Invalid order columns file: ", path, " (", reason, ")"));
+}
+
+// Checks |header| was written by a compatible OrderColumnsWriter.
+void CheckHeader(const Header& header, const std::string& path) {
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    throw InvalidFile(path, "bad magic");
+  }
+  if (header.version != kVersion) {
+    throw InvalidFile(path, absl::StrCat("version ", header.version));
+  }
+}
+
+}  // namespace
+
+OrderColumnsWriter::OrderColumnsWriter(Options options) : options_(options) {}
+
+uint32_t OrderColumnsWriter::Intern(
+    absl::string_view string,
+    absl::flat_hash_map<std::string, uint32_t>* indices,
+    std::vector<std::string>* strings) {
+  const auto inserted = indices->try_emplace(string, strings->size());
+  if (inserted.second) {
+    strings->emplace_back(string);
+  }
+  return inserted.first->second;
+}
+
+void OrderColumnsWriter::UnpackIds() {
+  packed_ids_ = false;
+  id_ends_.reserve(Size());
+  for (size_t i = 0; i < Size(); ++i) {
+    OrderId::FromPackedUuid(&packed_uuids_[i * OrderId::kPackedUuidSize])
+        .AppendTo(&id_bytes_);
+    id_ends_.push_back(id_bytes_.size());
+  }
+  packed_uuids_ = {};
+}
+
+void OrderColumnsWriter::Add(const Order& order) {
+  if (options_.record_arrivals) {
+    if (!first_receipt_time_.has_value()) {
+      first_receipt_time_ = order.receipt_time_;
+    }
+    arrival_ns_.push_back(absl::ToInt64Nanoseconds(
+        order.receipt_time_ - first_receipt_time_.value()));
+  }
+  if (packed_ids_) {
+    unsigned char bits[OrderId::kPackedUuidSize];
+    if (order.id_.PackUuid(bits)) {
+      packed_uuids_.insert(packed_uuids_.end(), bits, bits + sizeof(bits));
+    } else {
+      UnpackIds();
+    }
+  }
+  if (!packed_ids_) {
+    order.id_.AppendTo(&id_bytes_);
+    id_ends_.push_back(id_bytes_.size());
+  }
+  decay_rates_.push_back(order.decay_rate_);
+  shelf_lives_s_.push_back(order.shelf_life_s_);
+  names_.push_back(Intern(order.name_, &name_indices_, &name_strings_));
+  regions_.push_back(
+      order.region_.empty()
+          ? 0
+          : 1 + Intern(order.region_, &region_indices_, &region_strings_));
+  temps_.push_back(static_cast<uint8_t>(order.temp_));
+}
+
+void OrderColumnsWriter::WriteTo(std::ostream& out) const {
+  std::vector<const std::string*> dictionary;
+  uint64_t dictionary_bytes = 0;
+  for (const auto* strings : {&name_strings_, &region_strings_}) {
+    for (const std::string& string : *strings) {
+      dictionary.push_back(&string);
+      dictionary_bytes += string.size();
+    }
+  }
+  const bool has_regions = !region_strings_.empty();
+
+  Header header = {};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.flags = (options_.record_arrivals ? kHasArrivals : 0) |
+                 (has_regions ? kHasRegions : 0) |
+                 (packed_ids_ ? kPackedUuids : 0);
+  header.order_count = Size();
+  header.name_count = name_strings_.size();
+  header.region_count = region_strings_.size();
+  header.id_bytes = id_bytes_.size();
+  header.dictionary_bytes = dictionary_bytes;
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  WriteSection(decay_rates_, out);
+  WriteSection(arrival_ns_, out);
+  WriteSection(shelf_lives_s_, out);
+  WriteSection(names_, out);
+  if (has_regions) {
+    WriteSection(regions_, out);
+  }
+  WriteSection(temps_, out);
+  if (packed_ids_) {
+    WriteSection(packed_uuids_, out);
+  } else {
+    WriteSection(id_ends_, out);
+    WriteSection(id_bytes_.data(), id_bytes_.size(), out);
+  }
+  WriteStrings(dictionary, out);
+  if (!out.good()) {
+    throw std::runtime_error("Could not write order columns!");
+  }
+}
+
+OrderColumnsReader::OrderColumnsReader(const std::string& path,
+                                       const Clock* clock)
+    : clock_(clock), open_time_(clock->Now()) {
+  try {
+    file_.open(path);
+  } catch (const std::exception& e) {
+    throw std::invalid_argument(absl::StrCat(
+        "Could not map orders from path: ", path, " (", e.what(), ")"));
+  }
+  if (file_.size() < sizeof(Header)) {
+    throw InvalidFile(path, "truncated header");
+  }
+  Header header;
+  std::memcpy(&header, file_.data(), sizeof(header));
+  CheckHeader(header, path);
+  // Bounds every section's size before laying them out.
+  if (header.order_count > file_.size() || header.id_bytes > file_.size() ||
+      header.dictionary_bytes > file_.size() ||
+      header.name_count + uint64_t{header.region_count} > file_.size()) {
+    throw InvalidFile(path, "truncated");
+  }
+  const Layout layout(header);
+  if (layout.size != file_.size()) {
+    throw InvalidFile(path, "unexpected size");
+  }
+
+  // Sections are 8-byte aligned within a page-aligned mapping.
+  const char* data = file_.data();
+  size_ = header.order_count;
+  decay_rates_ = reinterpret_cast<const double*>(data + layout.decay_rates);
+  if (header.flags & kHasArrivals) {
+    arrival_ns_ = reinterpret_cast<const int64_t*>(data + layout.arrival_ns);
+  }
+  shelf_lives_s_ =
+      reinterpret_cast<const int32_t*>(data + layout.shelf_lives_s);
+  names_ = reinterpret_cast<const uint32_t*>(data + layout.names);
+  if (header.flags & kHasRegions) {
+    regions_ = reinterpret_cast<const uint32_t*>(data + layout.regions);
+  }
+  temps_ = reinterpret_cast<const uint8_t*>(data + layout.temps);
+  if (header.flags & kPackedUuids) {
+    packed_uuids_ =
+        reinterpret_cast<const unsigned char*>(data + layout.packed_uuids);
+  } else {
+    id_ends_ = reinterpret_cast<const uint64_t*>(data + layout.id_ends);
+    id_bytes_ = data + layout.id_bytes;
+  }
+
+  // Checks every order as Order::CreateOrder() would, a column at a time.
+  name_count_ = header.name_count;
+  const size_t region_count = header.region_count;
+  bool valid = true;
+  for (size_t i = 0; i < size_; ++i) {
+    valid &= (temps_[i] >= static_cast<uint8_t>(TemperatureType::FROZEN)) &
+             (temps_[i] <= static_cast<uint8_t>(TemperatureType::HOT));
+  }
+  for (size_t i = 0; i < size_; ++i) {
+    valid &= (shelf_lives_s_[i] >= 0) & (decay_rates_[i] >= 0.);
+  }
+  for (size_t i = 0; i < size_; ++i) {
+    valid &= names_[i] < name_count_;
+  }
+  for (size_t i = 0; regions_ != nullptr && i < size_; ++i) {
+    valid &= regions_[i] <= region_count;
+  }
+  if (!valid) {
+    throw InvalidFile(path, "invalid order");
+  }
+  if (id_ends_ != nullptr &&
+      !ValidEnds(id_ends_, size_, header.id_bytes, /*non_empty=*/true)) {
+    throw InvalidFile(path, "invalid IDs");
+  }
+
+  const auto* dictionary_ends =
+      reinterpret_cast<const uint64_t*>(data + layout.dictionary_ends);
+  const size_t strings = name_count_ + region_count;
+  if (!ValidEnds(dictionary_ends, strings, header.dictionary_bytes,
+                 /*non_empty=*/true)) {
+    throw InvalidFile(path, "invalid dictionary");
+  }
+  const char* dictionary_bytes = data + layout.dictionary_bytes;
+  dictionary_.reserve(strings);
+  uint64_t start = 0;
+  for (size_t i = 0; i < strings; ++i) {
+    dictionary_.emplace_back(dictionary_bytes + start,
+                             dictionary_ends[i] - start);
+    start = dictionary_ends[i];
+  }
+}
+
+std::unique_ptr<Order> OrderColumnsReader::At(size_t index) const {
+  OrderId id;
+  if (packed_uuids_ != nullptr) {
+    id = OrderId::FromPackedUuid(packed_uuids_ +
+                                 index * OrderId::kPackedUuidSize);
+  } else {
+    const uint64_t start = index == 0 ? 0 : id_ends_[index - 1];
+    id = OrderId(absl::string_view(id_bytes_ + start, id_ends_[index] - start));
+  }
+  const absl::Time receipt_time =
+      arrival_ns_ != nullptr
+          ? open_time_ + absl::Nanoseconds(arrival_ns_[index])
+          : clock_->Now();
+  auto order = std::make_unique<Order>(
+      id, dictionary_[names_[index]],
+      static_cast<TemperatureType>(temps_[index]), shelf_lives_s_[index],
+      decay_rates_[index], receipt_time);
+  if (regions_ != nullptr && regions_[index] != 0) {
+    order->region_ =
+        std::string(dictionary_[name_count_ + regions_[index] - 1]);
+  }
+  return order;
+}
+
+OrderColumnsReader::Iterator OrderColumnsReader::begin() {
+  if (next_ == 0 && current_ == nullptr && !done_) {
+    Advance();
+  }
+  return Iterator(this);
+}
+
+void OrderColumnsReader::Advance() {
+  if (next_ == size_) {
+    current_ = nullptr;
+    done_ = true;
+    return;
+  }
+  current_ = At(next_++);
+}
+
+bool OrderColumnsHaveArrivals(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  Header header;
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+    throw InvalidFile(path, "truncated header");
+  }
+  CheckHeader(header, path);
+  return header.flags & kHasArrivals;
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,183 @@
+#ifndef KITCHEN_SIM_INGEST_ORDER_COLUMNS_H_
+#define KITCHEN_SIM_INGEST_ORDER_COLUMNS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "boost/iostreams/device/mapped_file.hpp"
+#include "model/order.h"
+#include "runtime/clock.h"
+
+namespace kitchen_sim {
+
+// Order columns files hold orders one column per attribute, so they load
+// without parsing: a 64-byte header, then each of these sections in turn,
+// starting on 8-byte boundaries and in host byte order:
+//
+//   decay rates          double per order
+//   arrival offsets      int64 nanoseconds per order, if recorded
+//   shelf lives          int32 seconds per order
+//   names                uint32 dictionary index per order
+//   regions              uint32 per order, 0 for none or 1 + the index of the
+//                        region among the dictionary's regions, if any order
+//                        has one
+//   temperatures         uint8 TemperatureType per order
+//   IDs                  16 packed bytes per order if every ID is a UUID, or
+//                        else uint64 end offsets per order and the IDs'
+//                        concatenated bytes
+//   dictionary           uint64 end offsets per string and the strings'
+//                        concatenated bytes: distinct names, then regions
+//
+// Orders are validated once, column by column, when a file is opened.
+
+// Accumulates orders in memory and writes them out as an order columns file.
+class OrderColumnsWriter {
+ public:
+  struct Options {
+    // Whether to record each order's arrival, as the offset of its receipt
+    // time from the first order's.
+    bool record_arrivals = false;
+  };
+
+  explicit OrderColumnsWriter(Options options);
+  OrderColumnsWriter() : OrderColumnsWriter(Options()) {}
+  OrderColumnsWriter(OrderColumnsWriter const&) = delete;
+  OrderColumnsWriter& operator=(OrderColumnsWriter const&) = delete;
+
+  void Add(const Order& order);
+
+  size_t Size() const { return temps_.size(); }
+
+  // Throws std::runtime_error if |out| fails.
+  void WriteTo(std::ostream& out) const;
+
+ private:
+  // Returns the index of |string| in |strings|, adding it if new.
+  static uint32_t Intern(absl::string_view string,
+                         absl::flat_hash_map<std::string, uint32_t>* indices,
+                         std::vector<std::string>* strings);
+
+  // Switches the ID column from packed UUIDs to strings.
+  void UnpackIds();
+
+  const Options options_;
+  std::optional<absl::Time> first_receipt_time_;
+
+  std::vector<double> decay_rates_;
+  std::vector<int64_t> arrival_ns_;
+  std::vector<int32_t> shelf_lives_s_;
+  std::vector<uint32_t> names_;
+  std::vector<uint32_t> regions_;
+  std::vector<uint8_t> temps_;
+
+  // Packed while every ID is a UUID.
+  bool packed_ids_ = true;
+  std::vector<unsigned char> packed_uuids_;
+  std::vector<uint64_t> id_ends_;
+  std::string id_bytes_;
+
+  absl::flat_hash_map<std::string, uint32_t> name_indices_;
+  std::vector<std::string> name_strings_;
+  absl::flat_hash_map<std::string, uint32_t> region_indices_;
+  std::vector<std::string> region_strings_;
+};
+
+// Loads orders from an order columns file through a read-only memory mapping.
+// Columns are read in place; each order is only materialized once reached.
+class OrderColumnsReader {
+ public:
+  // Single-pass input iterator over the remaining orders, like
+  // OrderReader::Iterator.
+  class Iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::unique_ptr<Order>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type*;
+    using reference = value_type&;
+
+    Iterator() = default;
+
+    reference operator*() const { return reader_->current_; }
+    Iterator& operator++() {
+      reader_->Advance();
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+
+    // Only meaningful against end().
+    bool operator==(const Iterator& other) const {
+      return AtEnd() == other.AtEnd();
+    }
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+   private:
+    friend class OrderColumnsReader;
+    explicit Iterator(OrderColumnsReader* reader) : reader_(reader) {}
+
+    bool AtEnd() const { return reader_ == nullptr || reader_->done_; }
+
+    OrderColumnsReader* reader_ = nullptr;
+  };
+
+  // Orders are received at |clock|'s time when the file is opened plus their
+  // arrival offsets if recorded, or else at its time when each is reached.
+  // Throws std::invalid_argument if |path| cannot be mapped or holds anything
+  // but valid orders.
+  OrderColumnsReader(const std::string& path, const Clock* clock);
+  OrderColumnsReader(OrderColumnsReader const&) = delete;
+  OrderColumnsReader& operator=(OrderColumnsReader const&) = delete;
+
+  size_t Size() const { return size_; }
+  bool HasArrivals() const { return arrival_ns_ != nullptr; }
+
+  // Materializes the |index|th order.
+  std::unique_ptr<Order> At(size_t index) const;
+
+  // Starts reading on first call; all iterators share this reader's position.
+  Iterator begin();
+  Iterator end() { return Iterator(); }
+
+ private:
+  void Advance();
+
+  boost::iostreams::mapped_file_source file_;
+  const Clock* const clock_;
+  const absl::Time open_time_;
+
+  size_t size_ = 0;
+  // Columns, pointing into |file_|. Optional columns are null if absent.
+  const double* decay_rates_ = nullptr;
+  const int64_t* arrival_ns_ = nullptr;
+  const int32_t* shelf_lives_s_ = nullptr;
+  const uint32_t* names_ = nullptr;
+  const uint32_t* regions_ = nullptr;
+  const uint8_t* temps_ = nullptr;
+  const unsigned char* packed_uuids_ = nullptr;
+  const uint64_t* id_ends_ = nullptr;
+  const char* id_bytes_ = nullptr;
+  // Names, then regions, pointing into |file_|.
+  std::vector<absl::string_view> dictionary_;
+  size_t name_count_ = 0;
+
+  size_t next_ = 0;
+  bool done_ = false;
+  std::unique_ptr<Order> current_;
+};
+
+// Whether the order columns file at |path| records arrivals. Throws
+// std::invalid_argument if it isn't an order columns file.
+bool OrderColumnsHaveArrivals(const std::string& path);
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_INGEST_ORDER_COLUMNS_H_
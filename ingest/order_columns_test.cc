@@ -0,0 +1,131 @@
+#include "ingest/order_columns.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "gmock/gmock.h"
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+
+std::string TempPath(absl::string_view name) {
+  return absl::StrCat(testing::TempDir(), "/", name);
+}
+
+void WriteFile(const std::string& path, const std::string& contents) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out << contents;
+}
+
+std::string WriteColumns(const std::vector<std::unique_ptr<Order>>& orders,
+                         OrderColumnsWriter::Options options) {
+  OrderColumnsWriter writer(options);
+  for (const auto& order : orders) {
+    writer.Add(*order);
+  }
+  std::ostringstream out;
+  writer.WriteTo(out);
+  return out.str();
+}
+
+std::vector<std::unique_ptr<Order>> ReadColumns(const std::string& path,
+                                                const Clock* clock) {
+  std::vector<std::unique_ptr<Order>> orders;
+  OrderColumnsReader reader(path, clock);
+  for (auto it = reader.begin(); it != reader.end(); ++it) {
+    orders.push_back(std::move(*it));
+  }
+  return orders;
+}
+
+TEST(OrderColumnsTest, RoundTripsUuids) {
+  const absl::Time start = absl::FromUnixSeconds(1000);
+  std::vector<std::unique_ptr<Order>> orders;
+  orders.push_back(Order::CreateOrder("a8cfcb76-7f24-4420-a5ba-d46dd77bdffd",
+                                      "Pho", TemperatureType::HOT, 300, 0.5,
+                                      start));
+  orders.push_back(Order::CreateOrder("58e9b5fe-3fde-4a27-8e98-682e58a4a65d",
+                                      "Ice", TemperatureType::FROZEN, 30, 1,
+                                      start + absl::Milliseconds(250)));
+  orders.push_back(Order::CreateOrder("2ec069e3-576f-48eb-869f-74a540ef840c",
+                                      "Pho", TemperatureType::HOT, 200, 0.25,
+                                      start + absl::Seconds(2)));
+  orders[1]->region_ = "north";
+  const std::string path = TempPath("uuids.orders");
+  WriteFile(path, WriteColumns(orders, {/*record_arrivals=*/true}));
+  ASSERT_TRUE(OrderColumnsHaveArrivals(path));
+
+  const VirtualClock clock(absl::FromUnixSeconds(5000));
+  const auto read = ReadColumns(path, &clock);
+  ASSERT_EQ(read.size(), orders.size());
+  for (size_t i = 0; i < read.size(); ++i) {
+    EXPECT_EQ(read[i]->id_, orders[i]->id_);
+    EXPECT_EQ(read[i]->name_, orders[i]->name_);
+    EXPECT_EQ(read[i]->temp_, orders[i]->temp_);
+    EXPECT_EQ(read[i]->shelf_life_s_, orders[i]->shelf_life_s_);
+    EXPECT_EQ(read[i]->decay_rate_, orders[i]->decay_rate_);
+    EXPECT_EQ(read[i]->region_, orders[i]->region_);
+    EXPECT_EQ(read[i]->receipt_time_ - clock.Now(),
+              orders[i]->receipt_time_ - start);
+  }
+}
+
+TEST(OrderColumnsTest, RoundTripsOtherIds) {
+  std::vector<std::unique_ptr<Order>> orders;
+  orders.push_back(Order::CreateOrder("a8cfcb76-7f24-4420-a5ba-d46dd77bdffd",
+                                      "Pho", TemperatureType::HOT, 300, 0.5));
+  orders.push_back(
+      Order::CreateOrder("b", "Ice", TemperatureType::COLD, 30, 1));
+  orders.push_back(Order::CreateOrder(std::string(100, 'c'), "Tea",
+                                      TemperatureType::HOT, 60, 0));
+  const std::string path = TempPath("ids.orders");
+  WriteFile(path, WriteColumns(orders, {}));
+  ASSERT_FALSE(OrderColumnsHaveArrivals(path));
+
+  const VirtualClock clock;
+  OrderColumnsReader reader(path, &clock);
+  ASSERT_EQ(reader.Size(), 3);
+  EXPECT_FALSE(reader.HasArrivals());
+  for (size_t i = 0; i < reader.Size(); ++i) {
+    const auto order = reader.At(i);
+    EXPECT_EQ(order->id_, orders[i]->id_);
+    EXPECT_EQ(order->name_, orders[i]->name_);
+    EXPECT_TRUE(order->region_.empty());
+    EXPECT_EQ(order->receipt_time_, clock.Now());
+  }
+}
+
+TEST(OrderColumnsTest, Empty) {
+  const std::string path = TempPath("empty.orders");
+  WriteFile(path, WriteColumns({}, {}));
+  const VirtualClock clock;
+  EXPECT_THAT(ReadColumns(path, &clock), testing::IsEmpty());
+}
+
+TEST(OrderColumnsTest, RejectsInvalidFiles) {
+  std::vector<std::unique_ptr<Order>> orders;
+  orders.push_back(
+      Order::CreateOrder("a", "Pho", TemperatureType::HOT, 300, 0.5));
+  const std::string valid = WriteColumns(orders, {});
+  const VirtualClock clock;
+  const std::string path = TempPath("invalid.orders");
+
+  WriteFile(path, valid.substr(0, valid.size() - 8));
+  EXPECT_THROW(OrderColumnsReader(path, &clock), std::invalid_argument);
+
+  WriteFile(path, "not columns");
+  EXPECT_THROW(OrderColumnsReader(path, &clock), std::invalid_argument);
+  EXPECT_THROW(OrderColumnsHaveArrivals(path), std::invalid_argument);
+
+  // The header, then the decay rate, shelf life, name and temperature.
+  std::string corrupt = valid;
+  corrupt[64 + 8 + 8 + 8] = 7;
+  WriteFile(path, corrupt);
+  EXPECT_THROW(OrderColumnsReader(path, &clock), std::invalid_argument);
+
+  EXPECT_THROW(OrderColumnsReader(TempPath("missing.orders"), &clock),
+               std::invalid_argument);
+}
+
+}  // namespace kitchen_sim
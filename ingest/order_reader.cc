@@ -0,0 +1,187 @@
+#include "ingest/order_reader.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "absl/strings/str_cat.h"
+#include "single_include/nlohmann/json.hpp"
+
+namespace kitchen_sim {
+namespace {
+
+// Characters allowed between order objects.
+bool IsSeparator(char c) {
+  switch (c) {
+    case ' ':
+    case '\t':
+    case '\r':
+    case '\n':
+    case ',':
+    case '[':
+    case ']':
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+TemperatureType TemperatureFromString(absl::string_view string) {
+  if (string == "hot") {
+    return TemperatureType::HOT;
+  }
+  if (string == "cold") {
+    return TemperatureType::COLD;
+  }
+  if (string == "frozen") {
+    return TemperatureType::FROZEN;
+  }
+  return TemperatureType::UNKNOWN;
+}
+
+std::unique_ptr<Order> OrderReader::Next() {
+  started_ = true;
+  absl::string_view object;
+  while (NextObject(&object)) {
+    try {
+      return ParseOrder(object);
+    } catch (const std::invalid_argument& error) {
+      if (!options_.skip_invalid_orders) {
+        throw;
+      }
+    }
+  }
+  return nullptr;
+}
+
+OrderReader::Iterator OrderReader::begin() {
+  if (!started_) {
+    Advance();
+  }
+  return Iterator(this);
+}
+
+bool OrderReader::NextObject(absl::string_view* object) {
+  while (true) {
+    absl::string_view window = Window();
+    size_t start = 0;
+    while (start < window.size() && IsSeparator(window[start])) {
+      ++start;
+    }
+    if (start == window.size()) {
+      Consume(start);
+      if (!Refill()) {
+        return false;
+      }
+      continue;
+    }
+    if (window[start] != '{') {
+      throw std::invalid_argument(absl::StrCat(
+          "Unexpected character in order input: '", window.substr(start, 1),
+          "'"));
+    }
+
+    int depth = 0;
+    bool in_string = false;
+    bool escaped = false;
+    for (size_t i = start; i < window.size(); ++i) {
+      const char c = window[i];
+      if (in_string) {
+        if (escaped) {
+          escaped = false;
+        } else if (c == '\\') {
+          escaped = true;
+        } else if (c == '"') {
+          in_string = false;
+        }
+      } else if (c == '"') {
+        in_string = true;
+      } else if (c == '{') {
+        ++depth;
+      } else if (c == '}' && --depth == 0) {
+        *object = window.substr(start, i + 1 - start);
+        Consume(i + 1);
+        return true;
+      }
+    }
+
+    // Object continues past the window; rescan once more input is in.
+    Consume(start);
+    if (!Refill()) {
+      throw std::invalid_argument("Truncated order at end of input!");
+    }
+  }
+}
+
+std::unique_ptr<Order> OrderReader::ParseOrder(absl::string_view object) const {
+  try {
+    const auto json = nlohmann::json::parse(object.begin(), object.end());
+    auto order = Order::CreateOrder(
+        json.at("id").get<std::string>(), json.at("name").get<std::string>(),
+        TemperatureFromString(json.at("temp").get<std::string>()),
+        json.at("shelfLife").get<int>(), json.at("decayRate").get<double>(),
+        clock_->Now());
+    if (json.contains("region")) {
+      order->region_ = json.at("region").get<std::string>();
+    }
+    return order;
+  } catch (const nlohmann::json::exception& error) {
+    throw std::invalid_argument(
+        absl::StrCat("Malformed order ", object, ": ", error.what()));
+  }
+}
+
+StreamOrderReader::StreamOrderReader(std::unique_ptr<std::istream> input,
+                                     const Clock* clock, Options options,
+                                     size_t chunk_bytes)
+    : OrderReader(clock, options),
+      input_(std::move(input)),
+      chunk_bytes_(chunk_bytes) {}
+
+bool StreamOrderReader::Refill() {
+  // Drop consumed input so the buffer only ever holds about one chunk plus a
+  // partial object.
+  buffer_.erase(0, offset_);
+  offset_ = 0;
+  const size_t size = buffer_.size();
+  buffer_.resize(size + chunk_bytes_);
+  input_->read(&buffer_[size], chunk_bytes_);
+  buffer_.resize(size + input_->gcount());
+  return input_->gcount() > 0;
+}
+
+MappedOrderReader::MappedOrderReader(const std::string& path,
+                                     const Clock* clock, Options options)
+    : OrderReader(clock, options) {
+  std::error_code error;
+  if (std::filesystem::file_size(path, error) == 0 && !error) {
+    // Empty files cannot be mapped.
+    return;
+  }
+  try {
+    file_.open(path);
+  } catch (const std::exception& e) {
+    throw std::invalid_argument(
+        absl::StrCat("Could not map orders from path: ", path, " (", e.what(),
+                     ")"));
+  }
+  data_ = absl::string_view(file_.data(), file_.size());
+}
+
+std::unique_ptr<OrderReader> OpenOrderReader(const std::string& path,
+                                             const Clock* clock,
+                                             OrderReader::Options options) {
+  std::error_code error;
+  if (std::filesystem::is_regular_file(path, error)) {
+    return std::make_unique<MappedOrderReader>(path, clock, options);
+  }
+  auto input = std::make_unique<std::ifstream>(path, std::ios::binary);
+  if (!input->good()) {
+    throw std::invalid_argument(
+        absl::StrCat("Could not read JSON orders from path: ", path));
+  }
+  return std::make_unique<StreamOrderReader>(std::move(input), clock, options);
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,163 @@
+#ifndef KITCHEN_SIM_INGEST_ORDER_READER_H_
+#define KITCHEN_SIM_INGEST_ORDER_READER_H_
+
+#include <cstddef>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "boost/iostreams/device/mapped_file.hpp"
+#include "model/order.h"
+#include "runtime/clock.h"
+
+namespace kitchen_sim {
+
+// Maps "hot", "cold" and "frozen" to their temperature group. Anything else
+// is UNKNOWN.
+TemperatureType TemperatureFromString(absl::string_view string);
+
+// Lazily pulls orders out of a serialized order log. The input may either be a
+// JSON array of order objects or newline-delimited JSON with one object per
+// line; only the object currently being parsed is ever materialized, so memory
+// stays bounded regardless of input size.
+//
+// Each order's receipt time is the reading clock's time when it is parsed.
+class OrderReader {
+ public:
+  struct Options {
+    // Whether to skip orders that fail validation rather than throw.
+    bool skip_invalid_orders = false;
+  };
+
+  // Single-pass input iterator over the remaining orders. Dereferencing yields
+  // the current order, which may be moved out before advancing.
+  class Iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::unique_ptr<Order>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type*;
+    using reference = value_type&;
+
+    Iterator() = default;
+
+    reference operator*() const { return reader_->current_; }
+    Iterator& operator++() {
+      reader_->Advance();
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+
+    // Only meaningful against end().
+    bool operator==(const Iterator& other) const {
+      return AtEnd() == other.AtEnd();
+    }
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+   private:
+    friend class OrderReader;
+    explicit Iterator(OrderReader* reader) : reader_(reader) {}
+
+    bool AtEnd() const { return reader_ == nullptr || reader_->done_; }
+
+    OrderReader* reader_ = nullptr;
+  };
+
+  virtual ~OrderReader() = default;
+  OrderReader(OrderReader const&) = delete;
+  OrderReader& operator=(OrderReader const&) = delete;
+
+  // Returns the next valid order, or nullptr once the input is exhausted.
+  // Throws std::invalid_argument on malformed input, or on invalid orders
+  // unless |skip_invalid_orders| is set.
+  std::unique_ptr<Order> Next();
+
+  // Starts reading on first call; all iterators share this reader's position.
+  Iterator begin();
+  Iterator end() { return Iterator(); }
+
+ protected:
+  OrderReader(const Clock* clock, Options options)
+      : clock_(clock), options_(options) {}
+
+  // Unconsumed input currently available.
+  virtual absl::string_view Window() const = 0;
+  // Marks the first |bytes| of Window() as consumed.
+  virtual void Consume(size_t bytes) = 0;
+  // Makes more input available in Window(). Returns false at end of input.
+  virtual bool Refill() = 0;
+
+ private:
+  // Finds the text of the next top-level JSON object, skipping array brackets,
+  // commas and whitespace around it. |object| stays valid until the next call.
+  // Returns false at end of input.
+  bool NextObject(absl::string_view* object);
+
+  std::unique_ptr<Order> ParseOrder(absl::string_view object) const;
+
+  void Advance() {
+    current_ = Next();
+    done_ = current_ == nullptr;
+  }
+
+  const Clock* clock_;
+  const Options options_;
+
+  bool started_ = false;
+  bool done_ = false;
+  std::unique_ptr<Order> current_;
+};
+
+// Reads from an arbitrary stream (pipes, sockets, compressed inputs) in fixed
+// size chunks.
+class StreamOrderReader : public OrderReader {
+ public:
+  StreamOrderReader(std::unique_ptr<std::istream> input, const Clock* clock,
+                    Options options, size_t chunk_bytes = 64 << 10);
+
+ protected:
+  absl::string_view Window() const override {
+    return absl::string_view(buffer_).substr(offset_);
+  }
+  void Consume(size_t bytes) override { offset_ += bytes; }
+  bool Refill() override;
+
+ private:
+  std::unique_ptr<std::istream> input_;
+  const size_t chunk_bytes_;
+  std::string buffer_;
+  size_t offset_ = 0;
+};
+
+// Reads a file on local disk through a read-only memory mapping, letting the
+// OS page the file in (and out) as it is scanned. No copies are made beyond
+// the object being parsed.
+class MappedOrderReader : public OrderReader {
+ public:
+  // Throws std::invalid_argument if |path| cannot be mapped.
+  MappedOrderReader(const std::string& path, const Clock* clock,
+                    Options options);
+
+ protected:
+  absl::string_view Window() const override { return data_.substr(offset_); }
+  void Consume(size_t bytes) override { offset_ += bytes; }
+  bool Refill() override { return false; }
+
+ private:
+  boost::iostreams::mapped_file_source file_;
+  absl::string_view data_;
+  size_t offset_ = 0;
+};
+
+// Opens |path| with a MappedOrderReader if it is a regular file and falls back
+// to a StreamOrderReader otherwise (e.g. /dev/stdin or a named pipe).
+// Throws std::invalid_argument if |path| cannot be read.
+std::unique_ptr<OrderReader> OpenOrderReader(const std::string& path,
+                                             const Clock* clock,
+                                             OrderReader::Options options);
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_INGEST_ORDER_READER_H_
@@ -0,0 +1,94 @@
+#include "ingest/order_reader.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+
+std::vector<std::string> ReadIds(OrderReader* reader) {
+  std::vector<std::string> ids;
+  for (auto it = reader->begin(); it != reader->end(); ++it) {
+    ids.push_back((*it)->id_.ToString());
+  }
+  return ids;
+}
+
+std::unique_ptr<OrderReader> StringReader(const std::string& input,
+                                          bool skip_invalid_orders = false) {
+  static const VirtualClock clock;
+  // Tiny chunks so objects straddle refills.
+  return std::make_unique<StreamOrderReader>(
+      std::make_unique<std::istringstream>(input), &clock,
+      OrderReader::Options{skip_invalid_orders}, 7);
+}
+
+TEST(OrderReaderTest, JsonArray) {
+  auto reader = StringReader(R"([
+    {"id": "a", "name": "Pho", "temp": "hot", "shelfLife": 300, "decayRate": 0.5},
+    {"id": "b", "name": "Ice", "temp": "frozen", "shelfLife": 30, "decayRate": 1}
+  ])");
+  EXPECT_THAT(ReadIds(reader.get()), testing::ElementsAre("a", "b"));
+}
+
+TEST(OrderReaderTest, NewlineDelimited) {
+  auto reader = StringReader(
+      "{\"id\": \"a\", \"name\": \"Pho\", \"temp\": \"hot\", \"shelfLife\": "
+      "300, \"decayRate\": 0.5}\n"
+      "{\"id\": \"b\", \"name\": \"Ice\", \"temp\": \"frozen\", "
+      "\"shelfLife\": 30, \"decayRate\": 1}\n");
+  EXPECT_THAT(ReadIds(reader.get()), testing::ElementsAre("a", "b"));
+}
+
+TEST(OrderReaderTest, BracesInStrings) {
+  auto reader = StringReader(R"([
+    {"id": "a", "name": "}{ \"x\" pie", "temp": "cold", "shelfLife": 3, "decayRate": 0}
+  ])");
+  auto order = reader->Next();
+  ASSERT_NE(order, nullptr);
+  EXPECT_EQ(order->name_, "}{ \"x\" pie");
+  EXPECT_EQ(order->temp_, TemperatureType::COLD);
+  EXPECT_EQ(reader->Next(), nullptr);
+}
+
+TEST(OrderReaderTest, InvalidOrders) {
+  const std::string input = R"([
+    {"id": "a", "name": "Pho", "temp": "lukewarm", "shelfLife": 300, "decayRate": 0.5},
+    {"id": "b", "name": "Pho", "temp": "hot"},
+    {"id": "c", "name": "Pho", "temp": "hot", "shelfLife": 300, "decayRate": 0.5}
+  ])";
+  EXPECT_THROW(StringReader(input)->Next(), std::invalid_argument);
+  EXPECT_THAT(ReadIds(StringReader(input, true).get()),
+              testing::ElementsAre("c"));
+}
+
+TEST(OrderReaderTest, Truncated) {
+  auto reader = StringReader(R"([{"id": "a", "name": "Pho")");
+  EXPECT_THROW(reader->Next(), std::invalid_argument);
+}
+
+TEST(OrderReaderTest, MappedFile) {
+  const std::string path = testing::TempDir() + "/orders.json";
+  {
+    std::ofstream file(path);
+    file << R"([{"id": "a", "name": "Pho", "temp": "hot", "shelfLife": 300,)"
+         << R"( "decayRate": 0.5}])";
+  }
+  VirtualClock clock(absl::UnixEpoch() + absl::Hours(1));
+  auto reader = OpenOrderReader(path, &clock, {});
+  auto order = reader->Next();
+  ASSERT_NE(order, nullptr);
+  EXPECT_EQ(order->id_, "a");
+  EXPECT_EQ(order->receipt_time_, clock.Now());
+  EXPECT_EQ(reader->Next(), nullptr);
+}
+
+TEST(OrderReaderTest, MissingFile) {
+  VirtualClock clock;
+  EXPECT_THROW(OpenOrderReader("/does/not/exist", &clock, {}),
+               std::invalid_argument);
+}
+
+}  // namespace kitchen_sim
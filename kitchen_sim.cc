@@ -1,43 +1,319 @@
 #include <fstream>
 #include <iostream>
+#include <random>
 
+#include "events/async_event_log.h"
 #include "gflags/gflags.h"
+#include "ingest/order_columns.h"
 #include "kitchen_sim_lib.h"
+#include "metrics/metrics.h"
+#include "model/cooking_line.h"
+#include "model/kitchen_layout.h"
 
 DEFINE_string(json_path, "",
-              "Path to a JSON file containing serialized orders.");
+              "Path to a JSON array or newline-delimited JSON file containing "
+              "serialized orders.");
+DEFINE_string(columns_path, "",
+              "If set, simulate orders from an order columns file (see "
+              "//ingest:convert_orders) instead of --json_path. Orders arrive "
+              "at their recorded arrivals, if any.");
 
 DEFINE_string(kitchen_name, "Din Tai Fung", "Name of the simulated kitchen.");
 DEFINE_string(kitchen_size, "LARGE", "Size of the simulated kitchen.");
 DEFINE_double(orders_per_second, 2., "Parsing/handling rate for orders.");
 DEFINE_bool(continue_after_invalid_order, true,
             "Whether to continue simulation after an order parsing failure.");
+DEFINE_string(clock, "wall",
+              "Simulation clock: 'wall' runs in real time, 'virtual' runs "
+              "events back-to-back as fast as possible.");
+DEFINE_uint32(seed, 0,
+              "Seed for courier arrivals and discards (0 = nondeterministic).");
+DEFINE_uint32(kitchen_count, 1, "Number of kitchens sharing the orders.");
+DEFINE_bool(pin_threads, false,
+            "Whether to pin each thread of a wall clock simulation to a CPU "
+            "of its own.");
+DEFINE_string(routing, "id",
+              "How orders are split between kitchens: 'id' (hash of order "
+              "ID), 'region' (hash of order region) or 'round_robin'.");
+DEFINE_string(eviction_policy, "random",
+              "Which overflow order to discard when a kitchen is full: "
+              "'random', 'lowest_value', 'earliest_expiry' or "
+              "'lowest_pickup_value' (least value once its courier "
+              "arrives).");
+DEFINE_uint32(couriers, 0,
+              "Couriers serving each kitchen (0 = as many as it takes).");
+DEFINE_string(dispatch, "matched",
+              "How couriers are matched with orders: 'matched' (each courier "
+              "picks up the orders it was sent for) or 'fifo' (each courier "
+              "takes the longest-waiting orders when it arrives).");
+DEFINE_uint32(courier_capacity, 1, "Most orders a courier picks up per trip.");
+DEFINE_double(courier_delivery_s, 0.,
+              "Seconds from pickup until a courier is free for another trip.");
+DEFINE_uint32(cooking_stations, 0,
+              "Cooking stations per temperature group in each kitchen, each "
+              "cooking one batch at a time (0 = cooking is instant).");
+DEFINE_double(prep_time_s, 1.,
+              "Seconds a dish takes to cook unless given in --dish_prep_s. "
+              "Requires --cooking_stations.");
+DEFINE_string(dish_prep_s, "",
+              "Seconds particular dishes take to cook, e.g. "
+              "'Cheese Pizza=8,Ramen=4.5'. Requires --cooking_stations.");
+DEFINE_uint32(cooking_batch, 1,
+              "Most orders of the same dish a station cooks at once. Requires "
+              "--cooking_stations.");
 
-static bool FileExists(const char* flagname, const std::string& value) {
-  std::ifstream ifs(value.c_str());
-  return ifs.good();
+DEFINE_string(workload, "",
+              "If set, simulate a generated workload instead of --json_path: "
+              "'steady', 'poisson' or 'rush' (diurnal with lunch and dinner "
+              "peaks), arriving at a mean of --orders_per_second.");
+DEFINE_uint64(workload_orders, 10000, "Number of orders in --workload.");
+DEFINE_string(event_log, "",
+              "If set, write order events to this file in the background "
+              "instead of logging them as text.");
+DEFINE_string(event_log_format, "ndjson",
+              "Format of --event_log: 'ndjson' or 'binary'.");
+DEFINE_double(shelf_log_interval_s, 0.,
+              "Minimum simulated seconds between each kitchen's shelf dumps "
+              "to the info log (0 = after every event, negative = never).");
+DEFINE_string(metrics_path, "",
+              "If set, dump metrics to this path with .json and .prom "
+              "(Prometheus text) appended, periodically and at shutdown.");
+DEFINE_double(metrics_interval_s, 10.,
+              "Wall seconds between --metrics_path dumps (0 = only at "
+              "shutdown).");
+DEFINE_double(checkpoint_at_s, -1.,
+              "If non-negative, save the simulation's state to "
+              "--checkpoint_path after this many simulated seconds. Requires "
+              "--clock=virtual.");
+DEFINE_string(checkpoint_path, "checkpoint.bin",
+              "Where --checkpoint_at_s saves the simulation's state.");
+DEFINE_string(restore_path, "",
+              "If set, resume from a checkpoint saved with the same orders "
+              "and flags. Requires --clock=virtual.");
+DEFINE_string(record_path, "",
+              "If set, record every scheduling decision of the simulation to "
+              "this path for --replay_path. Kitchens then take turns rather "
+              "than run in parallel. Requires --clock=wall, and --seed "
+              "with --workload.");
+DEFINE_string(replay_path, "",
+              "If set, replay the simulation recorded at this path, on one "
+              "thread and as fast as possible, with the same orders and "
+              "flags. Requires --clock=wall.");
+
+// Validators also run on flags left at their defaults, so optional paths must
+// accept being unset.
+static bool IsUnsetOrFileExists(const char* flagname,
+                                const std::string& value) {
+  return value.empty() || std::ifstream(value).good();
 }
-DEFINE_validator(json_path, &FileExists);
+DEFINE_validator(json_path, &IsUnsetOrFileExists);
+DEFINE_validator(columns_path, &IsUnsetOrFileExists);
+DEFINE_validator(restore_path, &IsUnsetOrFileExists);
+DEFINE_validator(replay_path, &IsUnsetOrFileExists);
 
 static bool IsValidSize(const char* flagname, const std::string& value) {
-  return value == "SMALL" || value == "LARGE";
+  return kitchen_sim::FindKitchenLayout(value).has_value();
 }
 DEFINE_validator(kitchen_size, &IsValidSize);
 
+static bool IsValidClock(const char* flagname, const std::string& value) {
+  return value == "wall" || value == "virtual";
+}
+DEFINE_validator(clock, &IsValidClock);
+
+static bool IsValidRouting(const char* flagname, const std::string& value) {
+  return value == "id" || value == "region" || value == "round_robin";
+}
+DEFINE_validator(routing, &IsValidRouting);
+
+static bool IsValidEvictionPolicy(const char* flagname,
+                                  const std::string& value) {
+  try {
+    kitchen_sim::ParseEvictionPolicyType(value);
+    return true;
+  } catch (const std::invalid_argument&) {
+    return false;
+  }
+}
+DEFINE_validator(eviction_policy, &IsValidEvictionPolicy);
+
+static bool IsValidDispatch(const char* flagname, const std::string& value) {
+  try {
+    kitchen_sim::ParseDispatchType(value);
+    return true;
+  } catch (const std::invalid_argument&) {
+    return false;
+  }
+}
+DEFINE_validator(dispatch, &IsValidDispatch);
+
+static bool IsValidPrepTimes(const char* flagname, const std::string& value) {
+  try {
+    kitchen_sim::ParsePrepTimes(value);
+    return true;
+  } catch (const std::invalid_argument&) {
+    return false;
+  }
+}
+DEFINE_validator(dish_prep_s, &IsValidPrepTimes);
+
+static bool IsValidWorkload(const char* flagname, const std::string& value) {
+  return value.empty() || value == "steady" || value == "poisson" ||
+         value == "rush";
+}
+DEFINE_validator(workload, &IsValidWorkload);
+
+static bool IsValidEventLogFormat(const char* flagname,
+                                  const std::string& value) {
+  return value == "ndjson" || value == "binary";
+}
+DEFINE_validator(event_log_format, &IsValidEventLogFormat);
+
+static bool IsNonZero(const char* flagname, uint32_t value) {
+  return value > 0;
+}
+DEFINE_validator(kitchen_count, &IsNonZero);
+DEFINE_validator(courier_capacity, &IsNonZero);
+DEFINE_validator(cooking_batch, &IsNonZero);
+
 static bool IsPositive(const char* flagname, double value) { return value > 0; }
 DEFINE_validator(orders_per_second, &IsPositive);
 
+static bool IsNonNegative(const char* flagname, double value) {
+  return value >= 0;
+}
+DEFINE_validator(courier_delivery_s, &IsNonNegative);
+DEFINE_validator(prep_time_s, &IsNonNegative);
+DEFINE_validator(metrics_interval_s, &IsNonNegative);
+
 int main(int argc, char* argv[]) {
   gflags::SetUsageMessage(
-      "kitchen_sim --json_path=<path> [ --kitchen_name='Din Tai Fung' "
-      "--kitchen_size='SMALL' --orders_per_second=10 ]");
+      "kitchen_sim --json_path=<path> | --columns_path=<path> | "
+      "--workload=rush [ "
+      "--kitchen_name='Din Tai Fung' "
+      "--kitchen_size='SMALL' --orders_per_second=10 --clock=virtual "
+      "--seed=42 ]");
   gflags::SetVersionString("1.0.0");
   gflags::ParseCommandLineFlags(&argc, &argv, true);
-  kitchen_sim::KitchenSimulation simulation(
-      {FLAGS_kitchen_name, FLAGS_kitchen_size, FLAGS_orders_per_second,
-       FLAGS_continue_after_invalid_order});
+  const int input_count = !FLAGS_json_path.empty() +
+                          !FLAGS_columns_path.empty() +
+                          !FLAGS_workload.empty();
+  if (input_count != 1) {
+    std::cerr << "Exactly one of --json_path, --columns_path or --workload "
+                 "must be set."
+              << std::endl;
+    return -1;
+  }
+  if (FLAGS_cooking_stations == 0) {
+    for (const char* flag : {"prep_time_s", "dish_prep_s", "cooking_batch"}) {
+      if (!gflags::GetCommandLineFlagInfoOrDie(flag).is_default) {
+        std::cerr << "--" << flag << " requires --cooking_stations."
+                  << std::endl;
+        return -1;
+      }
+    }
+  }
+  // Traces hold the simulation's seed but not the workload's, which would
+  // otherwise differ between recording and replay.
+  if (!FLAGS_workload.empty() && FLAGS_seed == 0) {
+    for (const char* flag : {"record_path", "replay_path"}) {
+      if (!gflags::GetCommandLineFlagInfoOrDie(flag).is_default) {
+        std::cerr << "--" << flag << " with --workload requires --seed."
+                  << std::endl;
+        return -1;
+      }
+    }
+  }
+  kitchen_sim::KitchenSimulation::Options options;
+  options.kitchen_name = FLAGS_kitchen_name;
+  options.kitchen_size = FLAGS_kitchen_size;
+  options.orders_per_second = FLAGS_orders_per_second;
+  options.continue_after_invalid_order = FLAGS_continue_after_invalid_order;
+  options.clock = FLAGS_clock == "virtual" ? kitchen_sim::ClockType::VIRTUAL
+                                           : kitchen_sim::ClockType::WALL;
+  if (FLAGS_seed != 0) {
+    options.seed = FLAGS_seed;
+  }
+  options.kitchen_count = FLAGS_kitchen_count;
+  options.pin_threads = FLAGS_pin_threads;
+  if (FLAGS_routing == "region") {
+    options.routing = kitchen_sim::RoutingType::REGION;
+  } else if (FLAGS_routing == "round_robin") {
+    options.routing = kitchen_sim::RoutingType::ROUND_ROBIN;
+  }
+  options.eviction_policy =
+      kitchen_sim::ParseEvictionPolicyType(FLAGS_eviction_policy);
+  options.couriers_per_kitchen = FLAGS_couriers;
+  options.dispatch = kitchen_sim::ParseDispatchType(FLAGS_dispatch);
+  options.courier_capacity = FLAGS_courier_capacity;
+  options.courier_delivery_time = absl::Seconds(FLAGS_courier_delivery_s);
+  if (FLAGS_cooking_stations > 0) {
+    kitchen_sim::CookingLine::Options cooking;
+    for (auto temp :
+         {kitchen_sim::TemperatureType::FROZEN,
+          kitchen_sim::TemperatureType::COLD,
+          kitchen_sim::TemperatureType::HOT}) {
+      cooking.stations[static_cast<int>(temp)] = FLAGS_cooking_stations;
+    }
+    cooking.prep_times = kitchen_sim::ParsePrepTimes(FLAGS_dish_prep_s);
+    cooking.default_prep_time = absl::Seconds(FLAGS_prep_time_s);
+    cooking.max_batch = FLAGS_cooking_batch;
+    options.cooking = std::move(cooking);
+  }
+  options.shelf_log_interval =
+      FLAGS_shelf_log_interval_s < 0
+          ? absl::InfiniteDuration()
+          : absl::Seconds(FLAGS_shelf_log_interval_s);
+  // Outlives the simulation, and so is flushed once it finishes.
+  std::unique_ptr<kitchen_sim::AsyncEventLog> event_log;
+  if (!FLAGS_event_log.empty()) {
+    event_log = std::make_unique<kitchen_sim::AsyncEventLog>(
+        std::make_unique<std::ofstream>(FLAGS_event_log, std::ios::binary),
+        FLAGS_event_log_format == "binary"
+            ? kitchen_sim::AsyncEventLog::Format::BINARY
+            : kitchen_sim::AsyncEventLog::Format::NDJSON);
+    options.event_sink = event_log.get();
+  }
+  // Likewise outlives the simulation, so the final dump sees every order.
+  kitchen_sim::MetricsRegistry metrics;
+  std::unique_ptr<kitchen_sim::MetricsDumper> metrics_dumper;
+  if (!FLAGS_metrics_path.empty()) {
+    metrics_dumper = std::make_unique<kitchen_sim::MetricsDumper>(
+        &metrics, FLAGS_metrics_path, absl::Seconds(FLAGS_metrics_interval_s));
+    options.metrics = &metrics;
+  }
+  kitchen_sim::OrderGenerator::Options workload;
+  if (!FLAGS_workload.empty()) {
+    workload = kitchen_sim::OrderGenerator::Preset(FLAGS_workload);
+    workload.order_count = FLAGS_workload_orders;
+    workload.orders_per_second = FLAGS_orders_per_second;
+    workload.seed = FLAGS_seed != 0 ? FLAGS_seed : std::random_device{}();
+    options.arrive_at_receipt_time = true;
+  } else if (!FLAGS_columns_path.empty()) {
+    try {
+      options.arrive_at_receipt_time =
+          kitchen_sim::OrderColumnsHaveArrivals(FLAGS_columns_path);
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      return -1;
+    }
+  }
+  if (FLAGS_checkpoint_at_s >= 0) {
+    options.checkpoint_at = absl::Seconds(FLAGS_checkpoint_at_s);
+    options.checkpoint_path = FLAGS_checkpoint_path;
+  }
+  options.restore_path = FLAGS_restore_path;
+  options.record_path = FLAGS_record_path;
+  options.replay_path = FLAGS_replay_path;
   try {
-    simulation.RunFromJson(FLAGS_json_path);
+    kitchen_sim::KitchenSimulation simulation(options);
+    if (!FLAGS_workload.empty()) {
+      simulation.RunGenerated(workload);
+    } else if (!FLAGS_columns_path.empty()) {
+      simulation.RunFromColumns(FLAGS_columns_path);
+    } else {
+      simulation.RunFromJson(FLAGS_json_path);
+    }
     return 0;
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
@@ -1,141 +1,878 @@
-
 #include "kitchen_sim_lib.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <exception>
 #include <fstream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
 
 #include "absl/strings/str_cat.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
-#include "boost/bind.hpp"
-#include "boost/log/trivial.hpp"
-#include "single_include/nlohmann/json.hpp"
+#include "boost/asio/coroutine.hpp"
+#include "ingest/order_columns.h"
+#include "ingest/order_reader.h"
+#include "runtime/binary_io.h"
+#include "runtime/block_pool.h"
 
 namespace kitchen_sim {
 namespace {
 
-constexpr absl::string_view kReceived = "RECEIVED";
-constexpr absl::string_view kCooked = "COOKED";
-constexpr absl::string_view kDelivered = "DELIVERED";
+// Bound on orders routed to a virtual clock kitchen but not yet simulated.
+constexpr size_t kArrivalBufferSize = 1024;
+
+// Per-kitchen intake queue in wall clock mode, and how many queued orders a
+// kitchen places at a time.
+constexpr size_t kIntakeCapacity = 1024;
+constexpr size_t kIntakeBatchSize = 64;
+// How long order intake holds off when a kitchen's intake queue is full.
+constexpr absl::Duration kIntakeRetryDelay = absl::Milliseconds(1);
+
+// Identifies simulation checkpoint files, and the version of their layout.
+constexpr absl::string_view kCheckpointMagic = "kitchen_sim checkpoint";
+constexpr uint32_t kCheckpointVersion = 1;
+
+// Identifies recorded simulation traces, and the version of their layout.
+constexpr absl::string_view kTraceMagic = "kitchen_sim trace";
+constexpr uint32_t kTraceVersion = 1;
+
+// What a trace holds besides the ScheduleTrace: everything else a replay
+// needs to make the same random draws.
+struct TraceHeader {
+  uint32_t seed;
+  uint32_t kitchen_count;
+};
+
+void WriteTraceHeader(const TraceHeader& header, BinaryWriter* writer) {
+  writer->WriteString(kTraceMagic);
+  writer->Write<uint32_t>(kTraceVersion);
+  writer->Write<uint32_t>(header.seed);
+  writer->Write<uint32_t>(header.kitchen_count);
+}
+
+// Throws std::invalid_argument unless |reader| holds a trace this build can
+// replay.
+TraceHeader ReadTraceHeader(BinaryReader* reader) {
+  if (reader->ReadString() != kTraceMagic ||
+      reader->Read<uint32_t>() != kTraceVersion) {
+    throw std::invalid_argument("Not a simulation trace!");
+  }
+  TraceHeader header;
+  header.seed = reader->Read<uint32_t>();
+  header.kitchen_count = reader->Read<uint32_t>();
+  return header;
+}
+
+// What a checkpoint holds besides each kitchen's part.
+struct CheckpointHeader {
+  absl::Time start_time;
+  // Simulated time the checkpoint was taken at.
+  absl::Time at_time;
+  uint32_t kitchen_count;
+};
 
-// Random time 2-6 seconds later.
-absl::Time CourierArrivalTime(std::mt19937& rand) {
-  std::uniform_int_distribution<int> dist(2, 6);
-  return absl::Now() + absl::Seconds(dist(rand));
+void WriteCheckpointHeader(const CheckpointHeader& header,
+                           BinaryWriter* writer) {
+  writer->WriteString(kCheckpointMagic);
+  writer->Write<uint32_t>(kCheckpointVersion);
+  writer->WriteTime(header.start_time);
+  writer->WriteTime(header.at_time);
+  writer->Write<uint32_t>(header.kitchen_count);
 }
 
+// Throws std::invalid_argument unless |reader| holds a checkpoint this build
+// can restore.
+CheckpointHeader ReadCheckpointHeader(BinaryReader* reader) {
+  if (reader->ReadString() != kCheckpointMagic ||
+      reader->Read<uint32_t>() != kCheckpointVersion) {
+    throw std::invalid_argument("Not a simulation checkpoint!");
+  }
+  CheckpointHeader header;
+  header.start_time = reader->ReadTime();
+  header.at_time = reader->ReadTime();
+  header.kitchen_count = reader->Read<uint32_t>();
+  return header;
+}
+
+// Throws std::runtime_error if |path| can't be read.
+std::string ReadFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  std::ostringstream contents;
+  if (!file || !(contents << file.rdbuf())) {
+    throw std::runtime_error(absl::StrCat("Could not read: ", path));
+  }
+  return contents.str();
+}
+
+// Writes |contents| beside |path| and renames it into place, so that |path|
+// never holds a partial file. Throws std::runtime_error on failure.
+void WriteFileAtomically(const std::string& path, absl::string_view contents) {
+  const std::string temp_path = absl::StrCat(path, ".tmp");
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), contents.size());
+    if (!file.flush()) {
+      throw std::runtime_error(absl::StrCat("Could not write: ", temp_path));
+    }
+  }
+  if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    throw std::runtime_error(absl::StrCat("Could not write: ", path));
+  }
+}
+
+// Gathers each kitchen's part of a checkpoint as its thread reaches the
+// checkpoint time, and writes the file once every kitchen's is in.
+class CheckpointCollector {
+ public:
+  CheckpointCollector(std::string path, std::string header,
+                      size_t kitchen_count)
+      : path_(std::move(path)),
+        header_(std::move(header)),
+        parts_(kitchen_count),
+        remaining_(kitchen_count) {}
+
+  void Submit(size_t index, std::string part) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    parts_[index] = std::move(part);
+    if (--remaining_ > 0) {
+      return;
+    }
+    std::string contents = std::move(header_);
+    for (const std::string& kitchen_part : parts_) {
+      contents.append(kitchen_part);
+    }
+    WriteFileAtomically(path_, contents);
+  }
+
+ private:
+  const std::string path_;
+  std::mutex mutex_;
+  std::string header_;
+  std::vector<std::string> parts_;
+  size_t remaining_;
+};
+
+// Keeps the first exception thrown by any of several threads.
+class FirstError {
+ public:
+  void Record(std::exception_ptr error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!error_) {
+      error_ = error;
+    }
+  }
+
+  void RethrowIfAny() {
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  std::exception_ptr error_;
+};
+
+// Copies shared orders one at a time, as a simulation reaches them. Iterators
+// share the copier's position, like OrderReader::Iterator.
+class OrderCopier {
+ public:
+  class Iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::unique_ptr<Order>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type*;
+    using reference = value_type&;
+
+    Iterator() = default;
+    explicit Iterator(OrderCopier* copier) : copier_(copier) {}
+
+    reference operator*() const { return copier_->current_; }
+    Iterator& operator++() {
+      copier_->Advance();
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+
+    // Only meaningful against end().
+    bool operator==(const Iterator& other) const {
+      return AtEnd() == other.AtEnd();
+    }
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+   private:
+    bool AtEnd() const {
+      return copier_ == nullptr || copier_->current_ == nullptr;
+    }
+
+    OrderCopier* copier_ = nullptr;
+  };
+
+  // Copies are received at |clock|'s time as they are made, or keep their
+  // receipt times if |clock| is null.
+  OrderCopier(const std::vector<std::unique_ptr<Order>>& orders,
+              const Clock* clock)
+      : orders_(orders), clock_(clock) {
+    Advance();
+  }
+
+  Iterator begin() { return Iterator(this); }
+  Iterator end() { return Iterator(); }
+
+ private:
+  void Advance() {
+    if (next_ == orders_.size()) {
+      current_ = nullptr;
+      return;
+    }
+    const Order& order = *orders_[next_++];
+    current_ = std::make_unique<Order>(
+        order.id_, order.name_, order.temp_, order.shelf_life_s_,
+        order.decay_rate_,
+        clock_ != nullptr ? clock_->Now() : order.receipt_time_);
+    current_->region_ = order.region_;
+  }
+
+  const std::vector<std::unique_ptr<Order>>& orders_;
+  const Clock* const clock_;
+  size_t next_ = 0;
+  std::unique_ptr<Order> current_;
+};
+
 }  // namespace
 
+// One order's trip through a kitchen, from receipt until it leaves, written as
+// a stackless coroutine. Each stage runs on the kitchen's scheduler. The order
+// owns its lifecycle, which waits on whatever holds the order: the cooking
+// line or intake resumes it once the order is shelved, and the kitchen once
+// the order leaves. Neither does so while a stage is still running. An order
+// in flight costs just this one pooled object more.
+class KitchenSimulation::OrderLifecycle : public OrderListener,
+                                          boost::asio::coroutine {
+ public:
+  OrderLifecycle(KitchenSimulation* simulation, size_t index)
+      : simulation_(simulation), index_(index) {}
+  OrderLifecycle(OrderLifecycle const&) = delete;
+  OrderLifecycle& operator=(OrderLifecycle const&) = delete;
+
+  static void* operator new(size_t size) {
+    return size == sizeof(OrderLifecycle)
+               ? BlockPool<OrderLifecycle>::Allocate()
+               : ::operator new(size);
+  }
+  static void operator delete(void* block, size_t size) {
+    if (size == sizeof(OrderLifecycle)) {
+      BlockPool<OrderLifecycle>::Free(block);
+    } else {
+      ::operator delete(block);
+    }
+  }
+
+  // Gives |order|, just arrived at kitchen |index|, a lifecycle and runs it
+  // up to its first wait, having the kitchen cook the order. Virtual clock
+  // mode.
+  static void Start(KitchenSimulation* simulation, size_t index,
+                    std::unique_ptr<Order> order) {
+    Kitchen& kitchen = simulation->fleet_.At(index);
+    if (!kitchen.Layout().HasShelf(order->temp_)) {
+      // Rejected as usual, but without a lifecycle that the order would free
+      // halfway through its first stage.
+      kitchen.TakeOrder(std::move(order), kitchen.GetScheduler().Now());
+      return;
+    }
+    auto lifecycle = std::make_unique<OrderLifecycle>(simulation, index);
+    OrderLifecycle* self = lifecycle.get();
+    order->SetListener(std::move(lifecycle));
+    self->Resume(std::move(order), nullptr);
+  }
+
+  // Gives |order|, bound for kitchen |index|, a lifecycle and runs it up to
+  // its first wait, for the kitchen's intake to have the order cooked. Wall
+  // clock mode.
+  static void Attach(KitchenSimulation* simulation, size_t index,
+                     Order* order) {
+    auto lifecycle = std::make_unique<OrderLifecycle>(simulation, index);
+    lifecycle->Resume(nullptr, nullptr);
+    order->SetListener(std::move(lifecycle));
+  }
+
+  // Resumes the lifecycle of |order|, just shelved by its kitchen.
+  static void Cooked(Order* order) {
+    static_cast<OrderLifecycle*>(order->Listener())->Resume(nullptr, order);
+  }
+
+  void OnRemoved(Order* order, RemovalReason reason,
+                 absl::Time at_time) override {
+    removal_ = reason;
+    removed_at_ = at_time;
+    Resume(nullptr, order);
+  }
+
+ private:
+  // Runs stages until the next wait. |received| is set on starting from
+  // receipt, and |order| on resuming once the order is shelved or has left.
+  void Resume(std::unique_ptr<Order> received, Order* order);
+
+  // Has the kitchen cook |order|, just received. Returns the shelved order if
+  // cooking is instant, or nullptr if it waits for a cooking station, in which
+  // case Cooked() resumes the lifecycle once it is shelved.
+  Order* Cook(std::unique_ptr<Order> order) {
+    Kitchen& kitchen = simulation_->fleet_.At(index_);
+    const absl::Time now = simulation_->schedulers_[index_]->Now();
+    kitchen.RecordEvent(EventType::RECEIVED, *order, now);
+    if (!simulation_->cooking_lines_.empty()) {
+      simulation_->cooking_lines_[index_]->Cook(std::move(order));
+      return nullptr;
+    }
+    return WaitAndGet(kitchen.TakeOrder(std::move(order), now));
+  }
+
+  // Records how long |order| spent from receipt until it left the kitchen,
+  // under the reason it left.
+  void RecordLifetime(const Order& order) const {
+    if (simulation_->lifetimes_.empty()) {
+      return;
+    }
+    simulation_->lifetimes_[index_][static_cast<int>(removal_.value())]
+        ->Record(std::max<int64_t>(0, absl::ToInt64Milliseconds(
+                                          removed_at_ - order.receipt_time_)));
+  }
+
+  KitchenSimulation* const simulation_;
+  const size_t index_;
+  // Set once the order has left the kitchen.
+  std::optional<RemovalReason> removal_;
+  absl::Time removed_at_;
+};
+
+#include "boost/asio/yield.hpp"
+
+void KitchenSimulation::OrderLifecycle::Resume(
+    std::unique_ptr<Order> received, Order* order) {
+  reenter(this) {
+    // 1. Order received and cooked: straight away, or once its cooking line
+    // or the kitchen's intake has it shelved.
+    if (received != nullptr) {
+      order = Cook(std::move(received));
+    }
+    if (order == nullptr) {
+      yield;
+    }
+    if (!removal_.has_value()) {
+      // 2. A courier is sent for it, and the order waits on its shelf. Only
+      // orders discarded by a later order of their own batch skip this.
+      yield simulation_->couriers_[index_]->Dispatch(order);
+    }
+    // 3. Order leaves the kitchen: picked up by its courier, or expired or
+    // discarded first, which its courier finds out on arrival.
+    RecordLifetime(*order);
+  }
+}
+
+#include "boost/asio/unyield.hpp"
+
+KitchenSimulation::KitchenSimulation(const Options options)
+    : options_(options),
+      replayed_trace_(options_.replay_path.empty()
+                          ? ""
+                          : ReadFile(options_.replay_path)),
+      seed_([&] {
+        if (!replayed_trace_.empty()) {
+          BinaryReader reader(replayed_trace_);
+          return ReadTraceHeader(&reader).seed;
+        }
+        return options_.seed.has_value() ? options_.seed.value()
+                                         : random_device_();
+      }()),
+      restored_checkpoint_(options_.restore_path.empty()
+                               ? ""
+                               : ReadFile(options_.restore_path)),
+      start_time_([&] {
+        if (restored_checkpoint_.empty()) {
+          return absl::Now();
+        }
+        BinaryReader reader(restored_checkpoint_);
+        return ReadCheckpointHeader(&reader).start_time;
+      }()),
+      recorder_(options_.record_path.empty()
+                    ? nullptr
+                    : std::make_unique<TraceRecorder>()),
+      replayer_([&]() -> std::unique_ptr<TraceReplayer> {
+        if (replayed_trace_.empty()) {
+          return nullptr;
+        }
+        BinaryReader reader(replayed_trace_);
+        ReadTraceHeader(&reader);
+        return std::make_unique<TraceReplayer>(ScheduleTrace::Read(&reader));
+      }()),
+      executor_([&] {
+        ShardedExecutor::Options executor_options;
+        // Recorded handlers take turns, and schedule across kitchens while
+        // doing so, which only a single shard allows.
+        executor_options.shard_count =
+            recorder_ != nullptr
+                ? 1
+                : std::max(1u, std::min(options_.thread_count,
+                                        options_.kitchen_count + 1));
+        executor_options.pin_threads = options_.pin_threads;
+        return executor_options;
+      }()),
+      intake_scheduler_(executor_.Context(IntakeShard())),
+      intake_clock_(start_time_),
+      schedulers_([&] {
+        std::vector<std::unique_ptr<Scheduler>> schedulers;
+        for (unsigned int i = 0; i < options_.kitchen_count; ++i) {
+          if (options_.clock == ClockType::VIRTUAL) {
+            schedulers.push_back(
+                std::make_unique<VirtualScheduler>(start_time_));
+          } else {
+            // Bound to the kitchen's shard, like everything scheduled on it.
+            schedulers.push_back(std::make_unique<TimingWheel>(
+                executor_.Context(KitchenShard(i))));
+          }
+        }
+        return schedulers;
+      }()),
+      fleet_(
+          [&] {
+            KitchenFleet::Options fleet_options;
+            for (unsigned int i = 0; i < options_.kitchen_count; ++i) {
+              fleet_options.kitchens.push_back(
+                  KitchenOptions(options_, i, seed_ + i));
+            }
+            fleet_options.routing = options_.routing;
+            return fleet_options;
+          }(),
+          [&] {
+            std::vector<Scheduler*> schedulers;
+            for (const auto& scheduler : schedulers_) {
+              if (replayer_ != nullptr) {
+                schedulers.push_back(replayer_->AddScheduler());
+              } else if (recorder_ != nullptr) {
+                schedulers.push_back(recorder_->Record(scheduler.get()));
+              } else {
+                schedulers.push_back(scheduler.get());
+              }
+            }
+            return schedulers;
+          }()),
+      intake_(replayer_ != nullptr   ? replayer_->AddScheduler()
+              : recorder_ != nullptr ? recorder_->Record(&intake_scheduler_)
+                                     : &intake_scheduler_),
+      progress_(options_.kitchen_count) {
+  if ((options_.checkpoint_at.has_value() || !options_.restore_path.empty()) &&
+      options_.clock != ClockType::VIRTUAL) {
+    throw std::invalid_argument("Checkpoints require a virtual clock!");
+  }
+  if (options_.checkpoint_at.has_value() && options_.checkpoint_path.empty()) {
+    throw std::invalid_argument("Checkpoint path must be set!");
+  }
+  if ((options_.checkpoint_at.has_value() || !options_.restore_path.empty()) &&
+      options_.cooking.has_value()) {
+    throw std::invalid_argument("Checkpoints don't cover cooking stations!");
+  }
+  if ((recorder_ != nullptr || replayer_ != nullptr) &&
+      options_.clock != ClockType::WALL) {
+    throw std::invalid_argument(
+        "Only wall clock simulations are recorded; virtual clock ones are "
+        "reproduced by their seed alone!");
+  }
+  if (recorder_ != nullptr && replayer_ != nullptr) {
+    throw std::invalid_argument("Cannot record a replay!");
+  }
+  if (replayer_ != nullptr) {
+    BinaryReader reader(replayed_trace_);
+    if (ReadTraceHeader(&reader).kitchen_count != fleet_.size()) {
+      throw std::invalid_argument(
+          "Trace was recorded with a different number of kitchens!");
+    }
+  }
+  for (size_t i = 0; i < fleet_.size(); ++i) {
+    CourierFleet::Options courier_options;
+    courier_options.courier_count = options_.couriers_per_kitchen;
+    courier_options.dispatch = options_.dispatch;
+    courier_options.max_batch = options_.courier_capacity;
+    courier_options.delivery_time = options_.courier_delivery_time;
+    courier_options.seed = seed_ + i;
+    courier_options.metrics = options_.metrics;
+    couriers_.push_back(
+        std::make_unique<CourierFleet>(courier_options, &fleet_.At(i)));
+    if (options_.cooking.has_value()) {
+      CookingLine::Options cooking_options = options_.cooking.value();
+      cooking_options.on_cooked = &OrderLifecycle::Cooked;
+      cooking_options.metrics = options_.metrics;
+      cooking_lines_.push_back(
+          std::make_unique<CookingLine>(cooking_options, &fleet_.At(i)));
+    }
+    if (options_.metrics != nullptr) {
+      static constexpr const char* kOutcomes[kRemovalReasonCount] = {
+          "picked_up", "expired", "discarded"};
+      auto& lifetimes = lifetimes_.emplace_back();
+      for (int reason = 0; reason < kRemovalReasonCount; ++reason) {
+        lifetimes[reason] = options_.metrics->GetHistogram(
+            "order_lifetime_ms",
+            "Simulated milliseconds from receipt until the order left the "
+            "kitchen.",
+            {{"kitchen", fleet_.At(i).Name()},
+             {"outcome", kOutcomes[reason]}});
+      }
+    }
+  }
+  if (options_.clock == ClockType::WALL) {
+    for (size_t i = 0; i < fleet_.size(); ++i) {
+      KitchenIntake::Options intake_options = {
+          kIntakeCapacity, kIntakeBatchSize, &OrderLifecycle::Cooked};
+      if (!cooking_lines_.empty()) {
+        intake_options.cooking_line = cooking_lines_[i].get();
+      }
+      if (recorder_ == nullptr && replayer_ == nullptr) {
+        // Intake runs on a shard of its own, which may only reach the
+        // kitchen's by posting to it.
+        intake_options.post_drain = [this, i](Scheduler::Handler drain) {
+          executor_.Post(KitchenShard(i), std::move(drain));
+        };
+      }
+      intakes_.push_back(
+          std::make_unique<KitchenIntake>(&fleet_.At(i), intake_options));
+    }
+  }
+}
+
+KitchenLayout KitchenSimulation::KitchenSizeLayout(
+    absl::string_view kitchen_size) {
+  return FindKitchenLayout(kitchen_size).value_or(kLargeKitchenLayout);
+}
+
+Kitchen::Options KitchenSimulation::KitchenOptions(const Options& options,
+                                                   size_t index,
+                                                   uint32_t seed) {
+  const std::string name =
+      options.kitchen_count > 1
+          ? absl::StrCat(options.kitchen_name, " #", index)
+          : options.kitchen_name;
+  Kitchen::Options kitchen_options;
+  kitchen_options.name = name;
+  kitchen_options.layout = options.layout.has_value()
+                               ? options.layout.value()
+                               : KitchenSizeLayout(options.kitchen_size);
+  kitchen_options.seed = seed;
+  kitchen_options.eviction_policy = options.eviction_policy;
+  kitchen_options.index = static_cast<uint16_t>(index);
+  kitchen_options.event_sink = options.event_sink;
+  kitchen_options.shelf_log_interval = options.shelf_log_interval;
+  kitchen_options.metrics = options.metrics;
+  return kitchen_options;
+}
+
+void KitchenSimulation::ScheduleNextArrival(size_t index,
+                                            ArrivalChannel* channel,
+                                            RestoredTimers* restored) {
+  Arrival arrival;
+  if (channel->pop(arrival) != fibers::channel_op_status::success) {
+    return;  // Closed and drained.
+  }
+  auto handler = [this, index, channel,
+                  order = std::move(arrival.order)]() mutable {
+    KitchenProgress& progress = progress_[index];
+    progress.next_arrival.reset();
+    ++progress.arrivals;
+    OrderLifecycle::Start(this, index, std::move(order));
+    ScheduleNextArrival(index, channel);
+  };
+  KitchenProgress& progress = progress_[index];
+  if (restored != nullptr) {
+    restored->Add(progress.next_arrival.value(), arrival.at_time,
+                  std::move(handler), &progress.next_arrival.value());
+    return;
+  }
+  progress.next_arrival =
+      schedulers_[index]->ScheduleAt(arrival.at_time, std::move(handler));
+}
+
+std::string KitchenSimulation::CheckpointKitchen(size_t index) const {
+  std::string part;
+  BinaryWriter writer(&part);
+  const KitchenProgress& progress = progress_[index];
+  writer.Write<uint64_t>(progress.arrivals);
+  writer.Write<bool>(progress.next_arrival.has_value());
+  if (progress.next_arrival.has_value()) {
+    writer.Write<uint64_t>(progress.next_arrival.value());
+  }
+  fleet_.At(index).Checkpoint(&writer);
+  couriers_[index]->Checkpoint(&writer);
+  return part;
+}
+
+absl::Time KitchenSimulation::RestoreCheckpoint(
+    std::vector<RestoredTimers>* timers) {
+  BinaryReader reader(restored_checkpoint_);
+  const CheckpointHeader header = ReadCheckpointHeader(&reader);
+  if (header.kitchen_count != fleet_.size()) {
+    throw std::invalid_argument(
+        "Checkpoint was taken with a different number of kitchens!");
+  }
+  for (size_t i = 0; i < fleet_.size(); ++i) {
+    static_cast<VirtualScheduler*>(schedulers_[i].get())
+        ->RunUntil(header.at_time);
+    KitchenProgress& progress = progress_[i];
+    progress.arrivals = reader.Read<uint64_t>();
+    if (reader.Read<bool>()) {
+      progress.next_arrival = reader.Read<uint64_t>();
+    }
+    fleet_.At(i).Restore(&reader, &(*timers)[i]);
+    couriers_[i]->Restore(&reader, &(*timers)[i]);
+  }
+  if (!reader.AtEnd()) {
+    throw std::invalid_argument("Unexpected data at end of checkpoint!");
+  }
+  return header.at_time;
+}
+
 template <typename OrderIterator>
 void KitchenSimulation::Tick(OrderIterator begin, OrderIterator end,
-                             absl::Duration interval,
-                             boost::asio::system_timer* timer) {
-  std::unique_ptr<Order> order = std::move(*begin);
-  const std::string order_id = order->id_;
-  BOOST_LOG_TRIVIAL(debug) << order->LogMessage(kReceived);
-
-  // 1. Order cooked.
-  Order* cooked_order = WaitAndGet(kitchen_.TakeOrder(std::move(order)));
-  BOOST_LOG_TRIVIAL(info) << cooked_order->LogMessage(kCooked);
-  kitchen_.LogShelves();
-
-  // 2. Courier accepts.
-  auto courier = std::make_unique<Courier>();
-  courier->AcceptOrder({order_id, &kitchen_});
-  BOOST_LOG_TRIVIAL(debug) << cooked_order->LogMessage("ACCEPTED");
-
-  cooked_order->courier_timer_ =
-      std::make_unique<boost::asio::system_timer>(context_);
-  cooked_order->courier_timer_->expires_at(
-      absl::ToChronoTime(CourierArrivalTime(rand_)));
-  cooked_order->courier_timer_->async_wait(boost::asio::bind_executor(
-      kitchen_.Strand(),
-      [=, courier = move(courier)](const boost::system::error_code& e) {
-        if (e == boost::asio::error::operation_aborted) return;
-        // 3. Courier arrives.
-        // 4. Order is delivered.
-        auto delivered_order = WaitAndGet(courier->PickupCurrentOrder());
-        if (delivered_order != nullptr) {
-          BOOST_LOG_TRIVIAL(info) << delivered_order->LogMessage(kDelivered);
-          kitchen_.LogShelves();
-        } else {
-          // Already expired or discarded.
-        }
-      }));
+                             absl::Duration interval, int64_t index,
+                             absl::Time first_arrival) {
+  std::unique_ptr<Order>& order = *begin;
+  const size_t kitchen = fleet_.Route(*order);
+  if (order->Listener() == nullptr) {
+    // Not yet handed back by a full intake queue.
+    OrderLifecycle::Attach(this, kitchen, order.get());
+  }
+  if (!intakes_[kitchen]->TrySubmit(&order)) {
+    // The kitchen is falling behind; hold back the rest of the stream until
+    // it has drained some of its queue.
+    intake_->ScheduleAfter(kIntakeRetryDelay, [=] {
+      Tick(begin, end, interval, index, first_arrival);
+    });
+    return;
+  }
 
   // Schedule continuation.
   begin++;
+  ++index;
   if (begin != end) {
-    timer->expires_after(absl::ToChronoMilliseconds(interval));
-    timer->async_wait([=](const boost::system::error_code& e) {
-      if (e == boost::asio::error::operation_aborted) return;
-      Tick(begin, end, interval, timer);
-    });
+    intake_->ScheduleAt(
+        first_arrival + ArrivalOffset(**begin, index, interval),
+        [=] { Tick(begin, end, interval, index, first_arrival); });
   }
 }
 
 template <typename OrderIterator>
-void KitchenSimulation::Run(OrderIterator begin, OrderIterator end) {
-  std::cout << "SIMULATION START!" << std::endl;
-  absl::Duration interval = absl::Seconds(1. / options_.orders_per_second);
+void KitchenSimulation::RunWall(OrderIterator begin, OrderIterator end,
+                                absl::Duration interval) {
+  if (begin != end) {
+    const absl::Time first_arrival = intake_->Now();
+    intake_->ScheduleAt(
+        first_arrival + ArrivalOffset(**begin, 0, interval),
+        [=] { Tick(begin, end, interval, /*index=*/0, first_arrival); });
+  }
+  if (replayer_ != nullptr) {
+    // Every handler the recording ran, in the same order, on this thread.
+    replayer_->Run();
+    return;
+  }
+
+  // Orders are parsed as they arrive, so the first failure stops the
+  // simulation and is rethrown here.
+  std::exception_ptr error;
+  try {
+    executor_.Run();
+  } catch (...) {
+    error = std::current_exception();
+  }
+  if (recorder_ != nullptr) {
+    // Saved even if the simulation failed, so that a replay fails the same.
+    std::string trace;
+    BinaryWriter writer(&trace);
+    WriteTraceHeader({seed_, static_cast<uint32_t>(fleet_.size())}, &writer);
+    recorder_->Finish().Write(&writer);
+    WriteFileAtomically(options_.record_path, trace);
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
 
-  // Set up primary tick timer.
-  boost::asio::system_timer timer(context_);
-  timer.async_wait([=, &timer](const boost::system::error_code& e) {
-    if (e == boost::asio::error::operation_aborted) return;
-    Tick(begin, end, interval, &timer);
-  });
+template <typename OrderIterator>
+void KitchenSimulation::RunVirtual(OrderIterator begin, OrderIterator end,
+                                   absl::Duration interval) {
+  std::vector<RestoredTimers> restored(fleet_.size());
+  absl::Time restored_time = start_time_;
+  if (!restored_checkpoint_.empty()) {
+    restored_time = RestoreCheckpoint(&restored);
+  }
+  // Orders restored kitchens took before the checkpoint are still routed and
+  // timed, so routing and arrivals carry on as they were, but not resent.
+  std::vector<uint64_t> skipped(fleet_.size());
+  for (size_t i = 0; i < fleet_.size(); ++i) {
+    skipped[i] = progress_[i].arrivals;
+  }
+  std::unique_ptr<CheckpointCollector> checkpoint;
+  const absl::Time checkpoint_time =
+      start_time_ + options_.checkpoint_at.value_or(absl::ZeroDuration());
+  if (options_.checkpoint_at.has_value()) {
+    if (checkpoint_time < restored_time) {
+      throw std::invalid_argument(
+          "Cannot checkpoint before the restored checkpoint!");
+    }
+    std::string header;
+    BinaryWriter writer(&header);
+    WriteCheckpointHeader({start_time_, checkpoint_time,
+                           static_cast<uint32_t>(fleet_.size())},
+                          &writer);
+    checkpoint = std::make_unique<CheckpointCollector>(
+        options_.checkpoint_path, std::move(header), fleet_.size());
+  }
 
-  // Set up thread pool and run.
+  // Kitchens never interact, so each one runs its own discrete-event loop on
+  // its own thread, fed in arrival order by the router below.
+  FirstError error;
+  std::vector<std::unique_ptr<ArrivalChannel>> channels;
   std::vector<std::thread> threads;
-  for (auto i = 0; i < options_.thread_count; ++i) {
-    threads.emplace_back([=] { context_.run(); });
+  for (size_t i = 0; i < fleet_.size(); ++i) {
+    channels.push_back(std::make_unique<ArrivalChannel>(kArrivalBufferSize));
+  }
+  for (size_t i = 0; i < fleet_.size(); ++i) {
+    threads.emplace_back([&, i] {
+      try {
+        auto* scheduler = static_cast<VirtualScheduler*>(schedulers_[i].get());
+        if (restored_checkpoint_.empty()) {
+          ScheduleNextArrival(i, channels[i].get());
+        } else if (progress_[i].next_arrival.has_value()) {
+          // The first order routed here is the one that was pending.
+          ScheduleNextArrival(i, channels[i].get(), &restored[i]);
+        }
+        restored[i].ScheduleAll(scheduler);
+        if (checkpoint != nullptr) {
+          scheduler->RunUntil(checkpoint_time);
+          checkpoint->Submit(i, CheckpointKitchen(i));
+        }
+        scheduler->Run();
+      } catch (...) {
+        error.Record(std::current_exception());
+        // Unblocks the router.
+        channels[i]->close();
+      }
+    });
+  }
+
+  try {
+    for (int64_t i = 0; begin != end; ++i) {
+      std::unique_ptr<Order> order = std::move(*begin);
+      const absl::Time arrival_time =
+          start_time_ + ArrivalOffset(*order, i, interval);
+      const size_t index = fleet_.Route(*order);
+      if (skipped[index] > 0) {
+        --skipped[index];
+      } else if (channels[index]->push({std::move(order), arrival_time}) !=
+                 fibers::channel_op_status::success) {
+        break;  // That kitchen failed.
+      }
+      // The next order is parsed (and so received) when it arrives.
+      intake_clock_.AdvanceTo(arrival_time + interval);
+      begin++;
+    }
+  } catch (...) {
+    error.Record(std::current_exception());
+  }
+  for (auto& channel : channels) {
+    channel->close();
   }
   for (auto& thread : threads) {
     thread.join();
   }
-  std::cout << "SIMULATION END!" << std::endl;
+  error.RethrowIfAny();
 }
 
-namespace {
-TemperatureType FromString(const std::string& string) {
-  if (string == "hot") {
-    return TemperatureType::HOT;
+template <typename OrderIterator>
+void KitchenSimulation::Run(OrderIterator begin, OrderIterator end) {
+  if (options_.print_summary) {
+    std::cout << "SIMULATION START!" << std::endl;
+  }
+  absl::Duration interval = absl::Seconds(1. / options_.orders_per_second);
+  if (options_.clock == ClockType::VIRTUAL) {
+    RunVirtual(begin, end, interval);
+  } else {
+    RunWall(begin, end, interval);
+  }
+  if (options_.print_summary) {
+    std::cout << "SIMULATION END!" << std::endl;
+    LogStats();
   }
-  if (string == "cold") {
-    return TemperatureType::COLD;
+}
+
+template void KitchenSimulation::Run(
+    std::vector<std::unique_ptr<Order>>::iterator begin,
+    std::vector<std::unique_ptr<Order>>::iterator end);
+template void KitchenSimulation::Run(OrderReader::Iterator begin,
+                                     OrderReader::Iterator end);
+template void KitchenSimulation::Run(OrderGenerator::Iterator begin,
+                                     OrderGenerator::Iterator end);
+template void KitchenSimulation::Run(OrderColumnsReader::Iterator begin,
+                                     OrderColumnsReader::Iterator end);
+
+absl::Duration KitchenSimulation::ArrivalOffset(const Order& order,
+                                                int64_t index,
+                                                absl::Duration interval) {
+  if (!options_.arrive_at_receipt_time) {
+    return index * interval;
   }
-  if (string == "frozen") {
-    return TemperatureType::FROZEN;
+  if (!first_receipt_time_.has_value()) {
+    first_receipt_time_ = order.receipt_time_;
   }
-  return TemperatureType::UNKNOWN;
+  return std::max(absl::ZeroDuration(),
+                  order.receipt_time_ - first_receipt_time_.value());
 }
-}  // namespace
 
-void KitchenSimulation::RunFromJson(const std::string& json_path) {
-  std::ifstream ifs(json_path);
-  if (!ifs.good()) {
-    throw std::invalid_argument(
-        absl::StrCat("Could not read JSON orders from path: ", json_path));
-  }
-  nlohmann::json json;
-  ifs >> json;
-
-  std::vector<std::unique_ptr<Order>> orders;
-  for (const auto& kv : json.items()) {
-    const auto& val = kv.value();
-    try {
-      orders.push_back(Order::CreateOrder(
-          val["id"].get<std::string>(), val["name"].get<std::string>(),
-          FromString(val["temp"].get<std::string>()),
-          val["shelfLife"].get<int>(), val["decayRate"].get<double>(),
-          absl::Now()));
-    } catch (const std::invalid_argument& error) {
-      if (!options_.continue_after_invalid_order) {
-        throw error;
-      }
+const Clock& KitchenSimulation::IntakeClock() const {
+  if (options_.clock == ClockType::VIRTUAL) {
+    return intake_clock_;
+  }
+  return intake_->GetClock();
+}
+
+void KitchenSimulation::LogStats() const {
+  for (size_t i = 0; i < fleet_.size(); ++i) {
+    std::cout << StatsMessage(fleet_.At(i).Name(), fleet_.At(i).GetStats())
+              << std::endl;
+    std::cout << CourierStatsMessage(fleet_.At(i).Name(), *couriers_[i])
+              << std::endl;
+    if (!cooking_lines_.empty()) {
+      std::cout << CookingStatsMessage(fleet_.At(i).Name(),
+                                       *cooking_lines_[i])
+                << std::endl;
     }
   }
-  Run(orders.begin(), orders.end());
+  if (fleet_.size() > 1) {
+    std::cout << StatsMessage("ALL", fleet_.AggregateStats()) << std::endl;
+  }
+}
+
+void KitchenSimulation::RunFromJson(const std::string& json_path) {
+  auto reader = OpenOrderReader(json_path, &IntakeClock(),
+                                {options_.continue_after_invalid_order});
+  Run(reader->begin(), reader->end());
+}
+
+void KitchenSimulation::RunFromColumns(const std::string& columns_path) {
+  OrderColumnsReader reader(columns_path, &IntakeClock());
+  Run(reader.begin(), reader.end());
+}
+
+void KitchenSimulation::RunCopies(
+    const std::vector<std::unique_ptr<Order>>& orders) {
+  OrderCopier copier(orders, options_.arrive_at_receipt_time
+                                 ? nullptr
+                                 : &IntakeClock());
+  Run(copier.begin(), copier.end());
+}
+
+void KitchenSimulation::RunGenerated(const OrderGenerator::Options& workload) {
+  OrderGenerator generator(workload);
+  Run(generator.begin(), generator.end());
 }
 
-}  // namespace kitchen_sim
\ No newline at end of file
+}  // namespace kitchen_sim
@@ -1,16 +1,41 @@
 #ifndef KITCHEN_SIM_LIB_H_
 #define KITCHEN_SIM_LIB_H_
 
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <random>
+#include <string>
+#include <vector>
 
-#include "model/courier.h"
+#include "events/event_sink.h"
+#include "metrics/metrics.h"
+#include "model/cooking_line.h"
+#include "model/courier_fleet.h"
 #include "model/kitchen.h"
+#include "model/kitchen_fleet.h"
+#include "model/kitchen_intake.h"
+#include "model/kitchen_layout.h"
 #include "model/order.h"
+#include "runtime/schedule_trace.h"
+#include "runtime/scheduler.h"
+#include "runtime/sharded_executor.h"
+#include "runtime/timing_wheel.h"
+#include "workload/order_generator.h"
 
 namespace kitchen_sim {
 
+// Time source driving the simulation.
+enum class ClockType {
+  // Real time; orders arrive at |orders_per_second| as measured by the wall.
+  WALL,
+  // Discrete-event time; events run back-to-back as fast as possible.
+  VIRTUAL
+};
+
 // Simulates the intake, fulfillment, and delivery of a stream of orders for a
-// single kitchen.
+// fleet of one or more kitchens.
 class KitchenSimulation {
  public:
   struct Options {
@@ -19,63 +44,253 @@ class KitchenSimulation {
     // Predefined LARGE (default) and SMALL settings.
     std::string kitchen_size = "LARGE";
 
+    // Shelf capacities of every kitchen, overriding |kitchen_size| if set.
+    std::optional<KitchenLayout> layout;
+
     // Rate at which to process incoming orders.
     double orders_per_second = 2.;
 
+    // Whether orders instead arrive at their receipt times, offset from the
+    // first order's. Generated workloads carry their arrival process there.
+    bool arrive_at_receipt_time = false;
+
     // Whether to continue the simulation after seeing an invalid order.
     bool continue_after_invalid_order = false;
 
-    // Default number of worker threads.
+    // Most threads to run on, each with a shard of its own: kitchens, with
+    // their couriers and timers, are spread across the shards, and order
+    // intake gets one to itself if there are enough. At most one per kitchen
+    // plus one for intake are used. Unused with ClockType::VIRTUAL, which runs
+    // each kitchen on a thread of its own.
     unsigned int thread_count = std::thread::hardware_concurrency();
+    // Whether to pin each shard's thread to a CPU of its own.
+    bool pin_threads = false;
+
+    ClockType clock = ClockType::WALL;
+
+    // Seed for courier arrivals and discard decisions. A fixed seed yields the
+    // same outcome for every run over the same orders.
+    std::optional<uint32_t> seed;
+
+    // Number of identically sized kitchens sharing the order stream, and how
+    // orders are split between them.
+    unsigned int kitchen_count = 1;
+    RoutingType routing = RoutingType::ID_HASH;
+
+    // How each kitchen picks overflow orders to discard.
+    EvictionPolicyType eviction_policy = EvictionPolicyType::RANDOM;
+
+    // Couriers serving each kitchen (zero for as many as it takes), how they
+    // are matched with orders, how many orders each carries per trip, and how
+    // long each takes to deliver before it is free again.
+    size_t couriers_per_kitchen = 0;
+    DispatchType dispatch = DispatchType::MATCHED;
+    size_t courier_capacity = 1;
+    absl::Duration courier_delivery_time = absl::ZeroDuration();
+
+    // If set, orders queue for each kitchen's cooking stations and take their
+    // dishes' prep times before being shelved; otherwise cooking is instant.
+    // Its |on_cooked| and |metrics| are filled in per kitchen. Checkpoints
+    // don't cover cooking lines, so this excludes them.
+    std::optional<CookingLine::Options> cooking;
+
+    // Receives every order event; must outlive the simulation. Defaults to
+    // human-readable lines on the Boost.Log trivial logger.
+    EventSink* event_sink = nullptr;
+
+    // Minimum simulated time between each kitchen's shelf dumps to the info
+    // log. Zero dumps after every order event.
+    absl::Duration shelf_log_interval = absl::ZeroDuration();
+
+    // Receives every kitchen's and courier fleet's metrics, and how long orders
+    // took to leave each kitchen; must outlive the simulation. None are
+    // recorded if unset.
+    MetricsRegistry* metrics = nullptr;
+
+    // Whether Run() prints start/end banners and per-kitchen stats to stdout.
+    bool print_summary = true;
+
+    // If set, saves every kitchen's and courier fleet's state to
+    // |checkpoint_path| once this much simulated time has passed since the
+    // start, then carries on. Virtual clock only.
+    std::optional<absl::Duration> checkpoint_at;
+    std::string checkpoint_path;
+
+    // If set, resumes from a checkpoint saved by a simulation with the same
+    // options rather than starting afresh, and plays out exactly as that
+    // simulation did. Run() must be given the same orders; those the
+    // checkpoint's kitchens had already taken are skipped. Virtual clock only.
+    std::string restore_path;
+
+    // If set, records every handler a wall clock simulation runs, and when, to
+    // |record_path|, from which |replay_path| reproduces it exactly. Handlers
+    // run one at a time while recording, so kitchens no longer run in
+    // parallel.
+    std::string record_path;
+
+    // If set, replays the wall clock simulation recorded at this path instead,
+    // on the calling thread and as fast as possible, with its seed. Run() must
+    // be given the same orders, and these options must otherwise match the
+    // recording's.
+    std::string replay_path;
   };
 
-  KitchenSimulation(const Options options)
-      : options_(options),
-        rand_(random_device_()),
-        context_(),
-        kitchen_(CreateKitchen(options_, context_)) {}
+  KitchenSimulation(const Options options);
   KitchenSimulation(KitchenSimulation const&) = delete;
   KitchenSimulation& operator=(KitchenSimulation const&) = delete;
 
-  // Handle orders one-by-one starting from |begin|.
+  // Shelf capacities for |kitchen_size| "SMALL" or "LARGE" (anything else).
+  static KitchenLayout KitchenSizeLayout(absl::string_view kitchen_size);
+
+  // Handle orders one-by-one starting from |begin|. Instantiated for
+  // OrderReader::Iterator, OrderColumnsReader::Iterator,
+  // OrderGenerator::Iterator and std::vector<std::unique_ptr<Order>>::iterator.
+  // RunCopies() runs over an iterator private to the simulation.
   template <typename OrderIterator>
   void Run(OrderIterator begin, OrderIterator end);
 
-  // Convenient variant of the above that works off a JSON file of orders.
+  // Convenient variant of the above that streams orders from a file holding a
+  // JSON array or newline-delimited JSON objects. Orders are parsed lazily as
+  // the simulation reaches them.
   void RunFromJson(const std::string& json_path);
 
+  // Variant that maps an order columns file (see OrderColumnsWriter) and
+  // materializes each order as the simulation reaches it. Set
+  // |arrive_at_receipt_time| to follow the file's recorded arrivals.
+  void RunFromColumns(const std::string& columns_path);
+
+  // Variant that simulates copies of |orders|, each made as the simulation
+  // reaches it, and leaves |orders| untouched so that any number of
+  // simulations can share them. Copies are received as they are made unless
+  // |arrive_at_receipt_time| is set, in which case they keep their receipt
+  // times.
+  void RunCopies(const std::vector<std::unique_ptr<Order>>& orders);
+
+  // Variant that generates |workload| in memory as the simulation reaches it.
+  // Set |arrive_at_receipt_time| to follow the workload's arrival process.
+  void RunGenerated(const OrderGenerator::Options& workload);
+
+  const KitchenFleet& Fleet() const { return fleet_; }
+  // Couriers serving the |index|th kitchen of Fleet().
+  const CourierFleet& Couriers(size_t index) const {
+    return *couriers_[index];
+  }
+
  private:
-  static Kitchen CreateKitchen(const Options& options,
-                               boost::asio::io_context& context) {
-    if (options.kitchen_size == "SMALL") {
-      return Kitchen({options.kitchen_name,
-                      6,
-                      {{TemperatureType::HOT, 4},
-                       {TemperatureType::COLD, 4},
-                       {TemperatureType::FROZEN, 4}}},
-                     context);
-    }
-    return Kitchen({options.kitchen_name,
-                    15,
-                    {{TemperatureType::HOT, 10},
-                     {TemperatureType::COLD, 10},
-                     {TemperatureType::FROZEN, 10}}},
-                   context);
+  // An order routed to a kitchen, along with when it arrives there.
+  struct Arrival {
+    std::unique_ptr<Order> order;
+    absl::Time at_time;
+  };
+  using ArrivalChannel = fibers::buffered_channel<Arrival>;
+
+  // How far a kitchen has got through the orders routed to it in virtual
+  // clock mode. Only touched from the kitchen's thread once running.
+  struct KitchenProgress {
+    // Orders taken so far.
+    uint64_t arrivals = 0;
+    // Timer of the next order's arrival, if one is pending.
+    std::optional<Scheduler::TimerId> next_arrival;
+  };
+
+  static Kitchen::Options KitchenOptions(const Options& options, size_t index,
+                                         uint32_t seed);
+
+  // Shards of |executor_| that kitchen |index| and order intake are bound to.
+  size_t KitchenShard(size_t index) const {
+    return index % executor_.ShardCount();
+  }
+  size_t IntakeShard() const {
+    return options_.kitchen_count % executor_.ShardCount();
   }
 
+  template <typename OrderIterator>
+  void RunWall(OrderIterator begin, OrderIterator end,
+               absl::Duration interval);
+  template <typename OrderIterator>
+  void RunVirtual(OrderIterator begin, OrderIterator end,
+                  absl::Duration interval);
+
+  // Feeds the |index|th order onwards to kitchens in wall clock mode.
   template <typename OrderIterator>
   void Tick(OrderIterator begin, OrderIterator end, absl::Duration interval,
-            boost::asio::system_timer* timer);
+            int64_t index, absl::Time first_arrival);
+
+  // Time from the first order's arrival to that of |order|, the |index|th.
+  // Only called from the intake side.
+  absl::Duration ArrivalOffset(const Order& order, int64_t index,
+                               absl::Duration interval);
+
+  // Waits for the next order routed to kitchen |index| in virtual clock mode
+  // and schedules its arrival. If |restored| is set, the order is the one
+  // pending at the restored checkpoint, and is added there under its original
+  // timer instead.
+  void ScheduleNextArrival(size_t index, ArrivalChannel* channel,
+                           RestoredTimers* restored = nullptr);
+
+  // Kitchen |index|'s part of a checkpoint: its progress, shelves and
+  // couriers. Runs on that kitchen's thread.
+  std::string CheckpointKitchen(size_t index) const;
+
+  // Restores every kitchen, its couriers and its progress from the checkpoint
+  // read from |options_.restore_path|, advancing their schedulers to the time
+  // it was taken, which is returned. Pending timers are added to |timers|,
+  // indexed like |fleet_|.
+  absl::Time RestoreCheckpoint(std::vector<RestoredTimers>* timers);
+
+  // Drives a single order through kitchen |index| until it leaves. Defined in
+  // the .cc file.
+  class OrderLifecycle;
+
+  // Time at which orders are received, used to stamp them as they are parsed.
+  const Clock& IntakeClock() const;
+
+  void LogStats() const;
 
   const Options options_;
 
   std::random_device random_device_;
-  std::mt19937 rand_;
+  // Contents of |options_.replay_path|, if set.
+  const std::string replayed_trace_;
+  const uint32_t seed_;
+  // Contents of |options_.restore_path|, if set.
+  const std::string restored_checkpoint_;
+  // Carried over from the checkpoint when restoring, so every time in it
+  // still holds.
+  const absl::Time start_time_;
+
+  // Set when recording or replaying a wall clock simulation. Declared before
+  // the schedulers, whose pending handlers may refer to them.
+  std::unique_ptr<TraceRecorder> recorder_;
+  std::unique_ptr<TraceReplayer> replayer_;
+
+  // Runs wall clock simulations.
+  ShardedExecutor executor_;
+  // Paces order intake in wall clock mode.
+  TimingWheel intake_scheduler_;
+  // Stamps orders with their arrival time in virtual clock mode.
+  VirtualClock intake_clock_;
+  std::optional<absl::Time> first_receipt_time_;
 
-  boost::asio::io_context context_;
-  Kitchen kitchen_;
+  // Per-kitchen state, indexed like |fleet_|.
+  std::vector<std::unique_ptr<Scheduler>> schedulers_;
+  KitchenFleet fleet_;
+  // Paces order intake in wall clock mode: |intake_scheduler_|, or what
+  // records or replays it.
+  Scheduler* const intake_;
+  std::vector<std::unique_ptr<CourierFleet>> couriers_;
+  // Cooks orders for each kitchen if |options_.cooking| is set; empty
+  // otherwise.
+  std::vector<std::unique_ptr<CookingLine>> cooking_lines_;
+  // Queues orders for each kitchen in wall clock mode; empty otherwise.
+  std::vector<std::unique_ptr<KitchenIntake>> intakes_;
+  // Simulated milliseconds from receipt until orders left each kitchen,
+  // indexed by RemovalReason. Empty unless |options_.metrics| is set.
+  std::vector<std::array<Histogram*, kRemovalReasonCount>> lifetimes_;
+  // Unused in wall clock mode.
+  std::vector<KitchenProgress> progress_;
 };
 
 }  // namespace kitchen_sim
 
-#endif  // KITCHEN_SIM_LIB_H_
\ No newline at end of file
+#endif  // KITCHEN_SIM_LIB_H_
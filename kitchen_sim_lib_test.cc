@@ -0,0 +1,315 @@
+#include "kitchen_sim_lib.h"
+
+#include <map>
+#include <mutex>
+
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+namespace {
+
+// Keeps every event along with its order's ID. Thread-safe, since virtual
+// clock kitchens each run on a thread of their own.
+class RecordingEventSink : public EventSink {
+ public:
+  void Record(const Event& event, const Order& order) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.push_back({event, order.id_.ToString()});
+  }
+
+  // Each order's last event by ID, i.e. how it left the kitchen.
+  std::map<std::string, std::string> Outcomes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<std::string, std::string> outcomes;
+    for (const auto& [event, order_id] : events_) {
+      outcomes[order_id] = std::string(EventTypeName(event.type));
+    }
+    return outcomes;
+  }
+
+  // The lifecycle stages that order |order_id| went through, leaving out
+  // expiry scheduling and shelf moves.
+  std::vector<std::string> Stages(const std::string& order_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> stages;
+    for (const auto& [event, id] : events_) {
+      if (id == order_id && event.type != EventType::EXPIRY_SCHEDULED &&
+          event.type != EventType::MOVED) {
+        stages.push_back(std::string(EventTypeName(event.type)));
+      }
+    }
+    return stages;
+  }
+
+  // When the first event happened, i.e. the first order arrived.
+  absl::Time Start() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_.empty() ? absl::InfiniteFuture() : events_[0].first.at_time;
+  }
+
+  // Every event later than |since| after |origin|, timed from |origin|. Leaves
+  // out expiry scheduling, whose time is the expiry's rather than its own.
+  std::vector<std::string> Describe(absl::Time origin,
+                                    absl::Duration since) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> described;
+    for (const auto& [event, order_id] : events_) {
+      if (event.type != EventType::EXPIRY_SCHEDULED &&
+          event.at_time - origin > since) {
+        described.push_back(absl::StrCat(
+            EventTypeName(event.type), " ", order_id, " @",
+            absl::FormatDuration(event.at_time - origin), " value ",
+            event.value, event.overflow ? " (overflow)" : ""));
+      }
+    }
+    return described;
+  }
+
+  // IDs of discarded orders, in the order they were discarded.
+  std::vector<std::string> Discarded() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> discarded;
+    for (const auto& [event, order_id] : events_) {
+      if (event.type == EventType::DISCARDED) {
+        discarded.push_back(order_id);
+      }
+    }
+    return discarded;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::vector<std::pair<Event, std::string>> events_;
+};
+
+KitchenSimulation::Options TestOptions(EventSink* sink) {
+  KitchenSimulation::Options options;
+  options.kitchen_name = "test";
+  // A slot on each shelf, overflow included.
+  options.layout = KitchenLayout::Uniform(1, 1);
+  // Every order arrives well before the first courier could.
+  options.orders_per_second = 100.;
+  options.clock = ClockType::VIRTUAL;
+  options.seed = 42;
+  options.event_sink = sink;
+  options.print_summary = false;
+  return options;
+}
+
+// "1" takes the cold shelf and "2" the overflow shelf, from which "3" has it
+// discarded. "4" expires a second after cooking, before its courier arrives.
+std::vector<std::unique_ptr<Order>> TestOrders() {
+  std::vector<std::unique_ptr<Order>> orders;
+  for (const std::string id : {"1", "2", "3"}) {
+    orders.push_back(Order::CreateOrder(id, "tea", TemperatureType::COLD, 300,
+                                        0.5, absl::UnixEpoch()));
+  }
+  orders.push_back(Order::CreateOrder("4", "soup", TemperatureType::HOT, 1,
+                                      0.5, absl::UnixEpoch()));
+  return orders;
+}
+
+TEST(KitchenSimulationTest, OrdersMeetTheirOutcomes) {
+  RecordingEventSink sink;
+  KitchenSimulation simulation(TestOptions(&sink));
+  simulation.RunCopies(TestOrders());
+
+  EXPECT_THAT(sink.Outcomes(),
+              testing::ElementsAre(testing::Pair("1", "DELIVERED"),
+                                   testing::Pair("2", "DISCARDED"),
+                                   testing::Pair("3", "DELIVERED"),
+                                   testing::Pair("4", "EXPIRED")));
+  const Kitchen::Stats stats = simulation.Fleet().AggregateStats();
+  EXPECT_EQ(stats.received, 4);
+  EXPECT_EQ(stats.delivered, 2);
+  EXPECT_EQ(stats.discarded, 1);
+  EXPECT_EQ(stats.expired, 1);
+  // Every order got a courier, which found "2" and "4" gone.
+  EXPECT_EQ(simulation.Couriers(0).GetStats().trips, 4);
+  EXPECT_EQ(simulation.Couriers(0).GetStats().picked_up, 2);
+  EXPECT_EQ(simulation.Couriers(0).GetStats().missed, 2);
+}
+
+void ExpectSameStats(const Kitchen::Stats& a, const Kitchen::Stats& b) {
+  EXPECT_EQ(a.received, b.received);
+  EXPECT_EQ(a.delivered, b.delivered);
+  EXPECT_EQ(a.expired, b.expired);
+  EXPECT_EQ(a.discarded, b.discarded);
+  EXPECT_EQ(a.overflowed, b.overflowed);
+  EXPECT_EQ(a.moved_from_overflow, b.moved_from_overflow);
+  EXPECT_EQ(a.delivered_value, b.delivered_value);
+}
+
+TEST(KitchenSimulationTest, SeedFixesOutcome) {
+  OrderGenerator::Options workload;
+  workload.order_count = 500;
+  // Small shelves fed quickly, so many orders are discarded at random.
+  const auto run = [&](uint32_t seed, RecordingEventSink* sink) {
+    KitchenSimulation::Options options = TestOptions(sink);
+    options.layout = KitchenLayout::Uniform(3, 2);
+    options.orders_per_second = 20.;
+    options.seed = seed;
+    KitchenSimulation simulation(options);
+    simulation.RunGenerated(workload);
+    return simulation.Fleet().AggregateStats();
+  };
+  RecordingEventSink first_sink;
+  RecordingEventSink second_sink;
+  RecordingEventSink other_sink;
+  const Kitchen::Stats first = run(42, &first_sink);
+  const Kitchen::Stats second = run(42, &second_sink);
+  run(43, &other_sink);
+
+  ASSERT_GT(first.discarded, 10);
+  ExpectSameStats(first, second);
+  EXPECT_EQ(first_sink.Discarded(), second_sink.Discarded());
+  EXPECT_NE(first_sink.Discarded(), other_sink.Discarded());
+}
+
+void ExpectSameCourierStats(const CourierFleet::Stats& a,
+                            const CourierFleet::Stats& b) {
+  EXPECT_EQ(a.trips, b.trips);
+  EXPECT_EQ(a.picked_up, b.picked_up);
+  EXPECT_EQ(a.missed, b.missed);
+  EXPECT_EQ(a.backlogged, b.backlogged);
+  EXPECT_EQ(a.busy_time, b.busy_time);
+}
+
+TEST(KitchenSimulationTest, RestoredRunPlaysOutLikeStraightRun) {
+  OrderGenerator::Options workload;
+  workload.order_count = 200;
+  const std::string path =
+      testing::TempDir() + "/kitchen_sim_lib_test.checkpoint";
+  // Arrivals are 50ms apart, so one is pending at the checkpoint.
+  const absl::Duration checkpoint_at = absl::Milliseconds(5025);
+  const auto options = [&](RecordingEventSink* sink) {
+    KitchenSimulation::Options options = TestOptions(sink);
+    options.layout = KitchenLayout::Uniform(3, 2);
+    options.orders_per_second = 20.;
+    options.couriers_per_kitchen = 4;
+    return options;
+  };
+
+  RecordingEventSink straight_sink;
+  KitchenSimulation straight(options(&straight_sink));
+  straight.RunGenerated(workload);
+
+  RecordingEventSink checkpointed_sink;
+  KitchenSimulation::Options checkpointed_options =
+      options(&checkpointed_sink);
+  checkpointed_options.checkpoint_at = checkpoint_at;
+  checkpointed_options.checkpoint_path = path;
+  KitchenSimulation(checkpointed_options).RunGenerated(workload);
+
+  RecordingEventSink restored_sink;
+  KitchenSimulation::Options restored_options = options(&restored_sink);
+  restored_options.restore_path = path;
+  KitchenSimulation restored(restored_options);
+  restored.RunGenerated(workload);
+
+  // The restored run carries on the checkpointed run's clock.
+  const std::vector<std::string> restored_events =
+      restored_sink.Describe(checkpointed_sink.Start(), checkpoint_at);
+  ASSERT_FALSE(restored_events.empty());
+  EXPECT_EQ(restored_events,
+            straight_sink.Describe(straight_sink.Start(), checkpoint_at));
+  ExpectSameStats(restored.Fleet().AggregateStats(),
+                  straight.Fleet().AggregateStats());
+  ExpectSameCourierStats(restored.Couriers(0).GetStats(),
+                         straight.Couriers(0).GetStats());
+}
+
+TEST(KitchenSimulationTest, ReplayedRunPlaysOutLikeRecordedRun) {
+  const std::string path = testing::TempDir() + "/kitchen_sim_lib_test.trace";
+  const auto options = [&](RecordingEventSink* sink) {
+    KitchenSimulation::Options options = TestOptions(sink);
+    options.clock = ClockType::WALL;
+    return options;
+  };
+
+  RecordingEventSink recorded_sink;
+  KitchenSimulation::Options recorded_options = options(&recorded_sink);
+  recorded_options.record_path = path;
+  KitchenSimulation recorded(recorded_options);
+  recorded.RunCopies(TestOrders());
+
+  RecordingEventSink replayed_sink;
+  KitchenSimulation::Options replayed_options = options(&replayed_sink);
+  replayed_options.replay_path = path;
+  KitchenSimulation replayed(replayed_options);
+  replayed.RunCopies(TestOrders());
+
+  // Handlers run at their recorded times, not merely in their recorded order.
+  const std::vector<std::string> replayed_events = replayed_sink.Describe(
+      replayed_sink.Start(), -absl::InfiniteDuration());
+  ASSERT_FALSE(replayed_events.empty());
+  EXPECT_EQ(replayed_events, recorded_sink.Describe(recorded_sink.Start(),
+                                                    -absl::InfiniteDuration()));
+  ExpectSameStats(replayed.Fleet().AggregateStats(),
+                  recorded.Fleet().AggregateStats());
+  ExpectSameCourierStats(replayed.Couriers(0).GetStats(),
+                         recorded.Couriers(0).GetStats());
+}
+
+uint64_t LifetimeCount(MetricsRegistry* metrics, const std::string& outcome) {
+  return metrics
+      ->GetHistogram("order_lifetime_ms", "",
+                     {{"kitchen", "test"}, {"outcome", outcome}})
+      ->Snapshot()
+      .count;
+}
+
+TEST(KitchenSimulationTest, LifecycleRunsEveryStage) {
+  RecordingEventSink sink;
+  MetricsRegistry metrics;
+  KitchenSimulation::Options options = TestOptions(&sink);
+  options.metrics = &metrics;
+  KitchenSimulation simulation(options);
+  simulation.RunCopies(TestOrders());
+
+  EXPECT_THAT(sink.Stages("1"),
+              testing::ElementsAre("RECEIVED", "COOKED", "ACCEPTED",
+                                   "DELIVERED"));
+  EXPECT_THAT(sink.Stages("2"),
+              testing::ElementsAre("RECEIVED", "COOKED", "ACCEPTED",
+                                   "DISCARDED"));
+  EXPECT_THAT(sink.Stages("4"),
+              testing::ElementsAre("RECEIVED", "COOKED", "ACCEPTED",
+                                   "EXPIRED"));
+  EXPECT_EQ(LifetimeCount(&metrics, "picked_up"), 2);
+  EXPECT_EQ(LifetimeCount(&metrics, "discarded"), 1);
+  EXPECT_EQ(LifetimeCount(&metrics, "expired"), 1);
+}
+
+TEST(KitchenSimulationTest, LifecycleRunsEveryStageWithCookingLine) {
+  RecordingEventSink sink;
+  MetricsRegistry metrics;
+  KitchenSimulation::Options options = TestOptions(&sink);
+  options.metrics = &metrics;
+  CookingLine::Options cooking;
+  cooking.stations = {0, 1, 1, 1};
+  // The teas are cooked together, so "3" has "2" discarded before the line
+  // hands "2" back and a courier could be sent for it.
+  cooking.max_batch = 3;
+  options.cooking = cooking;
+  KitchenSimulation simulation(options);
+  simulation.RunCopies(TestOrders());
+
+  EXPECT_THAT(sink.Stages("1"),
+              testing::ElementsAre("RECEIVED", "COOKED", "ACCEPTED",
+                                   "DELIVERED"));
+  EXPECT_THAT(sink.Stages("2"),
+              testing::ElementsAre("RECEIVED", "COOKED", "DISCARDED"));
+  EXPECT_THAT(sink.Stages("4"),
+              testing::ElementsAre("RECEIVED", "COOKED", "ACCEPTED",
+                                   "EXPIRED"));
+  EXPECT_EQ(simulation.Couriers(0).GetStats().trips, 3);
+  EXPECT_EQ(LifetimeCount(&metrics, "picked_up"), 2);
+  EXPECT_EQ(LifetimeCount(&metrics, "discarded"), 1);
+  EXPECT_EQ(LifetimeCount(&metrics, "expired"), 1);
+}
+
+}  // namespace
+}  // namespace kitchen_sim
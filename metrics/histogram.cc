@@ -0,0 +1,99 @@
+#include "metrics/histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace kitchen_sim {
+
+size_t ThisThreadMetricShard() {
+  static std::atomic<size_t> next_shard{0};
+  thread_local const size_t shard =
+      next_shard.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+  return shard;
+}
+
+uint64_t HistogramSnapshot::Quantile(double quantile) const {
+  if (count == 0) {
+    return 0;
+  }
+  const uint64_t rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(quantile * count)));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < counts.size(); ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return std::min(Histogram::BucketUpperBound(i), max);
+    }
+  }
+  return max;
+}
+
+double HistogramSnapshot::Mean() const {
+  return count == 0 ? 0. : static_cast<double>(sum) / count;
+}
+
+HistogramSnapshot& HistogramSnapshot::operator+=(
+    const HistogramSnapshot& other) {
+  counts.resize(std::max(counts.size(), other.counts.size()));
+  for (size_t i = 0; i < other.counts.size(); ++i) {
+    counts[i] += other.counts[i];
+  }
+  count += other.count;
+  sum += other.sum;
+  max = std::max(max, other.max);
+  return *this;
+}
+
+void Histogram::Record(uint64_t value, uint64_t count) {
+  Shard& shard = shards_[ThisThreadMetricShard()];
+  shard.counts[BucketIndex(value)].fetch_add(count,
+                                             std::memory_order_relaxed);
+  shard.sum.fetch_add(value * count, std::memory_order_relaxed);
+  uint64_t max = shard.max.load(std::memory_order_relaxed);
+  while (value > max && !shard.max.compare_exchange_weak(
+                            max, value, std::memory_order_relaxed)) {
+  }
+}
+
+HistogramSnapshot Histogram::Snapshot() const {
+  HistogramSnapshot snapshot;
+  snapshot.counts.resize(kBucketCount);
+  for (const Shard& shard : shards_) {
+    for (size_t i = 0; i < kBucketCount; ++i) {
+      const uint64_t count = shard.counts[i].load(std::memory_order_relaxed);
+      snapshot.counts[i] += count;
+      snapshot.count += count;
+    }
+    snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+    snapshot.max =
+        std::max(snapshot.max, shard.max.load(std::memory_order_relaxed));
+  }
+  return snapshot;
+}
+
+size_t Histogram::BucketIndex(uint64_t value) {
+  if (value < kSubBuckets) {
+    return value;
+  }
+  const int msb = 63 - __builtin_clzll(value);
+  const int shift = msb - kSubBucketBits;
+  return ((shift + 1) << kSubBucketBits) + (value >> shift) - kSubBuckets;
+}
+
+uint64_t Histogram::BucketLowerBound(size_t index) {
+  if (index < kSubBuckets) {
+    return index;
+  }
+  const int shift = static_cast<int>(index >> kSubBucketBits) - 1;
+  return ((index & (kSubBuckets - 1)) + kSubBuckets) << shift;
+}
+
+uint64_t Histogram::BucketUpperBound(size_t index) {
+  if (index + 1 >= kBucketCount) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  return BucketLowerBound(index + 1) - 1;
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,74 @@
+#ifndef KITCHEN_SIM_METRICS_HISTOGRAM_H_
+#define KITCHEN_SIM_METRICS_HISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace kitchen_sim {
+
+// Metrics are split into this many shards, each written by the threads that
+// map to it, and merged on read. Recording then rarely contends on a cache
+// line, and never locks.
+constexpr size_t kMetricShards = 8;
+
+// Shard for metrics recorded from the calling thread.
+size_t ThisThreadMetricShard();
+
+// Point-in-time copy of a Histogram, merged across shards.
+struct HistogramSnapshot {
+  // Indexed like Histogram's buckets.
+  std::vector<uint64_t> counts;
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t max = 0;
+
+  // Smallest recorded value bound such that at least |quantile| of values are
+  // no greater, to within a bucket's width. Zero if empty.
+  uint64_t Quantile(double quantile) const;
+  double Mean() const;
+
+  HistogramSnapshot& operator+=(const HistogramSnapshot& other);
+};
+
+// Lock-free histogram of non-negative integer values, with log-linear buckets
+// in the manner of HdrHistogram: values below |kSubBuckets| are counted
+// exactly, and each power of two above is split into |kSubBuckets| equal
+// buckets, bounding relative error to 1/|kSubBuckets| across the whole 64-bit
+// range.
+class Histogram {
+ public:
+  static constexpr int kSubBucketBits = 4;
+  static constexpr uint64_t kSubBuckets = 1 << kSubBucketBits;
+  static constexpr size_t kBucketCount = (64 - kSubBucketBits + 1)
+                                         << kSubBucketBits;
+
+  Histogram() = default;
+  Histogram(Histogram const&) = delete;
+  Histogram& operator=(Histogram const&) = delete;
+
+  // Records |value| |count| times. Thread-safe.
+  void Record(uint64_t value, uint64_t count = 1);
+
+  HistogramSnapshot Snapshot() const;
+
+  static size_t BucketIndex(uint64_t value);
+  // Smallest and largest values counted by bucket |index|.
+  static uint64_t BucketLowerBound(size_t index);
+  static uint64_t BucketUpperBound(size_t index);
+
+ private:
+  struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, kBucketCount> counts{};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+  };
+
+  std::array<Shard, kMetricShards> shards_;
+};
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_METRICS_HISTOGRAM_H_
@@ -0,0 +1,66 @@
+#include "metrics/histogram.h"
+
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+
+TEST(HistogramTest, BucketsCoverEveryValue) {
+  EXPECT_EQ(Histogram::BucketIndex(0), 0);
+  EXPECT_EQ(Histogram::BucketIndex(Histogram::kSubBuckets - 1),
+            Histogram::kSubBuckets - 1);
+  EXPECT_EQ(Histogram::BucketIndex(std::numeric_limits<uint64_t>::max()),
+            Histogram::kBucketCount - 1);
+  for (size_t i = 0; i + 1 < Histogram::kBucketCount; ++i) {
+    ASSERT_EQ(Histogram::BucketUpperBound(i) + 1,
+              Histogram::BucketLowerBound(i + 1));
+    ASSERT_EQ(Histogram::BucketIndex(Histogram::BucketLowerBound(i)), i);
+    ASSERT_EQ(Histogram::BucketIndex(Histogram::BucketUpperBound(i)), i);
+  }
+}
+
+TEST(HistogramTest, QuantilesWithinBucketError) {
+  Histogram histogram;
+  for (uint64_t value = 1; value <= 10000; ++value) {
+    histogram.Record(value);
+  }
+  const HistogramSnapshot snapshot = histogram.Snapshot();
+  EXPECT_EQ(snapshot.count, 10000);
+  EXPECT_EQ(snapshot.max, 10000);
+  EXPECT_DOUBLE_EQ(snapshot.Mean(), 5000.5);
+  EXPECT_NEAR(snapshot.Quantile(0.5), 5000, 5000 / Histogram::kSubBuckets);
+  EXPECT_NEAR(snapshot.Quantile(0.99), 9900, 9900 / Histogram::kSubBuckets);
+  EXPECT_EQ(snapshot.Quantile(1.), 10000);
+  EXPECT_EQ(HistogramSnapshot().Quantile(0.5), 0);
+}
+
+TEST(HistogramTest, MergesConcurrentRecords) {
+  constexpr int kThreads = 4;
+  constexpr int kRecordsPerThread = 10000;
+  Histogram histogram;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kRecordsPerThread; ++i) {
+        histogram.Record(t + 1);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const HistogramSnapshot snapshot = histogram.Snapshot();
+  EXPECT_EQ(snapshot.count, kThreads * kRecordsPerThread);
+  EXPECT_EQ(snapshot.sum, (1 + 2 + 3 + 4) * kRecordsPerThread);
+  EXPECT_EQ(snapshot.max, 4);
+
+  HistogramSnapshot merged = snapshot;
+  merged += snapshot;
+  EXPECT_EQ(merged.count, 2 * snapshot.count);
+  EXPECT_EQ(merged.Quantile(0.5), snapshot.Quantile(0.5));
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,242 @@
+#include "metrics/metrics.h"
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_replace.h"
+#include "boost/log/trivial.hpp"
+#include "single_include/nlohmann/json.hpp"
+
+namespace kitchen_sim {
+namespace {
+
+// Quantiles exported for each histogram, as Prometheus labels them and as
+// JSON keys.
+struct ExportedQuantile {
+  double quantile;
+  absl::string_view label;
+  absl::string_view key;
+};
+constexpr ExportedQuantile kQuantiles[] = {{0.5, "0.5", "p50"},
+                                           {0.9, "0.9", "p90"},
+                                           {0.99, "0.99", "p99"},
+                                           {0.999, "0.999", "p999"}};
+
+std::string EscapeLabelValue(absl::string_view value) {
+  return absl::StrReplaceAll(value,
+                             {{"\\", "\\\\"}, {"\"", "\\\""}, {"\n", "\\n"}});
+}
+
+// {a="1",b="2"}, with |extra| appended if set, or nothing if there are no
+// labels at all.
+std::string PrometheusLabels(
+    const MetricsRegistry::Labels& labels,
+    const std::pair<absl::string_view, absl::string_view>& extra = {}) {
+  std::vector<std::string> pairs;
+  for (const auto& label : labels) {
+    pairs.push_back(
+        absl::StrCat(label.first, "=\"", EscapeLabelValue(label.second), "\""));
+  }
+  if (!extra.first.empty()) {
+    pairs.push_back(absl::StrCat(extra.first, "=\"", extra.second, "\""));
+  }
+  if (pairs.empty()) {
+    return "";
+  }
+  return absl::StrCat("{", absl::StrJoin(pairs, ","), "}");
+}
+
+// Index of each metric type in MetricsRegistry::Metric.
+constexpr size_t TypeIndex(const Counter*) { return 0; }
+constexpr size_t TypeIndex(const Gauge*) { return 1; }
+constexpr size_t TypeIndex(const Histogram*) { return 2; }
+
+// Writes |contents| to a temporary file beside |path| and renames it over
+// |path|.
+void ReplaceFile(const std::string& path, const std::string& contents) {
+  const std::string temp_path = absl::StrCat(path, ".tmp");
+  {
+    std::ofstream out(temp_path, std::ios::trunc);
+    out << contents;
+    if (!out.good()) {
+      throw std::runtime_error(
+          absl::StrCat("Could not write metrics to: ", temp_path));
+    }
+  }
+  if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    throw std::runtime_error(absl::StrCat("Could not replace: ", path));
+  }
+}
+
+}  // namespace
+
+uint64_t Counter::Value() const {
+  uint64_t value = 0;
+  for (const Shard& shard : shards_) {
+    value += shard.value.load(std::memory_order_relaxed);
+  }
+  return value;
+}
+
+template <typename T>
+T* MetricsRegistry::Get(absl::string_view name, absl::string_view help,
+                        const Labels& labels) {
+  constexpr size_t kType = TypeIndex(static_cast<T*>(nullptr));
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = families_.find(name);
+  if (it == families_.end()) {
+    it = families_.emplace(std::string(name), Family{std::string(help), kType})
+             .first;
+  } else if (it->second.type != kType) {
+    throw std::invalid_argument(
+        absl::StrCat("Metric registered with another type: ", name));
+  }
+  auto& metric = std::get<std::unique_ptr<T>>(
+      it->second.metrics.try_emplace(labels, std::unique_ptr<T>())
+          .first->second);
+  if (metric == nullptr) {
+    metric = std::make_unique<T>();
+  }
+  return metric.get();
+}
+
+Counter* MetricsRegistry::GetCounter(absl::string_view name,
+                                     absl::string_view help,
+                                     const Labels& labels) {
+  return Get<Counter>(name, help, labels);
+}
+
+Gauge* MetricsRegistry::GetGauge(absl::string_view name,
+                                 absl::string_view help,
+                                 const Labels& labels) {
+  return Get<Gauge>(name, help, labels);
+}
+
+Histogram* MetricsRegistry::GetHistogram(absl::string_view name,
+                                         absl::string_view help,
+                                         const Labels& labels) {
+  return Get<Histogram>(name, help, labels);
+}
+
+std::string MetricsRegistry::ToPrometheusText() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::string out;
+  for (const auto& family : families_) {
+    const std::string& name = family.first;
+    static constexpr absl::string_view kTypeNames[] = {"counter", "gauge",
+                                                       "summary"};
+    absl::StrAppend(&out, "# HELP ", name, " ",
+                    absl::StrReplaceAll(family.second.help,
+                                        {{"\\", "\\\\"}, {"\n", "\\n"}}),
+                    "\n# TYPE ", name, " ", kTypeNames[family.second.type],
+                    "\n");
+    for (const auto& entry : family.second.metrics) {
+      const Labels& labels = entry.first;
+      const Metric& metric = entry.second;
+      if (auto* counter = std::get_if<std::unique_ptr<Counter>>(&metric)) {
+        absl::StrAppend(&out, name, PrometheusLabels(labels), " ",
+                        (*counter)->Value(), "\n");
+      } else if (auto* gauge = std::get_if<std::unique_ptr<Gauge>>(&metric)) {
+        absl::StrAppend(&out, name, PrometheusLabels(labels), " ",
+                        (*gauge)->Value(), "\n");
+      } else {
+        const HistogramSnapshot snapshot =
+            std::get<std::unique_ptr<Histogram>>(metric)->Snapshot();
+        for (const ExportedQuantile& quantile : kQuantiles) {
+          const std::string quantile_labels =
+              PrometheusLabels(labels, {"quantile", quantile.label});
+          absl::StrAppend(&out, name, quantile_labels, " ",
+                          snapshot.Quantile(quantile.quantile), "\n");
+        }
+        absl::StrAppend(&out, name, "_sum", PrometheusLabels(labels), " ",
+                        snapshot.sum, "\n", name, "_count",
+                        PrometheusLabels(labels), " ", snapshot.count, "\n");
+      }
+    }
+  }
+  return out;
+}
+
+std::string MetricsRegistry::ToJson() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  nlohmann::json out = nlohmann::json::object();
+  for (const auto& family : families_) {
+    static constexpr const char* kTypeNames[] = {"counter", "gauge",
+                                                 "histogram"};
+    nlohmann::json values = nlohmann::json::array();
+    for (const auto& entry : family.second.metrics) {
+      nlohmann::json value = {{"labels", nlohmann::json::object()}};
+      for (const auto& label : entry.first) {
+        value["labels"][label.first] = label.second;
+      }
+      const Metric& metric = entry.second;
+      if (auto* counter = std::get_if<std::unique_ptr<Counter>>(&metric)) {
+        value["value"] = (*counter)->Value();
+      } else if (auto* gauge = std::get_if<std::unique_ptr<Gauge>>(&metric)) {
+        value["value"] = (*gauge)->Value();
+      } else {
+        const HistogramSnapshot snapshot =
+            std::get<std::unique_ptr<Histogram>>(metric)->Snapshot();
+        value["count"] = snapshot.count;
+        value["sum"] = snapshot.sum;
+        value["max"] = snapshot.max;
+        value["mean"] = snapshot.Mean();
+        for (const ExportedQuantile& quantile : kQuantiles) {
+          value[std::string(quantile.key)] =
+              snapshot.Quantile(quantile.quantile);
+        }
+      }
+      values.push_back(std::move(value));
+    }
+    out[family.first] = {{"type", kTypeNames[family.second.type]},
+                         {"help", family.second.help},
+                         {"values", std::move(values)}};
+  }
+  return out.dump();
+}
+
+MetricsDumper::MetricsDumper(const MetricsRegistry* registry, std::string path,
+                             absl::Duration interval)
+    : registry_(registry), path_(std::move(path)), interval_(interval) {
+  if (interval_ <= absl::ZeroDuration() ||
+      interval_ == absl::InfiniteDuration()) {
+    return;  // Only dumps when destroyed.
+  }
+  thread_ = std::thread([this] {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_.wait_for(lock, absl::ToChronoNanoseconds(interval_),
+                           [this] { return stopping_; })) {
+      try {
+        Dump();
+      } catch (const std::exception& e) {
+        BOOST_LOG_TRIVIAL(error) << e.what();
+      }
+    }
+  });
+}
+
+MetricsDumper::~MetricsDumper() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  stop_.notify_one();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  try {
+    Dump();
+  } catch (const std::exception& e) {
+    BOOST_LOG_TRIVIAL(error) << e.what();
+  }
+}
+
+void MetricsDumper::Dump() const {
+  ReplaceFile(absl::StrCat(path_, ".json"), registry_->ToJson());
+  ReplaceFile(absl::StrCat(path_, ".prom"), registry_->ToPrometheusText());
+}
+
+}  // namespace kitchen_sim
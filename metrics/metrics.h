@@ -0,0 +1,176 @@
+#ifndef KITCHEN_SIM_METRICS_METRICS_H_
+#define KITCHEN_SIM_METRICS_METRICS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "metrics/histogram.h"
+
+namespace kitchen_sim {
+
+// Monotonic count, sharded like Histogram so that threads rarely share the
+// cache line they increment.
+class Counter {
+ public:
+  Counter() = default;
+  Counter(Counter const&) = delete;
+  Counter& operator=(Counter const&) = delete;
+
+  // Thread-safe and lock-free.
+  void Increment(uint64_t count = 1) {
+    shards_[ThisThreadMetricShard()].value.fetch_add(
+        count, std::memory_order_relaxed);
+  }
+
+  uint64_t Value() const;
+
+ private:
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> value{0};
+  };
+
+  std::array<Shard, kMetricShards> shards_;
+};
+
+// Current level of something, e.g. shelf occupancy.
+class Gauge {
+ public:
+  Gauge() = default;
+  Gauge(Gauge const&) = delete;
+  Gauge& operator=(Gauge const&) = delete;
+
+  // Thread-safe and lock-free.
+  void Set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+  void Add(int64_t delta) {
+    value_.fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  int64_t Value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_{0};
+};
+
+// Records the wall time in nanoseconds from construction to destruction into a
+// histogram, divided evenly among |count| operations. Does nothing, not even
+// read the clock, if the histogram is null.
+class ScopedLatency {
+ public:
+  explicit ScopedLatency(Histogram* histogram, uint64_t count = 1)
+      : histogram_(histogram), count_(count) {
+    if (histogram_ != nullptr) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+  ~ScopedLatency() {
+    if (histogram_ == nullptr || count_ == 0) {
+      return;
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start_);
+    histogram_->Record(elapsed.count() / count_, count_);
+  }
+  ScopedLatency(ScopedLatency const&) = delete;
+  ScopedLatency& operator=(ScopedLatency const&) = delete;
+
+ private:
+  Histogram* const histogram_;
+  const uint64_t count_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+// Named, labelled metrics, exported as JSON or in the Prometheus text format.
+// Registering a metric takes a lock, but the returned metric lives as long as
+// the registry and recording to it never does, so callers register once up
+// front and keep the pointer.
+class MetricsRegistry {
+ public:
+  // Label names and values, in the order exported.
+  using Labels = std::vector<std::pair<std::string, std::string>>;
+
+  MetricsRegistry() = default;
+  MetricsRegistry(MetricsRegistry const&) = delete;
+  MetricsRegistry& operator=(MetricsRegistry const&) = delete;
+
+  // Return the metric named |name| with |labels|, registering it on first use.
+  // |help| describes every metric of that name. Thread-safe. Throw
+  // std::invalid_argument if |name| is already registered as another type.
+  Counter* GetCounter(absl::string_view name, absl::string_view help,
+                      const Labels& labels = {});
+  Gauge* GetGauge(absl::string_view name, absl::string_view help,
+                  const Labels& labels = {});
+  Histogram* GetHistogram(absl::string_view name, absl::string_view help,
+                          const Labels& labels = {});
+
+  // Prometheus text exposition format. Histograms are exported as summaries
+  // with 0.5, 0.9, 0.99 and 0.999 quantiles, since their buckets are far
+  // finer than Prometheus histograms are meant to carry.
+  std::string ToPrometheusText() const;
+
+  // A JSON object keyed by metric name, each with its type, help and one entry
+  // per label set.
+  std::string ToJson() const;
+
+ private:
+  using Metric = std::variant<std::unique_ptr<Counter>, std::unique_ptr<Gauge>,
+                              std::unique_ptr<Histogram>>;
+
+  struct Family {
+    std::string help;
+    // Index of the Metric alternative.
+    size_t type;
+    std::map<Labels, Metric> metrics;
+  };
+
+  template <typename T>
+  T* Get(absl::string_view name, absl::string_view help,
+         const Labels& labels);
+
+  mutable std::mutex mutex_;
+  std::map<std::string, Family, std::less<>> families_;
+};
+
+// Writes a registry's metrics to |path| with ".json" and ".prom" appended, so
+// they can be watched while a run is in progress. Files are replaced whole, so
+// readers never see a partial dump.
+class MetricsDumper {
+ public:
+  // Dumps every |interval| of wall time from a background thread, and once
+  // more when destroyed. A zero or infinite |interval| only dumps when
+  // destroyed. |registry| must outlive the dumper.
+  MetricsDumper(const MetricsRegistry* registry, std::string path,
+                absl::Duration interval);
+  ~MetricsDumper();
+  MetricsDumper(MetricsDumper const&) = delete;
+  MetricsDumper& operator=(MetricsDumper const&) = delete;
+
+  // Throws std::runtime_error if either file can't be written.
+  void Dump() const;
+
+ private:
+  const MetricsRegistry* const registry_;
+  const std::string path_;
+  const absl::Duration interval_;
+
+  std::mutex mutex_;
+  std::condition_variable stop_;
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_METRICS_METRICS_H_
@@ -0,0 +1,104 @@
+#include "metrics/metrics.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "single_include/nlohmann/json.hpp"
+
+namespace kitchen_sim {
+
+using ::testing::HasSubstr;
+
+TEST(MetricsRegistryTest, ReturnsSameMetricForSameLabels) {
+  MetricsRegistry registry;
+  Counter* counter = registry.GetCounter("orders_total", "Orders.",
+                                         {{"kitchen", "a"}});
+  EXPECT_EQ(registry.GetCounter("orders_total", "Orders.", {{"kitchen", "a"}}),
+            counter);
+  EXPECT_NE(registry.GetCounter("orders_total", "Orders.", {{"kitchen", "b"}}),
+            counter);
+  EXPECT_THROW(registry.GetGauge("orders_total", "Orders."),
+               std::invalid_argument);
+}
+
+TEST(MetricsRegistryTest, CountsAcrossThreads) {
+  MetricsRegistry registry;
+  Counter* counter = registry.GetCounter("orders_total", "Orders.");
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([counter] {
+      for (int i = 0; i < 1000; ++i) {
+        counter->Increment();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(counter->Value(), 4000);
+}
+
+TEST(MetricsRegistryTest, ExportsPrometheusText) {
+  MetricsRegistry registry;
+  registry.GetCounter("orders_total", "Orders.", {{"kitchen", "a\"b"}})
+      ->Increment(3);
+  registry.GetGauge("overflow_orders", "Overflow.")->Set(-2);
+  Histogram* latency = registry.GetHistogram("latency_us", "Latency.");
+  latency->Record(10);
+  latency->Record(20);
+
+  const std::string text = registry.ToPrometheusText();
+  EXPECT_THAT(text, HasSubstr("# TYPE orders_total counter\n"));
+  EXPECT_THAT(text, HasSubstr("orders_total{kitchen=\"a\\\"b\"} 3\n"));
+  EXPECT_THAT(text, HasSubstr("overflow_orders -2\n"));
+  EXPECT_THAT(text, HasSubstr("# TYPE latency_us summary\n"));
+  EXPECT_THAT(text, HasSubstr("latency_us{quantile=\"0.99\"} 20\n"));
+  EXPECT_THAT(text, HasSubstr("latency_us_sum 30\nlatency_us_count 2\n"));
+}
+
+TEST(MetricsRegistryTest, ExportsJson) {
+  MetricsRegistry registry;
+  registry.GetCounter("orders_total", "Orders.", {{"kitchen", "a"}})
+      ->Increment();
+  registry.GetHistogram("latency_us", "Latency.")->Record(7);
+
+  const auto json = nlohmann::json::parse(registry.ToJson());
+  EXPECT_EQ(json["orders_total"]["type"], "counter");
+  EXPECT_EQ(json["orders_total"]["values"][0]["labels"]["kitchen"], "a");
+  EXPECT_EQ(json["orders_total"]["values"][0]["value"], 1);
+  EXPECT_EQ(json["latency_us"]["values"][0]["count"], 1);
+  EXPECT_EQ(json["latency_us"]["values"][0]["p50"], 7);
+}
+
+TEST(ScopedLatencyTest, RecordsPerOperation) {
+  Histogram histogram;
+  { ScopedLatency latency(&histogram, 4); }
+  { ScopedLatency latency(nullptr); }
+  EXPECT_EQ(histogram.Snapshot().count, 4);
+}
+
+TEST(MetricsDumperTest, DumpsWhenDestroyed) {
+  const std::string path = testing::TempDir() + "/metrics_dumper_test";
+  MetricsRegistry registry;
+  {
+    MetricsDumper dumper(&registry, path, absl::InfiniteDuration());
+    registry.GetCounter("orders_total", "Orders.")->Increment(5);
+  }
+  std::ifstream prom(path + ".prom");
+  std::stringstream contents;
+  contents << prom.rdbuf();
+  EXPECT_THAT(contents.str(), HasSubstr("orders_total 5\n"));
+  std::ifstream json(path + ".json");
+  EXPECT_EQ(nlohmann::json::parse(json)["orders_total"]["values"][0]["value"],
+            5);
+  std::remove((path + ".prom").c_str());
+  std::remove((path + ".json").c_str());
+}
+
+}  // namespace kitchen_sim
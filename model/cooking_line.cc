@@ -0,0 +1,234 @@
+#include "model/cooking_line.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+
+namespace kitchen_sim {
+namespace {
+
+constexpr TemperatureType kCookedTemperatures[] = {
+    TemperatureType::FROZEN, TemperatureType::COLD, TemperatureType::HOT};
+
+}  // namespace
+
+double CookingLine::Stats::MeanWaitSeconds() const {
+  return orders == 0 ? 0.
+                     : absl::ToDoubleSeconds(total_wait) /
+                           static_cast<double>(orders);
+}
+
+double CookingLine::Stats::OrdersPerBatch() const {
+  return batches == 0 ? 0. : static_cast<double>(orders) / batches;
+}
+
+double CookingLine::Stats::Utilization() const {
+  const absl::Duration elapsed = last_done - first_start;
+  if (stations == 0 || elapsed <= absl::ZeroDuration()) {
+    return 0.;
+  }
+  return absl::FDivDuration(busy_time, elapsed * stations);
+}
+
+CookingLine::Metrics::Metrics(MetricsRegistry* registry,
+                              const std::string& kitchen) {
+  for (TemperatureType temp : kCookedTemperatures) {
+    const MetricsRegistry::Labels labels = {
+        {"kitchen", kitchen}, {"temperature", PrintTemperatureType(temp)}};
+    queue_depth[static_cast<int>(temp)] = registry->GetGauge(
+        "cooking_queue_depth", "Orders waiting for a cooking station.",
+        labels);
+    busy_stations[static_cast<int>(temp)] = registry->GetGauge(
+        "cooking_stations_busy", "Cooking stations in use.", labels);
+  }
+  const MetricsRegistry::Labels labels = {{"kitchen", kitchen}};
+  wait_ms = registry->GetHistogram(
+      "cooking_wait_ms",
+      "Simulated milliseconds orders waited for a cooking station.", labels);
+  orders_per_batch = registry->GetHistogram(
+      "cooking_batch_size", "Orders cooked per batch.", labels);
+}
+
+CookingLine::CookingLine(const Options& options, Kitchen* kitchen)
+    : options_(options),
+      kitchen_(kitchen),
+      metrics_(options_.metrics != nullptr
+                   ? std::make_unique<Metrics>(options_.metrics,
+                                               kitchen_->Name())
+                   : nullptr) {
+  if (options_.max_batch == 0) {
+    throw std::invalid_argument("Stations must cook at least one order!");
+  }
+  if (options_.default_prep_time < absl::ZeroDuration()) {
+    throw std::invalid_argument("Prep times can't be negative!");
+  }
+  for (const auto& [dish, prep_time] : options_.prep_times) {
+    if (prep_time < absl::ZeroDuration()) {
+      throw std::invalid_argument(
+          absl::StrCat("Prep time can't be negative for dish: ", dish));
+    }
+  }
+  for (int i = 0; i < kTemperatureCount; ++i) {
+    const auto temp = static_cast<TemperatureType>(i);
+    const int stations = options_.stations[i];
+    const bool has_shelf = temp != TemperatureType::UNKNOWN &&
+                           kitchen_->Layout().HasShelf(temp);
+    if (has_shelf ? stations <= 0 : stations != 0) {
+      throw std::invalid_argument(absl::StrCat(
+          "Invalid cooking station count for ", PrintTemperatureType(temp),
+          " in kitchen: ", kitchen_->Name()));
+    }
+    groups_[i].stats.stations = stations;
+  }
+}
+
+void CookingLine::Cook(std::unique_ptr<Order> order) {
+  CheckStation(*order);
+  Enqueue(std::move(order));
+}
+
+void CookingLine::Cook(absl::Span<std::unique_ptr<Order>> orders) {
+  for (const auto& order : orders) {
+    CheckStation(*order);
+  }
+  for (auto& order : orders) {
+    Enqueue(std::move(order));
+  }
+}
+
+void CookingLine::CheckStation(const Order& order) const {
+  if (groups_[static_cast<int>(order.temp_)].stats.stations == 0) {
+    throw std::invalid_argument(
+        absl::StrCat("Could not find station for kitchen: ", kitchen_->Name(),
+                     " order: ", order.id_.ToString()));
+  }
+}
+
+void CookingLine::Enqueue(std::unique_ptr<Order> order) {
+  const TemperatureType temp = order->temp_;
+  Group& group = groups_[static_cast<int>(temp)];
+  const absl::Time now = kitchen_->GetScheduler().Now();
+  const absl::string_view dish = order->name_;
+  const uint64_t seq = group.next_seq++;
+  group.by_dish[dish].push_back({std::move(order), now, seq});
+  group.arrivals.emplace_back(seq, dish);
+  ++group.depth;
+  ++group.stats.orders;
+  StartBatches(temp, now);
+  group.stats.peak_queue_depth =
+      std::max(group.stats.peak_queue_depth, group.depth);
+}
+
+absl::Duration CookingLine::PrepTime(absl::string_view dish) const {
+  const auto it = options_.prep_times.find(dish);
+  return it != options_.prep_times.end() ? it->second
+                                         : options_.default_prep_time;
+}
+
+void CookingLine::StartBatches(TemperatureType temp, absl::Time now) {
+  Group& group = groups_[static_cast<int>(temp)];
+  while (group.busy < group.stats.stations && group.depth > 0) {
+    const auto [seq, dish] = group.arrivals.front();
+    group.arrivals.pop_front();
+    std::deque<Waiting>& waiting = group.by_dish[dish];
+    if (waiting.empty() || waiting.front().seq != seq) {
+      // Already batched with an older order of its dish.
+      continue;
+    }
+    std::vector<std::unique_ptr<Order>> batch;
+    while (!waiting.empty() && batch.size() < options_.max_batch) {
+      const absl::Duration wait = now - waiting.front().since;
+      group.stats.total_wait += wait;
+      if (metrics_ != nullptr) {
+        metrics_->wait_ms->Record(absl::ToInt64Milliseconds(wait));
+      }
+      batch.push_back(std::move(waiting.front().order));
+      waiting.pop_front();
+    }
+    group.depth -= batch.size();
+    ++group.busy;
+    ++group.stats.batches;
+    group.stats.first_start = std::min(group.stats.first_start, now);
+    if (metrics_ != nullptr) {
+      metrics_->orders_per_batch->Record(batch.size());
+    }
+    kitchen_->GetScheduler().ScheduleAt(
+        now + PrepTime(dish),
+        [this, temp, now, batch = std::move(batch)]() mutable {
+          FinishBatch(temp, now, std::move(batch));
+        });
+  }
+  if (group.depth == 0) {
+    // Only stale entries are left.
+    group.arrivals.clear();
+  }
+  if (metrics_ != nullptr) {
+    metrics_->queue_depth[static_cast<int>(temp)]->Set(group.depth);
+    metrics_->busy_stations[static_cast<int>(temp)]->Set(group.busy);
+  }
+}
+
+void CookingLine::FinishBatch(TemperatureType temp, absl::Time started,
+                              std::vector<std::unique_ptr<Order>> batch) {
+  const absl::Time now = kitchen_->GetScheduler().Now();
+  Group& group = groups_[static_cast<int>(temp)];
+  --group.busy;
+  group.stats.busy_time += now - started;
+  group.stats.last_done = std::max(group.stats.last_done, now);
+
+  const std::vector<Order*> shelved =
+      kitchen_->TakeOrders(absl::MakeSpan(batch), now);
+  if (options_.on_cooked) {
+    for (Order* order : shelved) {
+      if (order != nullptr) {
+        options_.on_cooked(order);
+      }
+    }
+  }
+  StartBatches(temp, now);
+}
+
+absl::flat_hash_map<std::string, absl::Duration> ParsePrepTimes(
+    absl::string_view spec) {
+  absl::flat_hash_map<std::string, absl::Duration> prep_times;
+  for (absl::string_view entry : absl::StrSplit(spec, ',', absl::SkipEmpty())) {
+    const std::pair<absl::string_view, absl::string_view> parts =
+        absl::StrSplit(entry, absl::MaxSplits('=', 1));
+    const absl::string_view dish = absl::StripAsciiWhitespace(parts.first);
+    double seconds;
+    if (dish.empty() ||
+        !absl::SimpleAtod(absl::StripAsciiWhitespace(parts.second),
+                          &seconds) ||
+        !(seconds >= 0.)) {
+      throw std::invalid_argument(
+          absl::StrCat("Invalid prep time: ", entry));
+    }
+    prep_times[dish] = absl::Seconds(seconds);
+  }
+  return prep_times;
+}
+
+std::string CookingStatsMessage(absl::string_view name,
+                                const CookingLine& line) {
+  std::string message = absl::StrCat("[ cooking: ", name);
+  for (TemperatureType temp : kCookedTemperatures) {
+    const CookingLine::Stats& stats = line.GetStats(temp);
+    if (stats.stations == 0) {
+      continue;
+    }
+    absl::StrAppend(&message, " | ", PrintTemperatureType(temp),
+                    ": stations=", stats.stations, " orders=", stats.orders,
+                    " orders_per_batch=", stats.OrdersPerBatch(),
+                    " mean_wait_s=", stats.MeanWaitSeconds(),
+                    " peak_queue=", stats.peak_queue_depth,
+                    " utilization=", stats.Utilization());
+  }
+  absl::StrAppend(&message, " ]");
+  return message;
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,177 @@
+#ifndef KITCHEN_SIM_COOKING_LINE_H_
+#define KITCHEN_SIM_COOKING_LINE_H_
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "metrics/metrics.h"
+#include "model/kitchen.h"
+#include "model/kitchen_layout.h"
+#include "model/order.h"
+
+namespace kitchen_sim {
+
+// Cooking stage in front of a kitchen's shelves. Each temperature group has a
+// number of stations, each cooking one batch at a time: up to |max_batch|
+// waiting orders of the same dish, which take that dish's prep time together.
+// Orders wait for a station of their group first come, first served; a free
+// station takes the oldest waiting order, along with the next ones of the same
+// dish. Finished batches are shelved with Kitchen::TakeOrders(), cooked as of
+// then.
+//
+// Runs entirely on the kitchen's scheduler, like the kitchen itself.
+class CookingLine {
+ public:
+  struct Options {
+    // Stations per temperature group, indexed by TemperatureType. Every group
+    // the kitchen has a shelf for needs at least one, and no other may have
+    // any.
+    std::array<int, kTemperatureCount> stations = {};
+    // Prep time of each dish, by name. Dishes not listed take
+    // |default_prep_time|.
+    absl::flat_hash_map<std::string, absl::Duration> prep_times;
+    absl::Duration default_prep_time = absl::Seconds(1);
+    // Most orders of the same dish a station cooks at once.
+    size_t max_batch = 1;
+    // Called on the kitchen's scheduler with each order once it is shelved,
+    // unless a later order in the same batch had it discarded.
+    std::function<void(Order*)> on_cooked;
+    // Receives the line's metrics, labelled with its kitchen's name; must
+    // outlive the line. None are recorded if unset.
+    MetricsRegistry* metrics = nullptr;
+  };
+
+  // Running totals for one temperature group.
+  struct Stats {
+    int stations = 0;
+    // Orders taken in, and batches started.
+    uint64_t orders = 0;
+    uint64_t batches = 0;
+    // Most orders waiting for a station at once.
+    size_t peak_queue_depth = 0;
+    // Time orders spent waiting for a station, summed.
+    absl::Duration total_wait = absl::ZeroDuration();
+    // Station time spent on finished batches, and the span from the first
+    // batch starting to the last finishing.
+    absl::Duration busy_time = absl::ZeroDuration();
+    absl::Time first_start = absl::InfiniteFuture();
+    absl::Time last_done = absl::InfinitePast();
+
+    double MeanWaitSeconds() const;
+    double OrdersPerBatch() const;
+    // Share of the group's station time spent cooking, from the first batch
+    // starting to the last finishing.
+    double Utilization() const;
+  };
+
+  // |kitchen| must outlive the line.
+  // Throws std::invalid_argument if |options| doesn't fit the kitchen.
+  CookingLine(const Options& options, Kitchen* kitchen);
+  CookingLine(CookingLine const&) = delete;
+  CookingLine& operator=(CookingLine const&) = delete;
+
+  // Queues |order| for a station of its temperature group, starting on it
+  // straight away if one is free. Runs on the kitchen's scheduler.
+  // Throws std::invalid_argument if the group has no stations.
+  void Cook(std::unique_ptr<Order> order);
+
+  // Queues every order in |orders|, in order, as if by Cook().
+  // Throws std::invalid_argument, queueing none of them, if any order's group
+  // has no stations.
+  void Cook(absl::Span<std::unique_ptr<Order>> orders);
+
+  // Orders of |temp| waiting for a station, and stations of |temp| cooking.
+  size_t QueueDepth(TemperatureType temp) const {
+    return groups_[static_cast<int>(temp)].depth;
+  }
+  int BusyStations(TemperatureType temp) const {
+    return groups_[static_cast<int>(temp)].busy;
+  }
+
+  // Like the kitchen's, only safe to read from its scheduler or once idle.
+  const Stats& GetStats(TemperatureType temp) const {
+    return groups_[static_cast<int>(temp)].stats;
+  }
+
+ private:
+  struct Waiting {
+    std::unique_ptr<Order> order;
+    absl::Time since;
+    // Position in the group's arrival order.
+    uint64_t seq;
+  };
+
+  struct Group {
+    int busy = 0;
+    size_t depth = 0;
+    uint64_t next_seq = 0;
+    // Waiting orders by dish, oldest first. Dish names are interned, so the
+    // keys stay valid.
+    absl::flat_hash_map<absl::string_view, std::deque<Waiting>> by_dish;
+    // Every waiting order's dish and sequence number in arrival order, so the
+    // oldest is found without scanning. Orders batched ahead of their turn
+    // along with an older one of their dish leave stale entries behind, which
+    // are skipped once they reach the front.
+    std::deque<std::pair<uint64_t, absl::string_view>> arrivals;
+    Stats stats;
+  };
+
+  // Throws std::invalid_argument if |order|'s group has no stations.
+  void CheckStation(const Order& order) const;
+
+  // Queues |order|, whose group has stations, and starts any batches it can.
+  void Enqueue(std::unique_ptr<Order> order);
+
+  absl::Duration PrepTime(absl::string_view dish) const;
+
+  // Starts batches on |temp|'s free stations while orders wait.
+  void StartBatches(TemperatureType temp, absl::Time now);
+
+  // Fired by the scheduler once |batch| of |temp|, started at |started|, is
+  // done.
+  void FinishBatch(TemperatureType temp, absl::Time started,
+                   std::vector<std::unique_ptr<Order>> batch);
+
+  // The line's metrics in |options_.metrics|.
+  struct Metrics {
+    Metrics(MetricsRegistry* registry, const std::string& kitchen);
+
+    // Indexed by TemperatureType; null for UNKNOWN.
+    std::array<Gauge*, kTemperatureCount> queue_depth = {};
+    std::array<Gauge*, kTemperatureCount> busy_stations = {};
+    // Simulated milliseconds from arrival until cooking started.
+    Histogram* wait_ms;
+    Histogram* orders_per_batch;
+  };
+
+  const Options options_;
+  Kitchen* const kitchen_;
+  // Null unless |options_.metrics| is set.
+  std::unique_ptr<Metrics> metrics_;
+  // Indexed by TemperatureType.
+  std::array<Group, kTemperatureCount> groups_;
+};
+
+// Parses prep times given as "dish=seconds,dish=seconds,...", e.g.
+// "Pizza=8,Ramen=4.5". Throws std::invalid_argument if malformed.
+absl::flat_hash_map<std::string, absl::Duration> ParsePrepTimes(
+    absl::string_view spec);
+
+// One-line summary of a cooking line's stats, per temperature group with
+// stations, for reports.
+std::string CookingStatsMessage(absl::string_view name,
+                                const CookingLine& line);
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_COOKING_LINE_H_
@@ -0,0 +1,147 @@
+#include "model/cooking_line.h"
+
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "runtime/scheduler.h"
+
+namespace kitchen_sim {
+namespace {
+
+std::unique_ptr<Order> MakeOrder(const std::string& id,
+                                 const std::string& dish,
+                                 TemperatureType temp = TemperatureType::HOT) {
+  return Order::CreateOrder(id, dish, temp, 300, 0.5, absl::UnixEpoch());
+}
+
+// Options for one station per temperature group, with every dish taking
+// |prep_s| seconds.
+CookingLine::Options OneStationEach(int prep_s) {
+  CookingLine::Options options;
+  options.stations = {0, 1, 1, 1};
+  options.default_prep_time = absl::Seconds(prep_s);
+  return options;
+}
+
+absl::Time At(int seconds) {
+  return absl::UnixEpoch() + absl::Seconds(seconds);
+}
+
+TEST(CookingLineTest, ShelvesOrdersOncePrepared) {
+  VirtualScheduler scheduler;
+  Kitchen kitchen({"test"}, &scheduler);
+  CookingLine::Options options = OneStationEach(3);
+  std::vector<Order*> cooked;
+  options.on_cooked = [&](Order* order) { cooked.push_back(order); };
+  CookingLine line(options, &kitchen);
+  line.Cook(MakeOrder("1", "ramen"));
+  EXPECT_EQ(line.BusyStations(TemperatureType::HOT), 1);
+  EXPECT_EQ(kitchen.FindOrder(OrderId("1")), nullptr);
+
+  scheduler.RunUntil(At(2));
+  EXPECT_TRUE(cooked.empty());
+  scheduler.RunUntil(At(3));
+  ASSERT_EQ(cooked.size(), 1);
+  EXPECT_EQ(cooked[0], kitchen.FindOrder(OrderId("1")));
+  EXPECT_EQ(line.BusyStations(TemperatureType::HOT), 0);
+}
+
+TEST(CookingLineTest, OrdersQueueForBusyStation) {
+  VirtualScheduler scheduler;
+  Kitchen kitchen({"test"}, &scheduler);
+  CookingLine line(OneStationEach(2), &kitchen);
+  for (const char* id : {"1", "2", "3"}) {
+    line.Cook(MakeOrder(id, "ramen"));
+  }
+  // Other groups have stations of their own.
+  line.Cook(MakeOrder("4", "salad", TemperatureType::COLD));
+  EXPECT_EQ(line.QueueDepth(TemperatureType::HOT), 2);
+  EXPECT_EQ(line.QueueDepth(TemperatureType::COLD), 0);
+
+  scheduler.RunUntil(At(2));
+  EXPECT_NE(kitchen.FindOrder(OrderId("1")), nullptr);
+  EXPECT_NE(kitchen.FindOrder(OrderId("4")), nullptr);
+  EXPECT_EQ(kitchen.FindOrder(OrderId("2")), nullptr);
+  EXPECT_EQ(line.QueueDepth(TemperatureType::HOT), 1);
+
+  scheduler.RunUntil(At(10));
+  EXPECT_NE(kitchen.FindOrder(OrderId("3")), nullptr);
+  const CookingLine::Stats& stats = line.GetStats(TemperatureType::HOT);
+  EXPECT_EQ(stats.orders, 3);
+  EXPECT_EQ(stats.batches, 3);
+  EXPECT_EQ(stats.peak_queue_depth, 2);
+  // Waited 0, 2 and 4 seconds.
+  EXPECT_DOUBLE_EQ(stats.MeanWaitSeconds(), 2.);
+  EXPECT_EQ(stats.busy_time, absl::Seconds(6));
+  EXPECT_DOUBLE_EQ(stats.Utilization(), 1.);
+}
+
+TEST(CookingLineTest, BatchesSameDishInArrivalOrder) {
+  VirtualScheduler scheduler;
+  Kitchen kitchen({"test"}, &scheduler);
+  CookingLine::Options options = OneStationEach(2);
+  options.max_batch = 2;
+  options.prep_times["pizza"] = absl::Seconds(5);
+  std::vector<std::string> cooked;
+  options.on_cooked = [&](Order* order) {
+    cooked.push_back(order->id_.ToString());
+  };
+  CookingLine line(options, &kitchen);
+  line.Cook(MakeOrder("1", "ramen"));
+  line.Cook(MakeOrder("2", "pizza"));
+  line.Cook(MakeOrder("3", "ramen"));
+  line.Cook(MakeOrder("4", "ramen"));
+  line.Cook(MakeOrder("5", "pizza"));
+
+  // Ramen 1 alone, then the oldest waiting, pizza 2, along with pizza 5, then
+  // ramen 3 and 4 together.
+  scheduler.RunUntil(At(20));
+  EXPECT_EQ(cooked, std::vector<std::string>({"1", "2", "5", "3", "4"}));
+  const CookingLine::Stats& stats = line.GetStats(TemperatureType::HOT);
+  EXPECT_EQ(stats.batches, 3);
+  EXPECT_DOUBLE_EQ(stats.OrdersPerBatch(), 5. / 3);
+  EXPECT_EQ(stats.last_done, At(9));
+}
+
+TEST(CookingLineTest, RejectsStationsNotMatchingShelves) {
+  VirtualScheduler scheduler;
+  Kitchen kitchen({"test"}, &scheduler);
+  CookingLine::Options options = OneStationEach(1);
+  options.stations[static_cast<int>(TemperatureType::COLD)] = 0;
+  EXPECT_THROW(CookingLine(options, &kitchen), std::invalid_argument);
+  options.stations[static_cast<int>(TemperatureType::COLD)] = 1;
+  options.stations[static_cast<int>(TemperatureType::UNKNOWN)] = 1;
+  EXPECT_THROW(CookingLine(options, &kitchen), std::invalid_argument);
+
+  KitchenLayout layout = kLargeKitchenLayout;
+  layout.SetShelfCapacity(TemperatureType::FROZEN, KitchenLayout::kNoShelf);
+  Kitchen hot_and_cold({"test", layout}, &scheduler);
+  options = OneStationEach(1);
+  options.stations[static_cast<int>(TemperatureType::FROZEN)] = 0;
+  CookingLine line(options, &hot_and_cold);
+  EXPECT_THROW(line.Cook(MakeOrder("1", "ice", TemperatureType::FROZEN)),
+               std::invalid_argument);
+
+  // Batches are queued whole or not at all.
+  std::vector<std::unique_ptr<Order>> batch;
+  batch.push_back(MakeOrder("2", "ramen"));
+  batch.push_back(MakeOrder("3", "ice", TemperatureType::FROZEN));
+  EXPECT_THROW(line.Cook(absl::MakeSpan(batch)), std::invalid_argument);
+  EXPECT_NE(batch[0], nullptr);
+  EXPECT_EQ(line.GetStats(TemperatureType::HOT).orders, 0);
+}
+
+TEST(CookingLineTest, ParsesPrepTimes) {
+  const auto prep_times = ParsePrepTimes("Pizza=8, Ramen = 4.5");
+  ASSERT_EQ(prep_times.size(), 2);
+  EXPECT_EQ(prep_times.at("Pizza"), absl::Seconds(8));
+  EXPECT_EQ(prep_times.at("Ramen"), absl::Milliseconds(4500));
+  EXPECT_TRUE(ParsePrepTimes("").empty());
+  EXPECT_THROW(ParsePrepTimes("Pizza"), std::invalid_argument);
+  EXPECT_THROW(ParsePrepTimes("Pizza=-1"), std::invalid_argument);
+  EXPECT_THROW(ParsePrepTimes("=3"), std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace kitchen_sim
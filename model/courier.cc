@@ -1,31 +1,61 @@
 #include "model/courier.h"
 
+#include <stdexcept>
+
 namespace kitchen_sim {
+namespace {
+
+// Presently delivers immediately.
+std::unique_ptr<Order> Pickup(const Courier::OrderInfo& order_info,
+                              absl::Time at_time) {
+  auto order = order_info.kitchen->PickupOrder(order_info.order_id, at_time);
+  if (order != nullptr) {
+    order->SetDeliveryTime(at_time);
+  }
+  return order;
+}
+
+}  // namespace
+
+Courier::Courier(size_t capacity) : capacity_(capacity) {
+  if (capacity_ == 0) {
+    throw std::invalid_argument("Couriers must carry at least one order!");
+  }
+  orders_.reserve(capacity_);
+}
 
 bool Courier::AcceptOrder(const OrderInfo& order_info) {
-  current_order_.emplace(order_info);
+  if (IsFull()) {
+    return false;
+  }
+  orders_.push_back(order_info);
   return true;
 }
 
-fibers::future<std::unique_ptr<Order>> Courier::PickupCurrentOrder(
+Eventual<std::unique_ptr<Order>> Courier::PickupCurrentOrder(
     absl::Time at_time) {
-  fibers::promise<std::unique_ptr<Order>> delivered_order;
-  if (!current_order_.has_value()) {
+  if (orders_.empty()) {
     throw std::invalid_argument(
         "Cannot pickup when no order has been accepted!");
   }
-  // Presently delivers immediately.
-  auto order = current_order_.value().kitchen->PickupOrder(
-      current_order_.value().order_id, at_time);
-  current_order_.reset();
+  auto order = Pickup(orders_.front(), at_time);
+  orders_.erase(orders_.begin());
+  return std::move(order);
+}
 
-  if (order != nullptr) {
-    order->SetDeliveryTime(at_time);
-    delivered_order.set_value(std::move(order));
-  } else {
-    delivered_order.set_value(nullptr);
+size_t Courier::PickupOrders(absl::Time at_time,
+                             std::vector<std::unique_ptr<Order>>* delivered) {
+  size_t missed = 0;
+  for (const OrderInfo& order_info : orders_) {
+    auto order = Pickup(order_info, at_time);
+    if (order != nullptr) {
+      delivered->push_back(std::move(order));
+    } else {
+      ++missed;
+    }
   }
-  return delivered_order.get_future();
+  orders_.clear();
+  return missed;
 }
 
 }  // namespace kitchen_sim
@@ -1,39 +1,58 @@
 #ifndef KITCHEN_SIM_COURIER_H_
 #define KITCHEN_SIM_COURIER_H_
 
-#include <optional>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "base.h"
 #include "model/kitchen.h"
 #include "model/order.h"
+#include "model/order_id.h"
+#include "runtime/eventual.h"
 
 namespace kitchen_sim {
 
-// Represents a single food delivery courier.
+// Represents a single food delivery courier, who carries up to |capacity|
+// orders per trip. Couriers are reusable: picking up clears the accepted
+// orders, readying the courier for its next trip.
 class Courier {
  public:
   struct OrderInfo {
-    const std::string order_id;
+    OrderId order_id;
     Kitchen* kitchen;
   };
 
-  Courier() = default;
+  explicit Courier(size_t capacity = 1);
   Courier(Courier const&) = delete;
   Courier& operator=(Courier const&) = delete;
 
-  // Always returns true at the moment.
+  // Returns false, accepting nothing, if already carrying |capacity| orders.
   bool AcceptOrder(const OrderInfo& order_info);
 
-  // Returns a future (along with ownership) to a delivered order.
+  // Returns the earliest accepted order, along with ownership, once picked up
+  // (which is presently always on return).
   // May return nullptr if an order was discarded or expired.
-  fibers::future<std::unique_ptr<Order>> PickupCurrentOrder(
+  Eventual<std::unique_ptr<Order>> PickupCurrentOrder(
       absl::Time at_time = absl::Now());
 
+  // Picks up every accepted order, appending those still held by their
+  // kitchens to |delivered|. Returns how many were not, having been discarded
+  // or expired.
+  size_t PickupOrders(absl::Time at_time,
+                      std::vector<std::unique_ptr<Order>>* delivered);
+
+  // Accepted orders not yet picked up, in order of acceptance.
+  const std::vector<OrderInfo>& Orders() const { return orders_; }
+  size_t OrderCount() const { return orders_.size(); }
+  bool IsFull() const { return orders_.size() >= capacity_; }
+
  private:
-  std::optional<OrderInfo> current_order_;
+  const size_t capacity_;
+  // In order of acceptance.
+  std::vector<OrderInfo> orders_;
 };
 
 }  // namespace kitchen_sim
@@ -0,0 +1,356 @@
+#include "model/courier_fleet.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+#include "absl/strings/str_cat.h"
+
+namespace kitchen_sim {
+
+DispatchType ParseDispatchType(absl::string_view name) {
+  for (DispatchType type : {DispatchType::MATCHED, DispatchType::FIFO}) {
+    if (name == DispatchName(type)) {
+      return type;
+    }
+  }
+  throw std::invalid_argument(absl::StrCat("Unknown dispatch type: ", name));
+}
+
+absl::string_view DispatchName(DispatchType type) {
+  switch (type) {
+    case DispatchType::MATCHED:
+      return "matched";
+    case DispatchType::FIFO:
+      return "fifo";
+  }
+  return "unknown";
+}
+
+double CourierFleet::Stats::OrdersPerTrip() const {
+  return trips == 0 ? 0. : static_cast<double>(picked_up) / trips;
+}
+
+CourierFleet::Metrics::Metrics(MetricsRegistry* registry,
+                               const std::string& kitchen) {
+  const MetricsRegistry::Labels labels = {{"kitchen", kitchen}};
+  trips = registry->GetCounter("courier_trips_total",
+                               "Courier trips to the kitchen.", labels);
+  picked_up = registry->GetCounter("courier_picked_up_total",
+                                   "Orders picked up by couriers.", labels);
+  missed = registry->GetCounter(
+      "courier_missed_total",
+      "Orders gone from the kitchen before a courier could pick them up.",
+      labels);
+  backlogged = registry->GetCounter(
+      "courier_backlogged_total",
+      "Orders that found no courier free when cooked.", labels);
+  busy = registry->GetGauge("courier_busy", "Couriers out.", labels);
+  orders_per_trip = registry->GetHistogram(
+      "courier_orders_per_trip", "Orders picked up per trip.", labels);
+  arrive_ns = registry->GetHistogram(
+      "courier_arrive_ns", "Wall nanoseconds to handle a courier's arrival.",
+      labels);
+}
+
+CourierFleet::CourierFleet(const Options& options, Kitchen* kitchen)
+    : options_(options),
+      kitchen_(kitchen),
+      metrics_(options_.metrics != nullptr
+                   ? std::make_unique<Metrics>(options_.metrics,
+                                               kitchen_->Name())
+                   : nullptr),
+      rand_(options_.seed.has_value() ? options_.seed.value()
+                                      : std::random_device{}()) {
+  if (options_.max_batch == 0) {
+    throw std::invalid_argument("Couriers must carry at least one order!");
+  }
+  if (options_.min_travel_s < 0 ||
+      options_.max_travel_s < options_.min_travel_s) {
+    throw std::invalid_argument("Invalid courier travel time range!");
+  }
+  couriers_.reserve(options_.courier_count);
+  idle_.reserve(options_.courier_count);
+  delivered_.reserve(options_.max_batch);
+}
+
+void CourierFleet::Dispatch(Order* order) {
+  const absl::Time now = kitchen_->GetScheduler().Now();
+  kitchen_->RecordEvent(EventType::ACCEPTED, *order, now);
+
+  if (options_.dispatch == DispatchType::FIFO) {
+    waiting_.push_back(order->id_);
+    // Couriers already on their way can carry this order too.
+    if (waiting_.size() <= en_route_ * options_.max_batch) {
+      return;
+    }
+    Slot* slot = TakeIdleCourier();
+    if (slot == nullptr) {
+      ++stats_.backlogged;
+      if (metrics_ != nullptr) {
+        metrics_->backlogged->Increment();
+      }
+      return;
+    }
+    ++en_route_;
+    kitchen_->ExpectPickup(order, SetOff(slot, now));
+    return;
+  }
+
+  if (boarding_ != nullptr && !boarding_->courier.IsFull()) {
+    boarding_->courier.AcceptOrder({order->id_, kitchen_});
+    kitchen_->ExpectPickup(order, boarding_->arrival);
+    return;
+  }
+  Slot* slot = TakeIdleCourier();
+  if (slot == nullptr) {
+    waiting_.push_back(order->id_);
+    ++stats_.backlogged;
+    if (metrics_ != nullptr) {
+      metrics_->backlogged->Increment();
+    }
+    return;
+  }
+  slot->courier.AcceptOrder({order->id_, kitchen_});
+  kitchen_->ExpectPickup(order, SetOff(slot, now));
+  boarding_ = slot;
+}
+
+double CourierFleet::Utilization() const {
+  const size_t couriers = options_.courier_count > 0 ? options_.courier_count
+                                                     : stats_.peak_busy;
+  const absl::Duration elapsed = stats_.last_free - stats_.first_set_off;
+  if (couriers == 0 || elapsed <= absl::ZeroDuration()) {
+    return 0.;
+  }
+  return absl::FDivDuration(stats_.busy_time,
+                            elapsed * static_cast<int64_t>(couriers));
+}
+
+CourierFleet::Slot* CourierFleet::TakeIdleCourier() {
+  if (!idle_.empty()) {
+    Slot* slot = idle_.back();
+    idle_.pop_back();
+    return slot;
+  }
+  if (options_.courier_count > 0 &&
+      couriers_.size() >= options_.courier_count) {
+    return nullptr;
+  }
+  couriers_.push_back(
+      std::make_unique<Slot>(couriers_.size(), options_.max_batch));
+  return couriers_.back().get();
+}
+
+void CourierFleet::LoadWaiting(Slot* slot) {
+  while (!slot->courier.IsFull() && !waiting_.empty()) {
+    const OrderId order_id = waiting_.front();
+    waiting_.pop_front();
+    if (kitchen_->FindOrder(order_id) == nullptr) {
+      ++stats_.missed;
+      if (metrics_ != nullptr) {
+        metrics_->missed->Increment();
+      }
+      continue;
+    }
+    slot->courier.AcceptOrder({order_id, kitchen_});
+  }
+}
+
+absl::Time CourierFleet::SetOff(Slot* slot, absl::Time now) {
+  std::uniform_int_distribution<int> travel_s(options_.min_travel_s,
+                                              options_.max_travel_s);
+  slot->set_off = now;
+  stats_.first_set_off = std::min(stats_.first_set_off, now);
+  slot->arrival = now + absl::Seconds(travel_s(rand_));
+  slot->delivering = false;
+  ++stats_.trips;
+  stats_.peak_busy = std::max(stats_.peak_busy, BusyCount());
+  if (metrics_ != nullptr) {
+    metrics_->trips->Increment();
+    metrics_->busy->Set(BusyCount());
+  }
+  slot->timer = kitchen_->GetScheduler().ScheduleAt(
+      slot->arrival, [this, slot] { Arrive(slot); });
+  return slot->arrival;
+}
+
+void CourierFleet::Arrive(Slot* slot) {
+  ScopedLatency latency(metrics_ != nullptr ? metrics_->arrive_ns : nullptr);
+  Scheduler& scheduler = kitchen_->GetScheduler();
+  const absl::Time now = scheduler.Now();
+  if (options_.dispatch == DispatchType::FIFO) {
+    --en_route_;
+    LoadWaiting(slot);
+  } else if (boarding_ == slot) {
+    boarding_ = nullptr;
+  }
+  const size_t missed = slot->courier.PickupOrders(now, &delivered_);
+  stats_.missed += missed;
+  stats_.picked_up += delivered_.size();
+  if (metrics_ != nullptr) {
+    metrics_->missed->Increment(missed);
+    metrics_->picked_up->Increment(delivered_.size());
+    metrics_->orders_per_trip->Record(delivered_.size());
+  }
+  delivered_.clear();
+
+  if (options_.delivery_time <= absl::ZeroDuration()) {
+    Release(slot);
+  } else {
+    slot->delivering = true;
+    slot->timer = scheduler.ScheduleAt(now + options_.delivery_time,
+                                       [this, slot] { Release(slot); });
+  }
+}
+
+void CourierFleet::Release(Slot* slot) {
+  const absl::Time now = kitchen_->GetScheduler().Now();
+  stats_.busy_time += now - slot->set_off;
+  stats_.last_free = now;
+  idle_.push_back(slot);
+  if (metrics_ != nullptr) {
+    metrics_->busy->Set(BusyCount());
+  }
+
+  while (!waiting_.empty()) {
+    if (options_.dispatch == DispatchType::FIFO &&
+        waiting_.size() <= en_route_ * options_.max_batch) {
+      return;
+    }
+    Slot* next = TakeIdleCourier();
+    if (next == nullptr) {
+      return;
+    }
+    if (options_.dispatch == DispatchType::FIFO) {
+      ++en_route_;
+      SetOff(next, now);
+      continue;
+    }
+    LoadWaiting(next);
+    if (next->courier.OrderCount() == 0) {
+      // Everything left waiting had already expired or been discarded.
+      idle_.push_back(next);
+      return;
+    }
+    const absl::Time arrival = SetOff(next, now);
+    boarding_ = next;
+    for (const Courier::OrderInfo& order_info : next->courier.Orders()) {
+      kitchen_->ExpectPickup(kitchen_->FindOrder(order_info.order_id),
+                             arrival);
+    }
+  }
+}
+
+void CourierFleet::Checkpoint(BinaryWriter* writer) const {
+  writer->Write(stats_);
+  std::ostringstream rand_state;
+  rand_state << rand_;
+  writer->WriteString(rand_state.str());
+  writer->Write<uint64_t>(en_route_);
+  writer->Write<uint32_t>(waiting_.size());
+  for (const OrderId& order_id : waiting_) {
+    writer->WriteString(order_id.ToString());
+  }
+  writer->Write<uint32_t>(couriers_.size());
+  for (const auto& slot : couriers_) {
+    writer->WriteTime(slot->set_off);
+    writer->WriteTime(slot->arrival);
+    writer->Write<uint64_t>(slot->timer);
+    writer->Write<bool>(slot->delivering);
+    writer->Write<uint32_t>(slot->courier.OrderCount());
+    for (const Courier::OrderInfo& order_info : slot->courier.Orders()) {
+      writer->WriteString(order_info.order_id.ToString());
+    }
+  }
+  writer->Write<uint32_t>(idle_.size());
+  for (const Slot* slot : idle_) {
+    writer->Write<uint32_t>(slot->index);
+  }
+  writer->Write<int64_t>(
+      boarding_ != nullptr ? static_cast<int64_t>(boarding_->index) : -1);
+}
+
+void CourierFleet::Restore(BinaryReader* reader, RestoredTimers* timers) {
+  if (!couriers_.empty()) {
+    throw std::invalid_argument(
+        "Cannot restore into a fleet that has hired couriers!");
+  }
+  stats_ = reader->Read<Stats>();
+  std::istringstream rand_state{std::string(reader->ReadString())};
+  rand_state >> rand_;
+  en_route_ = reader->Read<uint64_t>();
+  const uint32_t waiting = reader->Read<uint32_t>();
+  for (uint32_t i = 0; i < waiting; ++i) {
+    waiting_.emplace_back(reader->ReadString());
+  }
+  const uint32_t courier_count = reader->Read<uint32_t>();
+  if (options_.courier_count > 0 && courier_count > options_.courier_count) {
+    throw std::invalid_argument("Checkpointed couriers do not fit the fleet!");
+  }
+  couriers_.reserve(courier_count);
+  for (uint32_t i = 0; i < courier_count; ++i) {
+    couriers_.push_back(std::make_unique<Slot>(i, options_.max_batch));
+    Slot* slot = couriers_.back().get();
+    slot->set_off = reader->ReadTime();
+    slot->arrival = reader->ReadTime();
+    slot->timer = reader->Read<uint64_t>();
+    slot->delivering = reader->Read<bool>();
+    const uint32_t order_count = reader->Read<uint32_t>();
+    for (uint32_t j = 0; j < order_count; ++j) {
+      if (!slot->courier.AcceptOrder(
+              {OrderId(reader->ReadString()), kitchen_})) {
+        throw std::invalid_argument(
+            "Checkpointed courier carries too many orders!");
+      }
+    }
+  }
+  std::vector<bool> idle(courier_count);
+  const uint32_t idle_count = reader->Read<uint32_t>();
+  for (uint32_t i = 0; i < idle_count; ++i) {
+    const uint32_t index = reader->Read<uint32_t>();
+    if (index >= courier_count || idle[index]) {
+      throw std::invalid_argument("Checkpointed idle couriers are invalid!");
+    }
+    idle[index] = true;
+    idle_.push_back(couriers_[index].get());
+  }
+  const int64_t boarding = reader->Read<int64_t>();
+  if (boarding >= static_cast<int64_t>(courier_count)) {
+    throw std::invalid_argument("Checkpointed boarding courier is invalid!");
+  }
+  boarding_ = boarding >= 0 ? couriers_[boarding].get() : nullptr;
+
+  // Every courier not idle is either on its way or out delivering.
+  for (const auto& owned : couriers_) {
+    Slot* slot = owned.get();
+    if (idle[slot->index]) {
+      continue;
+    }
+    if (slot->delivering) {
+      timers->Add(slot->timer, slot->arrival + options_.delivery_time,
+                  [this, slot] { Release(slot); }, &slot->timer);
+    } else {
+      timers->Add(slot->timer, slot->arrival, [this, slot] { Arrive(slot); },
+                  &slot->timer);
+    }
+  }
+  if (metrics_ != nullptr) {
+    metrics_->busy->Set(BusyCount());
+  }
+}
+
+std::string CourierStatsMessage(absl::string_view name,
+                                const CourierFleet& fleet) {
+  const CourierFleet::Stats& stats = fleet.GetStats();
+  return absl::StrCat("[ couriers: ", name, " | hired: ", fleet.Size(),
+                      " | trips: ", stats.trips,
+                      " | picked_up: ", stats.picked_up,
+                      " | orders_per_trip: ", stats.OrdersPerTrip(),
+                      " | missed: ", stats.missed,
+                      " | backlogged: ", stats.backlogged,
+                      " | peak_busy: ", stats.peak_busy,
+                      " | utilization: ", fleet.Utilization(), " ]");
+}
+
+}  // namespace kitchen_sim
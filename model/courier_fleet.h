@@ -0,0 +1,190 @@
+#ifndef KITCHEN_SIM_COURIER_FLEET_H_
+#define KITCHEN_SIM_COURIER_FLEET_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "metrics/metrics.h"
+#include "model/courier.h"
+#include "model/kitchen.h"
+#include "model/order.h"
+#include "model/order_id.h"
+#include "runtime/binary_io.h"
+#include "runtime/scheduler.h"
+
+namespace kitchen_sim {
+
+// How couriers are matched with cooked orders.
+enum class DispatchType {
+  // A courier is bound to specific orders when sent, and picks up only those.
+  MATCHED,
+  // Couriers are sent as orders are cooked, but each takes whichever orders
+  // have waited longest once it arrives.
+  FIFO
+};
+
+// Parses "matched" or "fifo". Throws std::invalid_argument otherwise.
+DispatchType ParseDispatchType(absl::string_view name);
+absl::string_view DispatchName(DispatchType type);
+
+// A pool of reusable couriers collecting orders from one kitchen. Couriers are
+// hired as needed up to the fleet size and reused from then on, so the fleet
+// allocates nothing per order once warm. When every courier is out, cooked
+// orders wait for one to come free.
+//
+// Runs entirely on the kitchen's scheduler, like the kitchen itself.
+class CourierFleet {
+ public:
+  struct Options {
+    // Zero hires another courier whenever none is free, so orders never wait.
+    size_t courier_count = 0;
+    DispatchType dispatch = DispatchType::MATCHED;
+    // Most orders a courier picks up per trip.
+    size_t max_batch = 1;
+    // Couriers reach the kitchen a uniformly random whole number of seconds,
+    // between these bounds, after setting off.
+    int min_travel_s = 2;
+    int max_travel_s = 6;
+    // Time from pickup until the courier is free for another trip.
+    absl::Duration delivery_time = absl::ZeroDuration();
+    // Seed for travel times. Drawn from std::random_device if unset.
+    std::optional<uint32_t> seed;
+    // Receives the fleet's metrics, labelled with its kitchen's name; must
+    // outlive the fleet. None are recorded if unset.
+    MetricsRegistry* metrics = nullptr;
+  };
+
+  struct Stats {
+    // Courier trips to the kitchen, and orders delivered by them.
+    uint64_t trips = 0;
+    uint64_t picked_up = 0;
+    // Orders expired or discarded before a courier could pick them up.
+    uint64_t missed = 0;
+    // Orders that found no courier free when cooked.
+    uint64_t backlogged = 0;
+    // Most couriers out at once.
+    size_t peak_busy = 0;
+    // Time couriers spent out, from setting off until free again, and the
+    // span from the first courier setting off to the last coming free.
+    absl::Duration busy_time = absl::ZeroDuration();
+    absl::Time first_set_off = absl::InfiniteFuture();
+    absl::Time last_free = absl::InfinitePast();
+
+    double OrdersPerTrip() const;
+  };
+
+  // |kitchen| must outlive the fleet.
+  CourierFleet(const Options& options, Kitchen* kitchen);
+  CourierFleet(CourierFleet const&) = delete;
+  CourierFleet& operator=(CourierFleet const&) = delete;
+
+  // Has a courier collect |order|, just shelved by the kitchen. Runs on the
+  // kitchen's scheduler.
+  void Dispatch(Order* order);
+
+  // Share of the fleet's time that couriers spent out, from the first setting
+  // off to the last coming free. An unbounded fleet counts as the most
+  // couriers ever out at once.
+  double Utilization() const;
+
+  // Couriers hired so far, and of those, how many are out.
+  size_t Size() const { return couriers_.size(); }
+  size_t BusyCount() const { return couriers_.size() - idle_.size(); }
+
+  // Like the kitchen's, only safe to read from its scheduler or once idle.
+  const Stats& GetStats() const { return stats_; }
+
+  // Appends every courier, with the orders it carries and its pending
+  // arrival or release, to |writer|, along with the orders waiting for one
+  // and the fleet's stats. Like Kitchen::Checkpoint(), only meaningful on a
+  // VirtualScheduler that isn't running.
+  void Checkpoint(BinaryWriter* writer) const;
+
+  // Reads back what Checkpoint() wrote into this fleet, which must not have
+  // hired any couriers yet, once its kitchen is restored. The couriers'
+  // pending arrivals and releases are added to |timers|.
+  // Throws std::invalid_argument if the checkpoint is malformed or doesn't
+  // fit the fleet's options.
+  void Restore(BinaryReader* reader, RestoredTimers* timers);
+
+ private:
+  struct Slot {
+    // |index| is the courier's position in |couriers_|.
+    Slot(uint32_t index, size_t capacity) : index(index), courier(capacity) {}
+
+    const uint32_t index;
+    Courier courier;
+    absl::Time set_off;
+    absl::Time arrival;
+    // While out, the pending arrival at the kitchen, or once there, the
+    // pending release.
+    Scheduler::TimerId timer = 0;
+    bool delivering = false;
+  };
+
+  // Returns a free courier, hiring one if the fleet has room, or nullptr.
+  Slot* TakeIdleCourier();
+
+  // Loads |slot| with waiting orders still held by the kitchen, up to its
+  // capacity.
+  void LoadWaiting(Slot* slot);
+
+  // Sends |slot| to the kitchen. Returns when it will arrive.
+  absl::Time SetOff(Slot* slot, absl::Time now);
+
+  // Fired by the scheduler once |slot| reaches the kitchen.
+  void Arrive(Slot* slot);
+
+  // Returns |slot| to the pool and puts free couriers to work on any waiting
+  // orders.
+  void Release(Slot* slot);
+
+  // The fleet's metrics in |options_.metrics|.
+  struct Metrics {
+    Metrics(MetricsRegistry* registry, const std::string& kitchen);
+
+    Counter* trips;
+    Counter* picked_up;
+    Counter* missed;
+    Counter* backlogged;
+    Gauge* busy;
+    Histogram* orders_per_trip;
+    // Wall time spent handling each courier's arrival.
+    Histogram* arrive_ns;
+  };
+
+  const Options options_;
+  Kitchen* const kitchen_;
+  // Null unless |options_.metrics| is set.
+  std::unique_ptr<Metrics> metrics_;
+  std::mt19937 rand_;
+
+  std::vector<std::unique_ptr<Slot>> couriers_;
+  std::vector<Slot*> idle_;
+  // MATCHED: the courier sent out last, which later orders board until it is
+  // full or arrives.
+  Slot* boarding_ = nullptr;
+  // Cooked orders not yet on a courier, oldest first. They may have left the
+  // kitchen since.
+  std::deque<OrderId> waiting_;
+  // FIFO: couriers on their way, each to take up to |max_batch| of |waiting_|.
+  size_t en_route_ = 0;
+  // Scratch space for pickups, reused across trips.
+  std::vector<std::unique_ptr<Order>> delivered_;
+  Stats stats_;
+};
+
+// One-line summary of a courier fleet's stats for reports.
+std::string CourierStatsMessage(absl::string_view name,
+                                const CourierFleet& fleet);
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_COURIER_FLEET_H_
@@ -0,0 +1,242 @@
+#include "model/courier_fleet.h"
+
+#include <stdexcept>
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+#include "runtime/scheduler.h"
+
+namespace kitchen_sim {
+
+// Shelves order |id| in |kitchen| now.
+Order* Cook(Kitchen* kitchen, const std::string& id) {
+  return WaitAndGet(kitchen->TakeOrder(
+      Order::CreateOrder(id, "ramen", TemperatureType::HOT, 300, 0.5,
+                         absl::UnixEpoch()),
+      kitchen->GetScheduler().Now()));
+}
+
+// Options for a fleet whose couriers always take |travel_s| to arrive.
+CourierFleet::Options FixedTravel(int travel_s) {
+  CourierFleet::Options options;
+  options.min_travel_s = travel_s;
+  options.max_travel_s = travel_s;
+  options.seed = 1;
+  return options;
+}
+
+TEST(CourierFleetTest, UnboundedFleetSendsCourierPerOrder) {
+  VirtualScheduler scheduler;
+  Kitchen kitchen({"test"}, &scheduler);
+  CourierFleet fleet(FixedTravel(2), &kitchen);
+  for (const char* id : {"1", "2", "3"}) {
+    fleet.Dispatch(Cook(&kitchen, id));
+  }
+  EXPECT_EQ(fleet.BusyCount(), 3);
+
+  scheduler.RunUntil(absl::UnixEpoch() + absl::Seconds(2));
+  EXPECT_EQ(kitchen.GetStats().delivered, 3);
+  EXPECT_EQ(fleet.GetStats().trips, 3);
+  EXPECT_EQ(fleet.GetStats().backlogged, 0);
+  EXPECT_EQ(fleet.BusyCount(), 0);
+  // Three couriers out for the whole span.
+  EXPECT_DOUBLE_EQ(fleet.Utilization(), 1.);
+
+  // Couriers are reused rather than hired again.
+  fleet.Dispatch(Cook(&kitchen, "4"));
+  scheduler.RunUntil(absl::UnixEpoch() + absl::Seconds(4));
+  EXPECT_EQ(fleet.Size(), 3);
+  EXPECT_EQ(fleet.GetStats().picked_up, 4);
+}
+
+TEST(CourierFleetTest, OrdersWaitForFreeCourier) {
+  VirtualScheduler scheduler;
+  Kitchen kitchen({"test"}, &scheduler);
+  CourierFleet::Options options = FixedTravel(2);
+  options.courier_count = 1;
+  options.delivery_time = absl::Seconds(3);
+  CourierFleet fleet(options, &kitchen);
+  fleet.Dispatch(Cook(&kitchen, "1"));
+  fleet.Dispatch(Cook(&kitchen, "2"));
+  EXPECT_EQ(fleet.GetStats().backlogged, 1);
+
+  scheduler.RunUntil(absl::UnixEpoch() + absl::Seconds(4));
+  EXPECT_EQ(kitchen.GetStats().delivered, 1);
+  // Free again at 5s, once the first order is delivered, then 2s back.
+  scheduler.RunUntil(absl::UnixEpoch() + absl::Seconds(7));
+  EXPECT_EQ(kitchen.GetStats().delivered, 2);
+  EXPECT_EQ(fleet.Size(), 1);
+
+  scheduler.RunUntil(absl::UnixEpoch() + absl::Seconds(20));
+  EXPECT_EQ(fleet.GetStats().busy_time, absl::Seconds(10));
+  EXPECT_DOUBLE_EQ(fleet.Utilization(), 1.);
+}
+
+TEST(CourierFleetTest, MatchedCouriersCarryBatches) {
+  VirtualScheduler scheduler;
+  Kitchen kitchen({"test"}, &scheduler);
+  CourierFleet::Options options = FixedTravel(2);
+  options.courier_count = 1;
+  options.max_batch = 2;
+  CourierFleet fleet(options, &kitchen);
+  for (const char* id : {"1", "2", "3"}) {
+    fleet.Dispatch(Cook(&kitchen, id));
+  }
+
+  scheduler.RunUntil(absl::UnixEpoch() + absl::Seconds(2));
+  EXPECT_EQ(kitchen.GetStats().delivered, 2);
+  scheduler.RunUntil(absl::UnixEpoch() + absl::Seconds(4));
+  EXPECT_EQ(kitchen.GetStats().delivered, 3);
+  EXPECT_EQ(fleet.GetStats().trips, 2);
+  EXPECT_DOUBLE_EQ(fleet.GetStats().OrdersPerTrip(), 1.5);
+}
+
+TEST(CourierFleetTest, MetricsRecorded) {
+  VirtualScheduler scheduler;
+  MetricsRegistry metrics;
+  Kitchen kitchen({"test"}, &scheduler);
+  CourierFleet::Options options = FixedTravel(2);
+  options.courier_count = 1;
+  options.max_batch = 2;
+  options.metrics = &metrics;
+  CourierFleet fleet(options, &kitchen);
+  for (const char* id : {"1", "2", "3"}) {
+    fleet.Dispatch(Cook(&kitchen, id));
+  }
+  scheduler.RunUntil(absl::UnixEpoch() + absl::Seconds(1));
+  const MetricsRegistry::Labels labels = {{"kitchen", "test"}};
+  EXPECT_EQ(metrics.GetGauge("courier_busy", "", labels)->Value(), 1);
+  EXPECT_EQ(metrics.GetCounter("courier_backlogged_total", "", labels)->Value(),
+            1);
+
+  scheduler.RunUntil(absl::UnixEpoch() + absl::Seconds(4));
+  EXPECT_EQ(metrics.GetGauge("courier_busy", "", labels)->Value(), 0);
+  EXPECT_EQ(metrics.GetCounter("courier_trips_total", "", labels)->Value(), 2);
+  EXPECT_EQ(metrics.GetCounter("courier_picked_up_total", "", labels)->Value(),
+            3);
+  const HistogramSnapshot orders_per_trip =
+      metrics.GetHistogram("courier_orders_per_trip", "", labels)->Snapshot();
+  EXPECT_EQ(orders_per_trip.count, 2);
+  EXPECT_EQ(orders_per_trip.max, 2);
+  EXPECT_EQ(
+      metrics.GetHistogram("courier_arrive_ns", "", labels)->Snapshot().count,
+      2);
+}
+
+TEST(CourierFleetTest, MatchedCourierMissesItsOrder) {
+  VirtualScheduler scheduler;
+  Kitchen kitchen({"test"}, &scheduler);
+  CourierFleet fleet(FixedTravel(2), &kitchen);
+  fleet.Dispatch(Cook(&kitchen, "1"));
+  fleet.Dispatch(Cook(&kitchen, "2"));
+  kitchen.PickupOrder("1", scheduler.Now());
+
+  scheduler.RunUntil(absl::UnixEpoch() + absl::Seconds(2));
+  EXPECT_EQ(fleet.GetStats().missed, 1);
+  EXPECT_EQ(fleet.GetStats().picked_up, 1);
+}
+
+TEST(CourierFleetTest, FifoCourierTakesOldestReadyOrder) {
+  VirtualScheduler scheduler;
+  Kitchen kitchen({"test"}, &scheduler);
+  CourierFleet::Options options = FixedTravel(2);
+  options.dispatch = DispatchType::FIFO;
+  CourierFleet fleet(options, &kitchen);
+  fleet.Dispatch(Cook(&kitchen, "1"));
+  fleet.Dispatch(Cook(&kitchen, "2"));
+  kitchen.PickupOrder("1", scheduler.Now());
+
+  // The first courier skips the order already gone and takes the next; the
+  // second finds nothing left.
+  scheduler.RunUntil(absl::UnixEpoch() + absl::Seconds(2));
+  EXPECT_EQ(fleet.GetStats().trips, 2);
+  EXPECT_EQ(fleet.GetStats().picked_up, 1);
+  EXPECT_EQ(fleet.GetStats().missed, 1);
+  EXPECT_EQ(kitchen.FindOrder(OrderId("2")), nullptr);
+}
+
+TEST(CourierFleetTest, FifoSendsOnlyCouriersNeeded) {
+  VirtualScheduler scheduler;
+  Kitchen kitchen({"test"}, &scheduler);
+  CourierFleet::Options options = FixedTravel(2);
+  options.dispatch = DispatchType::FIFO;
+  options.max_batch = 3;
+  CourierFleet fleet(options, &kitchen);
+  for (const char* id : {"1", "2", "3", "4"}) {
+    fleet.Dispatch(Cook(&kitchen, id));
+  }
+  EXPECT_EQ(fleet.GetStats().trips, 2);
+
+  scheduler.RunUntil(absl::UnixEpoch() + absl::Seconds(2));
+  EXPECT_EQ(kitchen.GetStats().delivered, 4);
+}
+
+// Cooks and dispatches an order each second in [from, to).
+void DispatchEverySecond(Kitchen* kitchen, CourierFleet* fleet,
+                         VirtualScheduler* scheduler, int from, int to) {
+  for (int second = from; second < to; ++second) {
+    scheduler->RunUntil(absl::UnixEpoch() + absl::Seconds(second));
+    fleet->Dispatch(Cook(kitchen, absl::StrCat(second)));
+  }
+}
+
+TEST(CourierFleetTest, RestoresCheckpoint) {
+  for (DispatchType dispatch : {DispatchType::MATCHED, DispatchType::FIFO}) {
+    SCOPED_TRACE(DispatchName(dispatch));
+    CourierFleet::Options options;
+    options.dispatch = dispatch;
+    options.courier_count = 2;
+    options.max_batch = 2;
+    options.delivery_time = absl::Seconds(3);
+    options.seed = 5;
+    NullEventSink sink;
+    Kitchen::Options kitchen_options = {"test"};
+    kitchen_options.event_sink = &sink;
+    kitchen_options.shelf_log_interval = absl::InfiniteDuration();
+    VirtualScheduler scheduler;
+    Kitchen kitchen(kitchen_options, &scheduler);
+    CourierFleet fleet(options, &kitchen);
+    DispatchEverySecond(&kitchen, &fleet, &scheduler, 0, 8);
+    std::string checkpoint;
+    BinaryWriter writer(&checkpoint);
+    kitchen.Checkpoint(&writer);
+    fleet.Checkpoint(&writer);
+    DispatchEverySecond(&kitchen, &fleet, &scheduler, 8, 20);
+    scheduler.Run();
+
+    VirtualScheduler restored_scheduler;
+    restored_scheduler.RunUntil(absl::UnixEpoch() + absl::Seconds(7));
+    Kitchen restored_kitchen(kitchen_options, &restored_scheduler);
+    CourierFleet restored(options, &restored_kitchen);
+    RestoredTimers timers;
+    BinaryReader reader(checkpoint);
+    restored_kitchen.Restore(&reader, &timers);
+    restored.Restore(&reader, &timers);
+    EXPECT_TRUE(reader.AtEnd());
+    EXPECT_EQ(restored.BusyCount(), 2);
+    timers.ScheduleAll(&restored_scheduler);
+    DispatchEverySecond(&restored_kitchen, &restored, &restored_scheduler, 8,
+                        20);
+    restored_scheduler.Run();
+
+    const CourierFleet::Stats& stats = fleet.GetStats();
+    const CourierFleet::Stats& restored_stats = restored.GetStats();
+    EXPECT_EQ(restored_stats.trips, stats.trips);
+    EXPECT_EQ(restored_stats.picked_up, stats.picked_up);
+    EXPECT_EQ(restored_stats.backlogged, stats.backlogged);
+    EXPECT_EQ(restored_stats.busy_time, stats.busy_time);
+    EXPECT_EQ(restored_stats.last_free, stats.last_free);
+    EXPECT_EQ(restored_kitchen.GetStats().delivered_value,
+              kitchen.GetStats().delivered_value);
+    EXPECT_GT(stats.backlogged, 0);
+  }
+}
+
+TEST(CourierFleetTest, ParsesDispatchNames) {
+  EXPECT_EQ(ParseDispatchType("matched"), DispatchType::MATCHED);
+  EXPECT_EQ(ParseDispatchType(DispatchName(DispatchType::FIFO)),
+            DispatchType::FIFO);
+  EXPECT_THROW(ParseDispatchType("nearest"), std::invalid_argument);
+}
+
+}  // namespace kitchen_sim
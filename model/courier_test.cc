@@ -21,4 +21,31 @@ TEST(CourierTest, DeliveryTimeRecorded) {
             absl::UnixEpoch() + absl::Seconds(60));
 }
 
+TEST(CourierTest, CarriesUpToCapacity) {
+  boost::asio::io_context context;
+  Kitchen kitchen({"test"}, context);
+  Courier courier(/*capacity=*/2);
+  for (const char* id : {"1", "2", "3"}) {
+    WaitAndGet(kitchen.TakeOrder(
+        Order::CreateOrder(id, "ramen", TemperatureType::HOT, 300, 0.5,
+                           absl::UnixEpoch()),
+        absl::UnixEpoch()));
+  }
+  EXPECT_TRUE(courier.AcceptOrder({OrderId("1"), &kitchen}));
+  EXPECT_TRUE(courier.AcceptOrder({OrderId("2"), &kitchen}));
+  EXPECT_TRUE(courier.IsFull());
+  EXPECT_FALSE(courier.AcceptOrder({OrderId("3"), &kitchen}));
+
+  // Already gone by the time the courier arrives.
+  kitchen.PickupOrder("2", absl::UnixEpoch());
+  std::vector<std::unique_ptr<Order>> delivered;
+  EXPECT_EQ(courier.PickupOrders(absl::UnixEpoch() + absl::Seconds(5),
+                                 &delivered),
+            1);
+  ASSERT_EQ(delivered.size(), 1);
+  EXPECT_EQ(delivered[0]->id_.ToString(), "1");
+  EXPECT_EQ(courier.OrderCount(), 0);
+  EXPECT_TRUE(courier.AcceptOrder({OrderId("3"), &kitchen}));
+}
+
 }  // namespace kitchen_sim
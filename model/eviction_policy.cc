@@ -0,0 +1,149 @@
+#include "model/eviction_policy.h"
+
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "model/value_curves.h"
+#include "runtime/indexed_heap.h"
+
+namespace kitchen_sim {
+namespace {
+
+class RandomEviction : public EvictionPolicy {
+ public:
+  explicit RandomEviction(uint32_t seed) : rand_(seed) {}
+
+  Order* SelectVictim(absl::Span<Order* const> orders, int decay_modifier,
+                      absl::Time at_time) override {
+    std::uniform_int_distribution<int> dist(0, orders.size() - 1);
+    return orders[dist(rand_)];
+  }
+
+  void Checkpoint(BinaryWriter* writer) const override {
+    std::ostringstream state;
+    state << rand_;
+    writer->WriteString(state.str());
+  }
+  void Restore(BinaryReader* reader) override {
+    std::istringstream state{std::string(reader->ReadString())};
+    state >> rand_;
+  }
+
+ private:
+  std::mt19937 rand_;
+};
+
+// Values the whole overflow shelf in one pass over its orders' value curves,
+// which it keeps slotted by kEvictionSlot.
+class LowestValueEviction : public EvictionPolicy {
+ public:
+  void OnAdd(Order* order, int decay_modifier) override {
+    order->*kEvictionSlot = orders_.size();
+    orders_.push_back(order);
+    curves_.Add(*order, decay_modifier);
+  }
+  void OnRemove(Order* order) override {
+    Order* last = orders_.back();
+    orders_[order->*kEvictionSlot] = last;
+    last->*kEvictionSlot = order->*kEvictionSlot;
+    orders_.pop_back();
+    curves_.Remove(order->*kEvictionSlot);
+  }
+
+  Order* SelectVictim(absl::Span<Order* const> orders, int decay_modifier,
+                      absl::Time at_time) override {
+    return orders_[curves_.Summarize(at_time).lowest_slot];
+  }
+
+ private:
+  std::vector<Order*> orders_;
+  ValueCurves curves_;
+};
+
+// Evicts the order with the smallest Key, as computed by |KeyOf| when the
+// order lands on the overflow shelf. Keys must stay fixed while the order sits
+// there.
+template <typename Key, Key (*KeyOf)(const Order&, int)>
+class KeyedEviction : public EvictionPolicy {
+ public:
+  void OnAdd(Order* order, int decay_modifier) override {
+    heap_.Push(KeyOf(*order, decay_modifier), order);
+  }
+  void OnRemove(Order* order) override { heap_.Erase(order); }
+  void OnPickupExpected(Order* order, int decay_modifier) override {
+    heap_.Update(order, KeyOf(*order, decay_modifier));
+  }
+
+  Order* SelectVictim(absl::Span<Order* const> orders, int decay_modifier,
+                      absl::Time at_time) override {
+    return heap_.Top();
+  }
+
+ private:
+  IndexedHeap<Key, Order, kEvictionSlot> heap_;
+};
+
+absl::Time ExpiryKey(const Order& order, int decay_modifier) {
+  return order.Expiry(decay_modifier);
+}
+
+std::pair<double, absl::Time> PickupValueKey(const Order& order,
+                                             int decay_modifier) {
+  const double value =
+      order.PickupTime().has_value()
+          ? order.Value(decay_modifier, order.PickupTime().value())
+          : std::numeric_limits<double>::infinity();
+  return {value, order.Expiry(decay_modifier)};
+}
+
+}  // namespace
+
+EvictionPolicyType ParseEvictionPolicyType(absl::string_view name) {
+  for (EvictionPolicyType type :
+       {EvictionPolicyType::RANDOM, EvictionPolicyType::LOWEST_VALUE,
+        EvictionPolicyType::EARLIEST_EXPIRY,
+        EvictionPolicyType::LOWEST_PICKUP_VALUE}) {
+    if (name == EvictionPolicyName(type)) {
+      return type;
+    }
+  }
+  throw std::invalid_argument(
+      absl::StrCat("Unknown eviction policy: ", name));
+}
+
+absl::string_view EvictionPolicyName(EvictionPolicyType type) {
+  switch (type) {
+    case EvictionPolicyType::RANDOM:
+      return "random";
+    case EvictionPolicyType::LOWEST_VALUE:
+      return "lowest_value";
+    case EvictionPolicyType::EARLIEST_EXPIRY:
+      return "earliest_expiry";
+    case EvictionPolicyType::LOWEST_PICKUP_VALUE:
+      return "lowest_pickup_value";
+  }
+  return "unknown";
+}
+
+std::unique_ptr<EvictionPolicy> EvictionPolicy::Create(EvictionPolicyType type,
+                                                       uint32_t seed) {
+  switch (type) {
+    case EvictionPolicyType::RANDOM:
+      return std::make_unique<RandomEviction>(seed);
+    case EvictionPolicyType::LOWEST_VALUE:
+      return std::make_unique<LowestValueEviction>();
+    case EvictionPolicyType::EARLIEST_EXPIRY:
+      return std::make_unique<KeyedEviction<absl::Time, &ExpiryKey>>();
+    case EvictionPolicyType::LOWEST_PICKUP_VALUE:
+      return std::make_unique<
+          KeyedEviction<std::pair<double, absl::Time>, &PickupValueKey>>();
+  }
+  throw std::invalid_argument("Unknown eviction policy!");
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,77 @@
+#ifndef KITCHEN_SIM_EVICTION_POLICY_H_
+#define KITCHEN_SIM_EVICTION_POLICY_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "model/order.h"
+#include "runtime/binary_io.h"
+
+namespace kitchen_sim {
+
+// How a kitchen picks which overflow order to discard when the overflow shelf
+// is full and nothing can move to a temperature shelf.
+enum class EvictionPolicyType {
+  // Uniformly random.
+  RANDOM,
+  // Lowest value right now. Values of orders with different decay rates cross
+  // over time, so this scans the shelf rather than keeping an index.
+  LOWEST_VALUE,
+  // Soonest to expire on the overflow shelf, i.e. likeliest to be wasted
+  // anyway.
+  EARLIEST_EXPIRY,
+  // Lowest value by the time its courier is expected, so orders that would
+  // expire first go before any that would still be worth something. Orders
+  // without an expected pickup are kept over those with one, earliest expiry
+  // first.
+  LOWEST_PICKUP_VALUE
+};
+
+// Parses "random", "lowest_value", "earliest_expiry" or
+// "lowest_pickup_value". Throws std::invalid_argument otherwise.
+EvictionPolicyType ParseEvictionPolicyType(absl::string_view name);
+absl::string_view EvictionPolicyName(EvictionPolicyType type);
+
+// Chooses overflow orders to discard. The kitchen tells the policy about every
+// order placed on and taken off its overflow shelf, so policies can keep the
+// shelf indexed by their own priority. Like the shelves, only used from the
+// kitchen's scheduler.
+class EvictionPolicy {
+ public:
+  // |seed| drives any random choices.
+  static std::unique_ptr<EvictionPolicy> Create(EvictionPolicyType type,
+                                                uint32_t seed);
+
+  virtual ~EvictionPolicy() = default;
+
+  // |order| was placed on the overflow shelf, whose decay modifier is
+  // |decay_modifier|.
+  virtual void OnAdd(Order* order, int decay_modifier) {}
+  // |order| left the overflow shelf.
+  virtual void OnRemove(Order* order) {}
+  // |order|'s expected pickup changed while on the overflow shelf.
+  virtual void OnPickupExpected(Order* order, int decay_modifier) {}
+
+  // Returns the order to discard from the overflow shelf holding |orders|,
+  // which is never empty.
+  virtual Order* SelectVictim(absl::Span<Order* const> orders,
+                              int decay_modifier, absl::Time at_time) = 0;
+
+  // Saves and restores whatever state OnAdd() doesn't rebuild, such as random
+  // number generators, for kitchen checkpoints. Restore() is called before
+  // the restored overflow orders are added.
+  virtual void Checkpoint(BinaryWriter* writer) const {}
+  virtual void Restore(BinaryReader* reader) {}
+
+ protected:
+  // The order's position in a policy's own index of the overflow shelf, for
+  // policies that keep one.
+  static constexpr uint32_t Order::*kEvictionSlot = &Order::eviction_slot_;
+};
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_EVICTION_POLICY_H_
@@ -0,0 +1,83 @@
+#include "model/eviction_policy.h"
+
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+
+constexpr int kOverflowDecay = 2;
+
+std::unique_ptr<Order> CookedOrder(const std::string& id, int shelf_life_s,
+                                   double decay_rate) {
+  auto order = Order::CreateOrder(id, "gyoza", TemperatureType::HOT,
+                                  shelf_life_s, decay_rate, absl::UnixEpoch());
+  order->SetFulfillmentTime(absl::UnixEpoch());
+  return order;
+}
+
+TEST(EvictionPolicyTest, ParsesNames) {
+  for (EvictionPolicyType type :
+       {EvictionPolicyType::RANDOM, EvictionPolicyType::LOWEST_VALUE,
+        EvictionPolicyType::EARLIEST_EXPIRY,
+        EvictionPolicyType::LOWEST_PICKUP_VALUE}) {
+    EXPECT_EQ(ParseEvictionPolicyType(EvictionPolicyName(type)), type);
+  }
+  EXPECT_THROW(ParseEvictionPolicyType("oldest"), std::invalid_argument);
+}
+
+TEST(EvictionPolicyTest, LowestValue) {
+  auto policy =
+      EvictionPolicy::Create(EvictionPolicyType::LOWEST_VALUE, /*seed=*/1);
+  auto slow = CookedOrder("1", 300, 0.1);
+  auto fast = CookedOrder("2", 300, 1);
+  std::vector<Order*> orders = {slow.get(), fast.get()};
+  for (Order* order : orders) {
+    policy->OnAdd(order, kOverflowDecay);
+  }
+  EXPECT_EQ(policy->SelectVictim(orders, kOverflowDecay,
+                                 absl::UnixEpoch() + absl::Seconds(10)),
+            fast.get());
+}
+
+TEST(EvictionPolicyTest, EarliestExpiry) {
+  auto policy =
+      EvictionPolicy::Create(EvictionPolicyType::EARLIEST_EXPIRY, /*seed=*/1);
+  auto short_lived = CookedOrder("1", 10, 0.5);
+  auto long_lived = CookedOrder("2", 300, 0.5);
+  auto medium = CookedOrder("3", 100, 0.5);
+  std::vector<Order*> orders = {short_lived.get(), long_lived.get(),
+                                medium.get()};
+  for (Order* order : orders) {
+    policy->OnAdd(order, kOverflowDecay);
+  }
+  EXPECT_EQ(policy->SelectVictim(orders, kOverflowDecay, absl::UnixEpoch()),
+            short_lived.get());
+
+  policy->OnRemove(short_lived.get());
+  orders.erase(orders.begin());
+  EXPECT_EQ(policy->SelectVictim(orders, kOverflowDecay, absl::UnixEpoch()),
+            medium.get());
+}
+
+TEST(EvictionPolicyTest, LowestPickupValue) {
+  auto policy = EvictionPolicy::Create(EvictionPolicyType::LOWEST_PICKUP_VALUE,
+                                       /*seed=*/1);
+  auto soon = CookedOrder("1", 300, 0.5);
+  auto late = CookedOrder("2", 300, 0.5);
+  auto unassigned = CookedOrder("3", 10, 0.5);
+  std::vector<Order*> orders = {soon.get(), late.get(), unassigned.get()};
+  for (Order* order : orders) {
+    policy->OnAdd(order, kOverflowDecay);
+  }
+  // Without couriers, the soonest to expire goes first.
+  EXPECT_EQ(policy->SelectVictim(orders, kOverflowDecay, absl::UnixEpoch()),
+            unassigned.get());
+
+  soon->SetPickupTime(absl::UnixEpoch() + absl::Seconds(2));
+  policy->OnPickupExpected(soon.get(), kOverflowDecay);
+  late->SetPickupTime(absl::UnixEpoch() + absl::Seconds(6));
+  policy->OnPickupExpected(late.get(), kOverflowDecay);
+  EXPECT_EQ(policy->SelectVictim(orders, kOverflowDecay, absl::UnixEpoch()),
+            late.get());
+}
+
+}  // namespace kitchen_sim
@@ -1,186 +1,523 @@
 #include "model/kitchen.h"
 
+#include <algorithm>
+#include <random>
+
 #include "absl/strings/str_cat.h"
-#include "absl/strings/str_join.h"
 #include "boost/log/trivial.hpp"
 
 namespace kitchen_sim {
-namespace {
-
-constexpr absl::string_view kExpiryScheduled = "EXPIRY_SCHEDULED";
-constexpr absl::string_view kExpired = "EXPIRED";
-constexpr absl::string_view kDiscarded = "DISCARDED";
-
-}  // namespace
 
 Kitchen::Kitchen(const Options options, boost::asio::io_context& context)
+    : Kitchen(options, static_cast<Scheduler*>(nullptr)) {
+  owned_scheduler_ = std::make_unique<TimingWheel>(context);
+  scheduler_ = owned_scheduler_.get();
+}
+
+Kitchen::Kitchen(const Options options, Scheduler* scheduler)
     : options_(options),
-      overflow_shelf_(options_.overflow_capacity, 1),
-      rand_(std::random_device{}()),
-      context_(context),
-      strand_(context_) {
-  for (const auto& pair : options_.temp_to_capacity) {
-    shelves_[pair.first] = std::make_unique<Shelf>(pair.second, 2);
+      event_sink_(options_.event_sink != nullptr ? options_.event_sink
+                                                 : TextEventSink::Default()),
+      record_events_(event_sink_->IsEnabled()),
+      metrics_(options_.metrics != nullptr
+                   ? std::make_unique<Metrics>(options_.metrics, options_.name)
+                   : nullptr),
+      eviction_policy_(EvictionPolicy::Create(
+          options_.eviction_policy, options_.seed.has_value()
+                                        ? options_.seed.value()
+                                        : std::random_device{}())),
+      scheduler_(scheduler) {
+  const KitchenLayout& layout = options_.layout;
+  if (!layout.IsValid()) {
+    throw std::invalid_argument(
+        absl::StrCat("Invalid shelf layout for kitchen: ", options_.name));
+  }
+  const int total_capacity = layout.TotalCapacity();
+  slots_ = std::make_unique<Order*[]>(total_capacity);
+  Order** next_slot = slots_.get();
+  for (int index = 1; index < kOverflowShelf; ++index) {
+    const int capacity =
+        layout.ShelfCapacity(static_cast<TemperatureType>(index));
+    if (capacity != KitchenLayout::kNoShelf) {
+      shelves_[index].emplace(index, next_slot, capacity, 1);
+      next_slot += capacity;
+    }
+  }
+  shelves_[kOverflowShelf].emplace(kOverflowShelf, next_slot,
+                                   layout.overflow_capacity, 2);
+  orders_.reserve(total_capacity);
+  for (auto& bucket : overflow_buckets_) {
+    bucket.reserve(layout.overflow_capacity);
+  }
+}
+
+Kitchen::Metrics::Metrics(MetricsRegistry* registry,
+                          const std::string& kitchen) {
+  const auto orders = [&](const char* event) {
+    return registry->GetCounter("kitchen_orders_total",
+                                "Orders by what happened to them.",
+                                {{"kitchen", kitchen}, {"event", event}});
+  };
+  received = orders("received");
+  delivered = orders("delivered");
+  expired = orders("expired");
+  discarded = orders("discarded");
+  overflowed = orders("overflowed");
+  moved_from_overflow = orders("moved_from_overflow");
+  const MetricsRegistry::Labels labels = {{"kitchen", kitchen}};
+  overflow_orders = registry->GetGauge(
+      "kitchen_overflow_orders", "Orders on the overflow shelf.", labels);
+  shelf_time_ms = registry->GetHistogram(
+      "kitchen_shelf_time_ms",
+      "Simulated milliseconds orders spent shelved before pickup.", labels);
+  take_order_ns = registry->GetHistogram(
+      "kitchen_take_order_ns", "Wall nanoseconds to take each order.", labels);
+  pickup_order_ns = registry->GetHistogram(
+      "kitchen_pickup_order_ns", "Wall nanoseconds per pickup.", labels);
+  make_overflow_room_ns = registry->GetHistogram(
+      "kitchen_make_overflow_room_ns",
+      "Wall nanoseconds to make room on a full overflow shelf.", labels);
+}
+
+Kitchen::Stats& Kitchen::Stats::operator+=(const Stats& other) {
+  received += other.received;
+  delivered += other.delivered;
+  expired += other.expired;
+  discarded += other.discarded;
+  overflowed += other.overflowed;
+  moved_from_overflow += other.moved_from_overflow;
+  delivered_value += other.delivered_value;
+  return *this;
+}
+
+double Kitchen::Stats::WasteRate() const {
+  if (received == 0) {
+    return 0.;
+  }
+  return static_cast<double>(expired + discarded) / received;
+}
+
+Eventual<Order*> Kitchen::TakeOrder(std::unique_ptr<Order> order,
+                                    absl::Time at_time) {
+  ScopedLatency latency(metrics_ != nullptr ? metrics_->take_order_ns
+                                            : nullptr);
+  CheckTemperature(*order);
+  Order* taken = PlaceOrder(std::move(order), at_time);
+  MaybeLogShelves(at_time);
+  return taken;
+}
+
+std::vector<Order*> Kitchen::TakeOrders(
+    absl::Span<std::unique_ptr<Order>> orders, absl::Time at_time) {
+  ScopedLatency latency(
+      metrics_ != nullptr ? metrics_->take_order_ns : nullptr, orders.size());
+  for (const auto& order : orders) {
+    CheckTemperature(*order);
+  }
+  std::vector<Order*> taken(orders.size());
+  taking_ = &taken;
+  for (size_t i = 0; i < orders.size(); ++i) {
+    taken[i] = PlaceOrder(std::move(orders[i]), at_time);
   }
+  taking_ = nullptr;
+  MaybeLogShelves(at_time);
+  return taken;
 }
 
-fibers::future<Order*> Kitchen::TakeOrder(std::unique_ptr<Order> order,
-                                          absl::Time at_time) {
-  fibers::promise<Order*> fulfilled_order;
-  auto it = shelves_.find(order->temp_);
-  if (it == shelves_.end()) {
+void Kitchen::CheckTemperature(const Order& order) const {
+  const int index = static_cast<int>(order.temp_);
+  if (index <= 0 || index >= kOverflowShelf || !shelves_[index].has_value()) {
     throw std::invalid_argument(
         absl::StrCat("Could not find shelf for kitchen: ", options_.name,
-                     " temperature group: ", order->temp_));
+                     " temperature group: ", order.temp_));
   }
+}
+
+Order* Kitchen::PlaceOrder(std::unique_ptr<Order> order, absl::Time at_time) {
+  Shelf* shelf = ShelfFor(order->temp_);
+  ++stats_.received;
   order->SetFulfillmentTime(at_time);
-  if (PlaceOrder(order.get(), it->second.get())) {
-    // Try placing on matching temperature shelf first.
-    fulfilled_order.set_value(order.get());
-  } else {
+  // Expire the order as if it kept its full value on a temperature shelf from
+  // when it was cooked. Assuming a fixed expiry avoids handler cancel churn.
+  const absl::Time expiry = order->Expiry(/*current_shelf_decay_modifier=*/1);
+  if (metrics_ != nullptr) {
+    metrics_->received->Increment();
+  }
+  // Try placing on matching temperature shelf first.
+  if (!shelf->AddOrder(order.get())) {
     // What about the overflow shelf?
-    if (!PlaceOrder(order.get(), &overflow_shelf_)) {
-      MakeOverflowRoom();
-      PlaceOrder(order.get(), &overflow_shelf_);
+    ++stats_.overflowed;
+    if (metrics_ != nullptr) {
+      metrics_->overflowed->Increment();
+    }
+    if (!AddToOverflow(order.get())) {
+      MakeOverflowRoom(at_time);
+      AddToOverflow(order.get());
     }
-    fulfilled_order.set_value(order.get());
   }
 
   // Schedule expiration timer.
-  // Assuming a fixed expiry avoids handler cancel churn.
-  absl::Time expiry = order->Expiry(1);
-  BOOST_LOG_TRIVIAL(info) << order->LogMessage(kExpiryScheduled) << " @ "
-                          << absl::FormatTime(
-                                 "%H:%M:%S", expiry,
-                                 absl::FixedTimeZone(
-                                     -7 * 60 * 60));  // It's always LA time.
-
-  order->expiration_timer_ =
-      std::make_unique<boost::asio::system_timer>(context_);
-  order->expiration_timer_->expires_at(absl::ToChronoTime(expiry));
-  order->expiration_timer_->async_wait(boost::asio::bind_executor(
-      strand_, [=, order_id = order->id_](const boost::system::error_code& e) {
-        auto expired_order = PickupOrder(order_id);
-        if (expired_order != nullptr) {
-          BOOST_LOG_TRIVIAL(debug) << expired_order->LogMessage(kExpired);
-          LogShelves();
-        } else {
-          // Already picked up or discarded.
-        }
-      }));
+  order->expiration_timer_ = scheduler_->ScheduleAt(
+      expiry, [this, order = order.get()] { ExpireOrder(order); });
 
+  Order* taken = order.get();
   orders_[order->id_] = std::move(order);
-  return fulfilled_order.get_future();
+  RecordEvent(EventType::EXPIRY_SCHEDULED, *taken, expiry);
+  RecordEvent(EventType::COOKED, *taken, at_time);
+  return taken;
 }
 
-std::unique_ptr<Order> Kitchen::PickupOrder(absl::string_view order_id,
+std::unique_ptr<Order> Kitchen::PickupOrder(const OrderId& order_id,
                                             absl::Time at_time) {
+  ScopedLatency latency(metrics_ != nullptr ? metrics_->pickup_order_ns
+                                            : nullptr);
   auto it = orders_.find(order_id);
   if (it == orders_.end()) {
     return nullptr;
   }
-  if (OrderValue(order_id, at_time) <= 0.) {
+  const Order& order = *it->second;
+  const Shelf* shelf = HoldingShelf(order);
+  const double value =
+      shelf == nullptr ? 0. : order.Value(shelf->DecayModifier(), at_time);
+  if (value <= 0.) {
     // Let expiry handler clean up.
     return nullptr;
   }
+  ++stats_.delivered;
+  stats_.delivered_value += value;
+  if (metrics_ != nullptr) {
+    metrics_->delivered->Increment();
+    metrics_->shelf_time_ms->Record(std::max<int64_t>(
+        0, absl::ToInt64Milliseconds(at_time - *order.FulfillmentTime())));
+  }
+  RecordEvent(EventType::DELIVERED, order, at_time);
+  auto picked_up = RemoveOrder(it, RemovalReason::PICKED_UP, at_time);
+  MaybeLogShelves(at_time);
+  return picked_up;
+}
+
+std::unique_ptr<Order> Kitchen::RemoveOrder(const OrderId& order_id,
+                                            RemovalReason reason,
+                                            absl::Time at_time) {
+  auto it = orders_.find(order_id);
+  if (it == orders_.end()) {
+    return nullptr;
+  }
+  return RemoveOrder(it, reason, at_time);
+}
+
+std::unique_ptr<Order> Kitchen::RemoveOrder(OrderMap::iterator it,
+                                            RemovalReason reason,
+                                            absl::Time at_time) {
   std::unique_ptr<Order> order = std::move(it->second);
-  order_to_shelf_[order_id]->RemoveOrder(order.get());
-  order_to_shelf_.erase(order_id);
-  orders_.erase(order_id);
+  if (order->expiration_timer_.has_value()) {
+    // No-op when called from the expiry handler itself.
+    scheduler_->Cancel(order->expiration_timer_.value());
+    order->expiration_timer_.reset();
+  }
+  if (order->shelf_index_ == kOverflowShelf) {
+    RemoveFromOverflow(order.get());
+  } else if (order->shelf_index_ >= 0) {
+    shelves_[order->shelf_index_]->RemoveOrder(order.get());
+    // Fill the freed slot straight away, so the order stops decaying at the
+    // overflow shelf's faster rate.
+    PromoteFromOverflow(order->temp_, at_time);
+  }
+  orders_.erase(it);
+  if (order->listener_ != nullptr) {
+    order->listener_->OnRemoved(order.get(), reason, at_time);
+  }
   return order;
 }
 
-double Kitchen::OrderValue(absl::string_view id, absl::Time at_time) const {
+void Kitchen::Checkpoint(BinaryWriter* writer) const {
+  writer->Write(stats_);
+  writer->WriteTime(last_shelf_log_);
+  eviction_policy_->Checkpoint(writer);
+  writer->Write<uint32_t>(orders_.size());
+  // In shelf and slot order, so restoring rebuilds the shelves slot for slot.
+  for (const auto& shelf : shelves_) {
+    if (!shelf.has_value()) {
+      continue;
+    }
+    for (const Order* order : shelf->Orders()) {
+      writer->WriteString(order->id_.ToString());
+      writer->WriteString(order->name_);
+      writer->WriteString(order->region_);
+      writer->Write<int32_t>(static_cast<int32_t>(order->temp_));
+      writer->Write<int32_t>(order->shelf_life_s_);
+      writer->Write<double>(order->decay_rate_);
+      writer->WriteTime(order->receipt_time_);
+      writer->WriteTime(order->FulfillmentTime().value());
+      writer->Write<double>(order->LastValueAtMove());
+      writer->WriteTime(order->LastMoveTime().value());
+      writer->WriteOptionalTime(order->pickup_time_);
+      writer->Write<int32_t>(order->shelf_index_);
+      writer->Write<uint32_t>(order->overflow_bucket_slot_);
+      writer->Write<uint32_t>(order->eviction_slot_);
+      writer->Write<uint64_t>(order->expiration_timer_.value());
+    }
+  }
+}
+
+void Kitchen::Restore(BinaryReader* reader, RestoredTimers* timers) {
+  if (!orders_.empty()) {
+    throw std::invalid_argument(absl::StrCat(
+        "Cannot restore into a kitchen holding orders: ", options_.name));
+  }
+  stats_ = reader->Read<Stats>();
+  last_shelf_log_ = reader->ReadTime();
+  eviction_policy_->Restore(reader);
+  const uint32_t count = reader->Read<uint32_t>();
+  std::vector<Order*> overflow;
+  for (uint32_t i = 0; i < count; ++i) {
+    const OrderId id(reader->ReadString());
+    const absl::string_view name = reader->ReadString();
+    const absl::string_view region = reader->ReadString();
+    const auto temp = static_cast<TemperatureType>(reader->Read<int32_t>());
+    const int32_t shelf_life_s = reader->Read<int32_t>();
+    const double decay_rate = reader->Read<double>();
+    const absl::Time receipt_time = reader->ReadTime();
+    auto order = std::make_unique<Order>(id, name, temp, shelf_life_s,
+                                         decay_rate, receipt_time);
+    order->region_ = std::string(region);
+    order->SetFulfillmentTime(reader->ReadTime());
+    // The expiry PlaceOrder() scheduled, taken before the last move is back.
+    const absl::Time expiry = order->Expiry(/*current_shelf_decay_modifier=*/1);
+    const double last_value_at_move = reader->Read<double>();
+    order->RestoreLastMove(last_value_at_move, reader->ReadTime());
+    order->pickup_time_ = reader->ReadOptionalTime();
+    const int32_t shelf_index = reader->Read<int32_t>();
+    order->overflow_bucket_slot_ = reader->Read<uint32_t>();
+    order->eviction_slot_ = reader->Read<uint32_t>();
+    const uint64_t expiration_timer = reader->Read<uint64_t>();
+
+    CheckTemperature(*order);
+    if (shelf_index <= 0 || shelf_index >= kShelfCount ||
+        !shelves_[shelf_index].has_value() ||
+        !shelves_[shelf_index]->AddOrder(order.get()) ||
+        orders_.contains(order->id_)) {
+      throw std::invalid_argument(absl::StrCat(
+          "Checkpointed order does not fit kitchen: ", options_.name));
+    }
+    if (shelf_index == kOverflowShelf) {
+      overflow.push_back(order.get());
+    }
+    timers->Add(expiration_timer, expiry,
+                [this, order = order.get()] { ExpireOrder(order); },
+                &order->expiration_timer_.emplace());
+    orders_[order->id_] = std::move(order);
+  }
+
+  // Buckets and the eviction policy's index are rebuilt in their original
+  // slot order, so later promotions and evictions pick the same orders.
+  for (Order* order : overflow) {
+    auto& bucket = overflow_buckets_[static_cast<int>(order->temp_)];
+    if (bucket.size() <= order->overflow_bucket_slot_) {
+      bucket.resize(order->overflow_bucket_slot_ + 1);
+    }
+    bucket[order->overflow_bucket_slot_] = order;
+  }
+  for (const auto& bucket : overflow_buckets_) {
+    if (std::find(bucket.begin(), bucket.end(), nullptr) != bucket.end()) {
+      throw std::invalid_argument(absl::StrCat(
+          "Checkpointed overflow shelf is inconsistent: ", options_.name));
+    }
+  }
+  std::stable_sort(overflow.begin(), overflow.end(),
+                   [](const Order* a, const Order* b) {
+                     return a->eviction_slot_ < b->eviction_slot_;
+                   });
+  for (Order* order : overflow) {
+    eviction_policy_->OnAdd(order, OverflowShelf().DecayModifier());
+  }
+  if (metrics_ != nullptr) {
+    metrics_->overflow_orders->Add(overflow.size());
+  }
+}
+
+void Kitchen::ExpireOrder(Order* order) {
+  const absl::Time now = scheduler_->Now();
+  ++stats_.expired;
+  if (metrics_ != nullptr) {
+    metrics_->expired->Increment();
+  }
+  RecordEvent(EventType::EXPIRED, *order, now);
+  RemoveOrder(order->id_, RemovalReason::EXPIRED, now);
+  MaybeLogShelves(now);
+}
+
+Order* Kitchen::FindOrder(const OrderId& order_id) const {
+  auto it = orders_.find(order_id);
+  return it == orders_.end() ? nullptr : it->second.get();
+}
+
+void Kitchen::ExpectPickup(Order* order, absl::Time at_time) {
+  order->SetPickupTime(at_time);
+  if (order->shelf_index_ == kOverflowShelf) {
+    eviction_policy_->OnPickupExpected(order, OverflowShelf().DecayModifier());
+  }
+}
+
+double Kitchen::OrderValue(const OrderId& id, absl::Time at_time) const {
   auto it = orders_.find(id);
   if (it == orders_.end()) {
     return 0.;
   }
-  auto shelf_it = order_to_shelf_.find(id);
-  if (shelf_it == order_to_shelf_.end()) {
+  const Shelf* shelf = HoldingShelf(*it->second);
+  if (shelf == nullptr) {
     return 0.;
   }
-  int decay_modifier = shelf_it->second == &overflow_shelf_ ? 2 : 1;
-  return it->second->Value(decay_modifier, at_time);
+  return it->second->Value(shelf->DecayModifier(), at_time);
+}
+
+const Kitchen::Shelf& Kitchen::TemperatureShelf(TemperatureType temp) const {
+  const int index = static_cast<int>(temp);
+  if (index <= 0 || index >= kOverflowShelf || !shelves_[index].has_value()) {
+    throw std::out_of_range("No shelf for temperature group!");
+  }
+  return *shelves_[index];
+}
+
+Kitchen::Shelf* Kitchen::ShelfFor(TemperatureType temp) {
+  const int index = static_cast<int>(temp);
+  if (index <= 0 || index >= kOverflowShelf) {
+    return nullptr;
+  }
+  return shelves_[index].has_value() ? &*shelves_[index] : nullptr;
+}
+
+const Kitchen::Shelf* Kitchen::HoldingShelf(const Order& order) const {
+  if (order.shelf_index_ < 0) {
+    return nullptr;
+  }
+  return &*shelves_[order.shelf_index_];
 }
 
 namespace {
-std::string PrintTemperatureType(TemperatureType temp) {
-  switch (temp) {
-    case TemperatureType::HOT:
-      return "HOT";
-    case TemperatureType::COLD:
-      return "COLD";
-    case TemperatureType::FROZEN:
-      return "FROZEN";
-    default:
-      return "UNKNOWN";
-  }
-}
-
-std::string LogMessageForShelf(const Kitchen::Shelf& shelf) {
-  std::string message;
-  message.append("[")
-      .append(absl::StrJoin(
-          shelf.Orders(), ", ",
-          [&](std::string* out, const auto* order) {
-            out->append(order->name_)
-                .append(": ")
-                .append(absl::StrCat(order->Value(shelf.DecayModifier())));
-          }))
-      .append("]");
+std::string LogMessageForShelf(const Kitchen::Shelf& shelf,
+                               absl::Time at_time) {
+  std::vector<double> values;
+  shelf.Curves().Values(at_time, &values);
+  std::string message = "[";
+  for (size_t slot = 0; slot < values.size(); ++slot) {
+    absl::StrAppend(&message, slot > 0 ? ", " : "",
+                    shelf.Orders()[slot]->name_, ": ", values[slot]);
+  }
+  message.append("]");
   return message;
 }
 }  // namespace
 
 void Kitchen::LogShelves() const {
-  for (const auto& pair : shelves_) {
-    std::string shelf_message;
-    shelf_message.append("shelf: ")
-        .append(PrintTemperatureType(pair.first))
-        .append(" ")
-        .append(LogMessageForShelf(*pair.second));
-    BOOST_LOG_TRIVIAL(info) << shelf_message;
+  // Shelf contents are only rendered if the record passes the logger's filter.
+  const absl::Time now = scheduler_->Now();
+  for (int index = 0; index < kOverflowShelf; ++index) {
+    if (shelves_[index].has_value()) {
+      BOOST_LOG_TRIVIAL(info)
+          << "shelf: "
+          << PrintTemperatureType(static_cast<TemperatureType>(index)) << " "
+          << LogMessageForShelf(*shelves_[index], now);
+    }
   }
-  std::string overflow_message;
-  overflow_message.append("shelf: OVERFLOW ")
-      .append(LogMessageForShelf(overflow_shelf_));
-  BOOST_LOG_TRIVIAL(info) << overflow_message;
+  BOOST_LOG_TRIVIAL(info) << "shelf: OVERFLOW "
+                          << LogMessageForShelf(OverflowShelf(), now);
 }
 
-bool Kitchen::PlaceOrder(Order* order, Shelf* shelf) {
-  bool added = shelf->AddOrder(order);
-  if (added) {
-    order_to_shelf_[order->id_] = shelf;
+void Kitchen::RecordEvent(EventType type, const Order& order,
+                          absl::Time at_time) const {
+  if (!record_events_) {
+    return;
+  }
+  Event event = {type, at_time};
+  event.kitchen = options_.index;
+  if (const Shelf* shelf = HoldingShelf(order)) {
+    event.value = order.Value(shelf->DecayModifier(), at_time);
+    event.overflow = order.shelf_index_ == kOverflowShelf;
   }
-  return added;
+  event_sink_->Record(event, order);
 }
 
-void Kitchen::MakeOverflowRoom() {
-  std::unordered_set<TemperatureType> open_shelves;
-  for (auto& pair : shelves_) {
-    if (!pair.second->AtCapacity()) {
-      open_shelves.insert(pair.first);
-    }
+void Kitchen::MaybeLogShelves(absl::Time at_time) {
+  if (options_.shelf_log_interval == absl::InfiniteDuration() ||
+      at_time - last_shelf_log_ < options_.shelf_log_interval) {
+    return;
   }
+  last_shelf_log_ = at_time;
+  LogShelves();
+}
 
-  std::vector<const Order*> overflow_orders;
-  for (const Order* overflow_order : overflow_shelf_.Orders()) {
-    const TemperatureType temp = overflow_order->temp_;
-    if (open_shelves.find(temp) != open_shelves.end()) {
-      // Move overflow order to temperature shelf.
-      auto* order = orders_[overflow_order->id_].get();
-      overflow_shelf_.RemoveOrder(order);
-      order->MoveFrom(overflow_shelf_.DecayModifier());
-      PlaceOrder(order, shelves_[temp].get());
+bool Kitchen::AddToOverflow(Order* order) {
+  Shelf* overflow_shelf = &*shelves_[kOverflowShelf];
+  if (!overflow_shelf->AddOrder(order)) {
+    return false;
+  }
+  auto& bucket = overflow_buckets_[static_cast<int>(order->temp_)];
+  order->overflow_bucket_slot_ = bucket.size();
+  bucket.push_back(order);
+  eviction_policy_->OnAdd(order, overflow_shelf->DecayModifier());
+  if (metrics_ != nullptr) {
+    metrics_->overflow_orders->Add(1);
+  }
+  return true;
+}
+
+void Kitchen::RemoveFromOverflow(Order* order) {
+  eviction_policy_->OnRemove(order);
+  // Fills the vacated slot with the last order, like Shelf::RemoveOrder().
+  auto& bucket = overflow_buckets_[static_cast<int>(order->temp_)];
+  Order* last = bucket.back();
+  bucket[order->overflow_bucket_slot_] = last;
+  last->overflow_bucket_slot_ = order->overflow_bucket_slot_;
+  bucket.pop_back();
+  shelves_[kOverflowShelf]->RemoveOrder(order);
+  if (metrics_ != nullptr) {
+    metrics_->overflow_orders->Add(-1);
+  }
+}
+
+bool Kitchen::PromoteFromOverflow(TemperatureType temp, absl::Time at_time) {
+  const auto& bucket = overflow_buckets_[static_cast<int>(temp)];
+  Shelf* shelf = ShelfFor(temp);
+  if (bucket.empty() || shelf->AtCapacity()) {
+    return false;
+  }
+  Order* order = bucket.back();
+  RemoveFromOverflow(order);
+  order->MoveFrom(OverflowShelf().DecayModifier(), at_time);
+  shelf->AddOrder(order);
+  ++stats_.moved_from_overflow;
+  if (metrics_ != nullptr) {
+    metrics_->moved_from_overflow->Increment();
+  }
+  RecordEvent(EventType::MOVED, *order, at_time);
+  return true;
+}
+
+void Kitchen::MakeOverflowRoom(absl::Time at_time) {
+  ScopedLatency latency(metrics_ != nullptr ? metrics_->make_overflow_room_ns
+                                            : nullptr);
+  // Orders are promoted as soon as their shelf frees up, so normally there is
+  // nothing to move; checking costs one bucket per temperature.
+  for (int index = 0; index < kOverflowShelf; ++index) {
+    if (PromoteFromOverflow(static_cast<TemperatureType>(index), at_time)) {
       return;
     }
-    overflow_orders.push_back(overflow_order);
   }
-  // Discard random order
-  std::uniform_int_distribution<int> dist(0, overflow_orders.size() - 1);
-  const Order* discarded = overflow_orders[dist(rand_)];
-  BOOST_LOG_TRIVIAL(info) << discarded->LogMessage(kDiscarded);
-  overflow_shelf_.RemoveOrder(discarded);
+  Shelf* overflow_shelf = &*shelves_[kOverflowShelf];
+  Order* discarded = eviction_policy_->SelectVictim(
+      overflow_shelf->Orders(), overflow_shelf->DecayModifier(), at_time);
+  ++stats_.discarded;
+  if (metrics_ != nullptr) {
+    metrics_->discarded->Increment();
+  }
+  RecordEvent(EventType::DISCARDED, *discarded, at_time);
+  if (taking_ != nullptr) {
+    // Linear, but batches are small.
+    std::replace(taking_->begin(), taking_->end(), discarded,
+                 static_cast<Order*>(nullptr));
+  }
+  RemoveOrder(discarded->id_, RemovalReason::DISCARDED, at_time);
 }
 
-}  // namespace kitchen_sim
\ No newline at end of file
+}  // namespace kitchen_sim
@@ -1,17 +1,28 @@
 #ifndef KITCHEN_SIM_KITCHEN_H_
 #define KITCHEN_SIM_KITCHEN_H_
 
+#include <array>
+#include <cstdint>
 #include <memory>
-#include <random>
+#include <optional>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "base.h"
+#include "events/event_sink.h"
+#include "metrics/metrics.h"
+#include "model/eviction_policy.h"
+#include "model/kitchen_layout.h"
 #include "model/order.h"
+#include "model/value_curves.h"
+#include "runtime/binary_io.h"
+#include "runtime/eventual.h"
+#include "runtime/scheduler.h"
+#include "runtime/timing_wheel.h"
 
 namespace kitchen_sim {
 
@@ -21,106 +32,304 @@ class Kitchen {
  public:
   struct Options {
     std::string name;
-    int overflow_capacity = 15;
-    // Temperature group to shelf capacity.
-    std::unordered_map<TemperatureType, int> temp_to_capacity = {
-        {TemperatureType::HOT, 10},
-        {TemperatureType::COLD, 10},
-        {TemperatureType::FROZEN, 10},
-    };
+    // Shelf capacities. Must be valid.
+    KitchenLayout layout = kLargeKitchenLayout;
+    // Seed for discard decisions. Drawn from std::random_device if unset.
+    std::optional<uint32_t> seed;
+    // Picks which overflow order to discard when there's no room left.
+    EvictionPolicyType eviction_policy = EvictionPolicyType::RANDOM;
+    // Index of the kitchen within its fleet, used to tag events.
+    uint16_t index = 0;
+    // Receives order events; must outlive the kitchen. Defaults to
+    // TextEventSink::Default().
+    EventSink* event_sink = nullptr;
+    // Minimum simulated time between shelf dumps to the info log. Zero dumps
+    // after every order event; absl::InfiniteDuration() never does.
+    absl::Duration shelf_log_interval = absl::ZeroDuration();
+    // Receives the kitchen's metrics, labelled with its name; must outlive the
+    // kitchen. None are recorded if unset.
+    MetricsRegistry* metrics = nullptr;
   };
 
-  // Represents a single order shelf.
+  // Running totals of what happened to orders taken by this kitchen.
+  struct Stats {
+    uint64_t received = 0;
+    uint64_t delivered = 0;
+    uint64_t expired = 0;
+    uint64_t discarded = 0;
+    // Orders placed on the overflow shelf, and of those, later moved to their
+    // temperature shelf.
+    uint64_t overflowed = 0;
+    uint64_t moved_from_overflow = 0;
+    // Sum of order values at pickup.
+    double delivered_value = 0.;
+
+    Stats& operator+=(const Stats& other);
+
+    // Share of received orders that expired or were discarded.
+    double WasteRate() const;
+  };
+
+  // Represents a single order shelf. Orders occupy a dense, fixed-capacity
+  // array of slots, and each order carries its slot, so that placing,
+  // removing and scanning orders never allocate or hash. The shelf keeps each
+  // order's value curve alongside, so it can be valued in one pass.
   class Shelf {
    public:
-    explicit Shelf(int max_capacity, int decay_modifier)
-        : max_capacity_(max_capacity), decay_modifier_(decay_modifier) {
-      orders_.reserve(max_capacity);
+    // |index| identifies the shelf within its kitchen. |slots| holds
+    // |max_capacity| orders and must outlive the shelf.
+    Shelf(int index, Order** slots, int max_capacity, int decay_modifier)
+        : index_(index),
+          slots_(slots),
+          max_capacity_(max_capacity),
+          decay_modifier_(decay_modifier) {
+      curves_.Reserve(max_capacity);
     }
 
-    bool AddOrder(const Order* order) {
+    bool AddOrder(Order* order) {
       if (AtCapacity()) {
         return false;
       }
-      orders_.insert(order);
+      order->shelf_index_ = index_;
+      order->shelf_slot_ = size_;
+      slots_[size_++] = order;
+      curves_.Add(*order, decay_modifier_);
       return true;
     }
 
-    void RemoveOrder(const Order* order) { orders_.erase(order); }
+    // Fills the vacated slot with the last order, so slots stay dense.
+    void RemoveOrder(Order* order) {
+      if (!Holds(*order)) {
+        return;
+      }
+      Order* last = slots_[--size_];
+      slots_[order->shelf_slot_] = last;
+      last->shelf_slot_ = order->shelf_slot_;
+      curves_.Remove(order->shelf_slot_);
+      order->shelf_index_ = -1;
+    }
+
+    bool Holds(const Order& order) const {
+      return order.shelf_index_ == index_;
+    }
 
-    const std::unordered_set<const Order*>& Orders() const { return orders_; }
+    // In slot order.
+    absl::Span<Order* const> Orders() const {
+      return absl::MakeConstSpan(slots_, size_);
+    }
+    // Slotted like Orders().
+    const ValueCurves& Curves() const { return curves_; }
 
-    bool AtCapacity() const { return orders_.size() >= max_capacity_; }
+    bool AtCapacity() const { return size_ >= max_capacity_; }
 
     int DecayModifier() const { return decay_modifier_; }
 
    private:
+    const int index_;
+    // Kitchen retains ownership of the slots and of individual orders.
+    Order** const slots_;
     const size_t max_capacity_;
     const int decay_modifier_;
 
-    // Kitchen retains ownership of individual orders.
-    std::unordered_set<const Order*> orders_;
+    size_t size_ = 0;
+    ValueCurves curves_;
   };
 
+  // Schedules expiry on a wall clock TimingWheel owned by the kitchen.
   Kitchen(const Options options, boost::asio::io_context& context);
+  // Schedules expiry on |scheduler|, which must outlive the kitchen.
+  Kitchen(const Options options, Scheduler* scheduler);
   Kitchen(Kitchen const&) = delete;
   Kitchen& operator=(Kitchen const&) = delete;
 
   // Takes |order| and attempts to place it on the shelf matching its
   // temperature. If that fails, the order is placed on the overflow shelf; if
   // already full, room can be made by shifting an existing order to a
-  // single-temperature shelf. Failing that, an overflow order is randomly
-  // discarded to make room.
-  // Returns a future that fires when cooking is done.
-  fibers::future<Order*> TakeOrder(std::unique_ptr<Order> order,
-                                   absl::Time at_time = absl::Now());
+  // single-temperature shelf. Failing that, an overflow order chosen by the
+  // kitchen's eviction policy is discarded to make room.
+  // Returns the shelved order once cooking is done, which is presently
+  // always on return.
+  Eventual<Order*> TakeOrder(std::unique_ptr<Order> order,
+                             absl::Time at_time = absl::Now());
+
+  // Takes every order in |orders|, in order, as if by TakeOrder(), and
+  // returns them in the same positions. Orders discarded to make room for
+  // later ones in the batch come back as nullptr. Shelves are logged once per
+  // batch rather than once per order.
+  // Throws std::invalid_argument, taking none of them, if any order has no
+  // matching shelf.
+  std::vector<Order*> TakeOrders(absl::Span<std::unique_ptr<Order>> orders,
+                                 absl::Time at_time = absl::Now());
 
   // Returns an order matching |order_id| (or nullptr if none is found) and
-  // removes it from its shelf.
+  // removes it from its shelf. An overflow order of the same temperature, if
+  // any, takes its place.
   // Transfers ownership to caller if found.
-  std::unique_ptr<Order> PickupOrder(absl::string_view order_id,
+  std::unique_ptr<Order> PickupOrder(const OrderId& order_id,
                                      absl::Time at_time = absl::Now());
+  std::unique_ptr<Order> PickupOrder(absl::string_view order_id,
+                                     absl::Time at_time = absl::Now()) {
+    return PickupOrder(OrderId(order_id), at_time);
+  }
+
+  // Returns the held order matching |order_id|, or nullptr if there is none.
+  // The kitchen keeps ownership.
+  Order* FindOrder(const OrderId& order_id) const;
+
+  // Notes that the courier for |order|, which the kitchen holds, is expected
+  // at |at_time|, for eviction policies that take it into account.
+  void ExpectPickup(Order* order, absl::Time at_time);
 
   // Returns the value of the order with |id|.
+  double OrderValue(const OrderId& id, absl::Time at_time = absl::Now()) const;
   double OrderValue(absl::string_view id,
-                    absl::Time at_time = absl::Now()) const;
-
-  const Shelf& TemperatureShelf(TemperatureType temp) const {
-    return *shelves_.at(temp);
+                    absl::Time at_time = absl::Now()) const {
+    return OrderValue(OrderId(id), at_time);
   }
-  const Shelf& OverflowShelf() const { return overflow_shelf_; }
+
+  // Throws std::out_of_range if the kitchen has no shelf for |temp|.
+  const Shelf& TemperatureShelf(TemperatureType temp) const;
+  const Shelf& OverflowShelf() const { return *shelves_[kOverflowShelf]; }
+
+  const KitchenLayout& Layout() const { return options_.layout; }
 
   // Prints out current shelf contents to the info log.
   void LogShelves() const;
 
-  boost::asio::io_context::strand& Strand() { return strand_; }
+  // Reports |type| for |order| to the kitchen's event sink, tagged with the
+  // order's value and shelf if the kitchen holds it.
+  void RecordEvent(EventType type, const Order& order,
+                   absl::Time at_time) const;
+
+  // Appends every held order, with its place on the shelves, decay and
+  // pending expiry, to |writer|, along with the kitchen's stats and eviction
+  // policy state. Only meaningful on a VirtualScheduler that isn't running,
+  // whose timer ids the checkpoint keeps.
+  void Checkpoint(BinaryWriter* writer) const;
+
+  // Reads back what Checkpoint() wrote into this kitchen, which must hold no
+  // orders and have shelves at least as large, in one pass. The orders'
+  // expiry timers are added to |timers|, for the caller to schedule once
+  // everything else sharing the scheduler is restored. Metrics only count
+  // what happens from here on.
+  // Throws std::invalid_argument if the checkpoint is malformed or doesn't
+  // fit.
+  void Restore(BinaryReader* reader, RestoredTimers* timers);
+
+  const std::string& Name() const { return options_.name; }
+
+  // Like the shelves, only safe to read from the kitchen's scheduler or once
+  // the kitchen is idle.
+  const Stats& GetStats() const { return stats_; }
+
+  Scheduler& GetScheduler() { return *scheduler_; }
 
  private:
-  // Places |order| on |shelf| updating any necessary bookkkeeping.
-  bool PlaceOrder(Order* order, Shelf* shelf);
+  // Shelf indices; temperature shelves are indexed by their TemperatureType.
+  static constexpr int kOverflowShelf = 4;
+  static constexpr int kShelfCount = 5;
+
+  // Throws std::invalid_argument if the kitchen has no shelf for |order|.
+  void CheckTemperature(const Order& order) const;
+
+  // Shelves |order|, which must have a matching shelf, and schedules its
+  // expiry.
+  Order* PlaceOrder(std::unique_ptr<Order> order, absl::Time at_time);
+
+  // Returns the shelf for |temp|, or nullptr if there is none.
+  Shelf* ShelfFor(TemperatureType temp);
+
+  // The shelf holding |order|, or nullptr if it isn't shelved.
+  const Shelf* HoldingShelf(const Order& order) const;
+
+  using OrderMap =
+      absl::flat_hash_map<OrderId, std::unique_ptr<Order>, OrderId::Hasher>;
+
+  // Removes the order matching |order_id| from its shelf and all bookkeeping
+  // regardless of its value, cancelling its pending expiry, and promotes an
+  // overflow order into the freed slot, then tells the order's listener, if
+  // any, that it left for |reason|. Returns nullptr if no such order is held.
+  std::unique_ptr<Order> RemoveOrder(const OrderId& order_id,
+                                     RemovalReason reason, absl::Time at_time);
+  std::unique_ptr<Order> RemoveOrder(OrderMap::iterator it,
+                                     RemovalReason reason, absl::Time at_time);
+
+  // Fired by the scheduler once |order|'s shelf life is up. Only runs while
+  // the order is held, since removing it cancels the expiry.
+  void ExpireOrder(Order* order);
 
-  // Attempts to move a single order (first possible option taken)
-  // from the overflow shelf to the shelf matching its temperature group.
-  // Failing that, an order is randomly discarded.
-  void MakeOverflowRoom();
+  // Places |order| on the overflow shelf and in its temperature's bucket.
+  // Returns false if the overflow shelf is full.
+  bool AddToOverflow(Order* order);
+  void RemoveFromOverflow(Order* order);
+
+  // Moves an overflow order of |temp| to its temperature shelf if that has
+  // room. Returns whether one was moved.
+  bool PromoteFromOverflow(TemperatureType temp, absl::Time at_time);
+
+  // Attempts to move a single order from the overflow shelf to the shelf
+  // matching its temperature group. Failing that, the eviction policy picks an
+  // order to discard.
+  void MakeOverflowRoom(absl::Time at_time);
+
+  // Calls LogShelves() if |options_.shelf_log_interval| has passed since the
+  // last dump.
+  void MaybeLogShelves(absl::Time at_time);
+
+  // The kitchen's metrics in |options_.metrics|.
+  struct Metrics {
+    Metrics(MetricsRegistry* registry, const std::string& kitchen);
+
+    // Mirror Stats, but can be read from any thread.
+    Counter* received;
+    Counter* delivered;
+    Counter* expired;
+    Counter* discarded;
+    Counter* overflowed;
+    Counter* moved_from_overflow;
+    Gauge* overflow_orders;
+    // Simulated milliseconds from cooked until picked up.
+    Histogram* shelf_time_ms;
+    // Wall time spent in each call, per order for TakeOrders().
+    Histogram* take_order_ns;
+    Histogram* pickup_order_ns;
+    Histogram* make_overflow_room_ns;
+  };
 
   const Options options_;
+  EventSink* const event_sink_;
+  // Cached |event_sink_->IsEnabled()|, checked before building each event.
+  const bool record_events_;
+  // Null unless |options_.metrics| is set.
+  std::unique_ptr<Metrics> metrics_;
+  absl::Time last_shelf_log_ = absl::InfinitePast();
 
-  // Index from temperature group to shelf (excludes overflow shelf).
-  std::unordered_map<TemperatureType, std::unique_ptr<Shelf>> shelves_;
-  Shelf overflow_shelf_;
+  // Every shelf's slots, back to back in shelf order, so the shelves take a
+  // single allocation and neighbouring shelves share cache lines.
+  std::unique_ptr<Order*[]> slots_;
+  // Indexed by shelf index; empty where the kitchen has no such shelf. Held
+  // inline, so reaching a shelf costs no more than indexing.
+  std::array<std::optional<Shelf>, kShelfCount> shelves_;
 
   // Order bookkeeping.
-  std::unordered_map<absl::string_view, std::unique_ptr<Order>>
-      orders_;  // Indexed by ID
-  std::unordered_map<absl::string_view, Shelf*>
-      order_to_shelf_;  // Indexed by ID
+  // Reserved for every shelf slot, so it doesn't allocate once warm.
+  OrderMap orders_;  // Indexed by ID
+
+  // Overflow orders indexed by TemperatureType, so promotion never scans the
+  // overflow shelf. Unordered.
+  std::array<std::vector<Order*>, kOverflowShelf> overflow_buckets_;
+
+  // Told about every order placed on or taken off the overflow shelf.
+  std::unique_ptr<EvictionPolicy> eviction_policy_;
+
+  Stats stats_;
 
-  std::mt19937 rand_;
+  // Results of the TakeOrders() call in progress, if any.
+  std::vector<Order*>* taking_ = nullptr;
 
-  // ASIO bookkeeping.
-  boost::asio::io_context& context_;
-  boost::asio::io_context::strand strand_;
+  // Set when the kitchen was handed an io_context rather than a scheduler.
+  std::unique_ptr<Scheduler> owned_scheduler_;
+  Scheduler* scheduler_;
 };
 
 }  // namespace kitchen_sim
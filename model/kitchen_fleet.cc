@@ -0,0 +1,62 @@
+#include "model/kitchen_fleet.h"
+
+#include <functional>
+
+#include "absl/strings/str_cat.h"
+
+namespace kitchen_sim {
+
+KitchenFleet::KitchenFleet(const Options& options,
+                           const std::vector<Scheduler*>& schedulers)
+    : routing_(options.routing) {
+  if (options.kitchens.empty()) {
+    throw std::invalid_argument("A fleet needs at least one kitchen!");
+  }
+  if (options.kitchens.size() != schedulers.size()) {
+    throw std::invalid_argument(
+        "Fleets need exactly one scheduler per kitchen!");
+  }
+  for (size_t i = 0; i < options.kitchens.size(); ++i) {
+    kitchens_.push_back(
+        std::make_unique<Kitchen>(options.kitchens[i], schedulers[i]));
+  }
+}
+
+size_t KitchenFleet::Route(const Order& order) {
+  // std::hash rather than absl::Hash, which is salted per process and would
+  // route differently from run to run.
+  switch (routing_) {
+    case RoutingType::ROUND_ROBIN:
+      return next_kitchen_.fetch_add(1, std::memory_order_relaxed) %
+             kitchens_.size();
+    case RoutingType::REGION:
+      if (!order.region_.empty()) {
+        return std::hash<std::string>()(order.region_) % kitchens_.size();
+      }
+      break;
+    case RoutingType::ID_HASH:
+      break;
+  }
+  return order.id_.Hash() % kitchens_.size();
+}
+
+Kitchen::Stats KitchenFleet::AggregateStats() const {
+  Kitchen::Stats total;
+  for (const auto& kitchen : kitchens_) {
+    total += kitchen->GetStats();
+  }
+  return total;
+}
+
+std::string StatsMessage(absl::string_view name, const Kitchen::Stats& stats) {
+  return absl::StrCat("[ kitchen: ", name, " | received: ", stats.received,
+                      " | delivered: ", stats.delivered,
+                      " | expired: ", stats.expired,
+                      " | discarded: ", stats.discarded,
+                      " | waste_rate: ", stats.WasteRate(),
+                      " | overflowed: ", stats.overflowed,
+                      " | moved_from_overflow: ", stats.moved_from_overflow,
+                      " | delivered_value: ", stats.delivered_value, " ]");
+}
+
+}  // namespace kitchen_sim
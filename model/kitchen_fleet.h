@@ -0,0 +1,63 @@
+#ifndef KITCHEN_SIM_KITCHEN_FLEET_H_
+#define KITCHEN_SIM_KITCHEN_FLEET_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "model/kitchen.h"
+#include "model/order.h"
+#include "runtime/scheduler.h"
+
+namespace kitchen_sim {
+
+// How orders are assigned to kitchens within a fleet.
+enum class RoutingType {
+  // Hash of the order ID; spreads load evenly and is stable across runs.
+  ID_HASH,
+  // Hash of the order's region, falling back to its ID when it has none.
+  REGION,
+  // Kitchens take turns in arrival order.
+  ROUND_ROBIN
+};
+
+// A group of independent kitchens sharing one order stream. Each kitchen runs
+// on its own scheduler so kitchens can make progress in parallel; the fleet
+// itself only decides which kitchen an order goes to.
+class KitchenFleet {
+ public:
+  struct Options {
+    std::vector<Kitchen::Options> kitchens;
+    RoutingType routing = RoutingType::ID_HASH;
+  };
+
+  // |schedulers| holds one scheduler per kitchen, each of which must outlive
+  // the fleet.
+  KitchenFleet(const Options& options,
+               const std::vector<Scheduler*>& schedulers);
+  KitchenFleet(KitchenFleet const&) = delete;
+  KitchenFleet& operator=(KitchenFleet const&) = delete;
+
+  // Returns the index of the kitchen |order| should be sent to. Thread-safe.
+  size_t Route(const Order& order);
+
+  size_t size() const { return kitchens_.size(); }
+  Kitchen& At(size_t index) { return *kitchens_[index]; }
+  const Kitchen& At(size_t index) const { return *kitchens_[index]; }
+
+  // Sum of all kitchens' stats. Only safe once every kitchen is idle.
+  Kitchen::Stats AggregateStats() const;
+
+ private:
+  const RoutingType routing_;
+  std::vector<std::unique_ptr<Kitchen>> kitchens_;
+  std::atomic<size_t> next_kitchen_{0};  // For ROUND_ROBIN.
+};
+
+// One-line summary of |stats| for reports.
+std::string StatsMessage(absl::string_view name, const Kitchen::Stats& stats);
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_KITCHEN_FLEET_H_
@@ -0,0 +1,78 @@
+#include "model/kitchen_fleet.h"
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+
+KitchenFleet::Options FleetOptions(int kitchen_count, RoutingType routing) {
+  KitchenFleet::Options options;
+  for (int i = 0; i < kitchen_count; ++i) {
+    options.kitchens.push_back({absl::StrCat("test ", i)});
+  }
+  options.routing = routing;
+  return options;
+}
+
+std::unique_ptr<Order> TestOrder(const std::string& id,
+                                 const std::string& region = "") {
+  auto order = Order::CreateOrder(id, "pho", TemperatureType::HOT, 300, 0.5,
+                                  absl::UnixEpoch());
+  order->region_ = region;
+  return order;
+}
+
+TEST(KitchenFleetTest, RoundRobin) {
+  VirtualScheduler scheduler;
+  KitchenFleet fleet(FleetOptions(3, RoutingType::ROUND_ROBIN),
+                     {&scheduler, &scheduler, &scheduler});
+  auto order = TestOrder("1");
+  EXPECT_EQ(fleet.Route(*order), 0);
+  EXPECT_EQ(fleet.Route(*order), 1);
+  EXPECT_EQ(fleet.Route(*order), 2);
+  EXPECT_EQ(fleet.Route(*order), 0);
+}
+
+TEST(KitchenFleetTest, IdHashIsStable) {
+  VirtualScheduler scheduler;
+  KitchenFleet fleet(FleetOptions(4, RoutingType::ID_HASH),
+                     {&scheduler, &scheduler, &scheduler, &scheduler});
+  auto order = TestOrder("d3c1b9f0");
+  const size_t kitchen = fleet.Route(*order);
+  EXPECT_LT(kitchen, 4);
+  EXPECT_EQ(fleet.Route(*order), kitchen);
+}
+
+TEST(KitchenFleetTest, RegionRouting) {
+  VirtualScheduler scheduler;
+  KitchenFleet fleet(FleetOptions(4, RoutingType::REGION),
+                     {&scheduler, &scheduler, &scheduler, &scheduler});
+  // Same region, same kitchen, whatever the ID.
+  EXPECT_EQ(fleet.Route(*TestOrder("1", "SoMa")),
+            fleet.Route(*TestOrder("2", "SoMa")));
+  // No region falls back to the ID.
+  EXPECT_EQ(fleet.Route(*TestOrder("3")),
+            KitchenFleet(FleetOptions(4, RoutingType::ID_HASH),
+                         {&scheduler, &scheduler, &scheduler, &scheduler})
+                .Route(*TestOrder("3")));
+}
+
+TEST(KitchenFleetTest, AggregateStats) {
+  VirtualScheduler scheduler;
+  KitchenFleet fleet(FleetOptions(2, RoutingType::ROUND_ROBIN),
+                     {&scheduler, &scheduler});
+  for (const std::string id : {"1", "2", "3"}) {
+    auto order = TestOrder(id);
+    fleet.At(fleet.Route(*order))
+        .TakeOrder(std::move(order), absl::UnixEpoch());
+  }
+  fleet.At(0).PickupOrder("1", absl::UnixEpoch());
+
+  EXPECT_EQ(fleet.At(0).GetStats().received, 2);
+  EXPECT_EQ(fleet.At(1).GetStats().received, 1);
+  EXPECT_EQ(fleet.AggregateStats().received, 3);
+  EXPECT_EQ(fleet.AggregateStats().delivered, 1);
+  EXPECT_DOUBLE_EQ(fleet.AggregateStats().delivered_value, 1.);
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,78 @@
+#include "model/kitchen_intake.h"
+
+#include <stdexcept>
+
+namespace kitchen_sim {
+
+KitchenIntake::KitchenIntake(Kitchen* kitchen, Options options)
+    : kitchen_(kitchen),
+      options_(std::move(options)),
+      queue_(options_.capacity) {
+  if (options_.max_batch == 0) {
+    throw std::invalid_argument("KitchenIntake batches must not be empty!");
+  }
+  batch_.reserve(options_.max_batch);
+}
+
+bool KitchenIntake::TrySubmit(std::unique_ptr<Order>* order) {
+  if (!queue_.TryPush(std::move(*order))) {
+    rejected_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  // Pairs with the fence in Drain(): either the drain sees this order, or
+  // this sees that the drain has finished and schedules another.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  MaybeScheduleDrain();
+  return true;
+}
+
+void KitchenIntake::MaybeScheduleDrain() {
+  if (drain_scheduled_.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  if (options_.post_drain) {
+    options_.post_drain([this] { Drain(); });
+    return;
+  }
+  Scheduler& scheduler = kitchen_->GetScheduler();
+  scheduler.ScheduleAt(scheduler.Now(), [this] { Drain(); });
+}
+
+void KitchenIntake::Drain() {
+  const absl::Time now = kitchen_->GetScheduler().Now();
+  std::unique_ptr<Order> order;
+  while (batch_.size() < options_.max_batch && queue_.TryPop(&order)) {
+    kitchen_->RecordEvent(EventType::RECEIVED, *order, now);
+    batch_.push_back(std::move(order));
+  }
+  std::vector<Order*> taken;
+  try {
+    if (options_.cooking_line != nullptr) {
+      options_.cooking_line->Cook(absl::MakeSpan(batch_));
+    } else {
+      taken = kitchen_->TakeOrders(absl::MakeSpan(batch_), now);
+    }
+  } catch (...) {
+    // Neither takes any of the batch when it throws. Drop it rather than
+    // leave it for the next drain, which later submissions still schedule.
+    batch_.clear();
+    drain_scheduled_.store(false, std::memory_order_release);
+    throw;
+  }
+  batch_.clear();
+  if (options_.on_taken) {
+    for (Order* order : taken) {
+      // Null if discarded to make room for a later order in the batch.
+      if (order != nullptr) {
+        options_.on_taken(order);
+      }
+    }
+  }
+  drain_scheduled_.store(false, std::memory_order_release);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (queue_.SizeApprox() > 0) {
+    MaybeScheduleDrain();
+  }
+}
+
+}  // namespace kitchen_sim
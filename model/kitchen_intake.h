@@ -0,0 +1,87 @@
+#ifndef KITCHEN_SIM_KITCHEN_INTAKE_H_
+#define KITCHEN_SIM_KITCHEN_INTAKE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "model/cooking_line.h"
+#include "model/kitchen.h"
+#include "model/order.h"
+#include "runtime/bounded_queue.h"
+#include "runtime/scheduler.h"
+
+namespace kitchen_sim {
+
+// Bounded, lock-free queue of orders in front of a Kitchen. Any number of
+// threads may submit orders concurrently; the kitchen drains them in batches
+// on its own scheduler, so orders are only ever placed on shelves from there.
+//
+// Submitting never blocks. When the queue is full the order is handed back,
+// leaving the producer to retry, shed or slow down.
+class KitchenIntake {
+ public:
+  struct Options {
+    // Must be a power of two.
+    size_t capacity = 1024;
+    // Orders placed per scheduled drain. Larger batches amortize scheduling;
+    // smaller ones let the kitchen's other handlers (e.g. expiry) interleave.
+    size_t max_batch = 64;
+    // Called on the kitchen's scheduler with each order once it is shelved,
+    // unless a later order in the same batch had it discarded.
+    std::function<void(Order*)> on_taken;
+    // Runs a drain on the kitchen's thread as soon as possible, called from
+    // whichever thread submitted. Unset, drains are scheduled on the kitchen's
+    // scheduler directly, which must then take handlers from any thread.
+    std::function<void(Scheduler::Handler)> post_drain;
+    // If set, drained orders queue for its cooking stations rather than being
+    // shelved straight away, and the line's |on_cooked| takes the place of
+    // |on_taken|. Must run on the kitchen's scheduler and outlive the intake.
+    CookingLine* cooking_line = nullptr;
+  };
+
+  // |kitchen| must outlive the intake. Drains are scheduled on the kitchen's
+  // scheduler, so with a VirtualScheduler every submission must come from the
+  // thread running it.
+  KitchenIntake(Kitchen* kitchen, Options options);
+  KitchenIntake(KitchenIntake const&) = delete;
+  KitchenIntake& operator=(KitchenIntake const&) = delete;
+
+  // Queues |*order| for the kitchen. Thread-safe. Returns false if the queue is
+  // full, in which case |*order| is left untouched.
+  bool TrySubmit(std::unique_ptr<Order>* order);
+
+  // Number of times TrySubmit() found the queue full.
+  uint64_t RejectedCount() const {
+    return rejected_.load(std::memory_order_relaxed);
+  }
+
+  // Approximate while orders are being submitted or drained.
+  size_t SizeApprox() const { return queue_.SizeApprox(); }
+
+  Kitchen& GetKitchen() { return *kitchen_; }
+
+ private:
+  // Schedules a drain unless one is already pending.
+  void MaybeScheduleDrain();
+
+  // Places up to |options_.max_batch| queued orders with a single
+  // Kitchen::TakeOrders() call, or hands them to the cooking line. Runs on the
+  // kitchen's scheduler.
+  void Drain();
+
+  Kitchen* const kitchen_;
+  const Options options_;
+  BoundedQueue<std::unique_ptr<Order>> queue_;
+  // Orders popped for the drain in progress. Only used from Drain().
+  std::vector<std::unique_ptr<Order>> batch_;
+  // Set from when a drain is scheduled until it has emptied the queue.
+  std::atomic<bool> drain_scheduled_{false};
+  std::atomic<uint64_t> rejected_{0};
+};
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_KITCHEN_INTAKE_H_
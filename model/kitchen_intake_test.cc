@@ -0,0 +1,209 @@
+#include "model/kitchen_intake.h"
+
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+#include "runtime/scheduler.h"
+#include "runtime/timing_wheel.h"
+
+namespace kitchen_sim {
+
+std::unique_ptr<Order> TestOrder(const std::string& id) {
+  return Order::CreateOrder(id, "ramen", TemperatureType::HOT, 300, 0.5,
+                            absl::UnixEpoch());
+}
+
+// Counts orders placed on shelves, whether or not they were later discarded.
+class CookedCountingSink : public EventSink {
+ public:
+  void Record(const Event& event, const Order& order) override {
+    if (event.type == EventType::COOKED) {
+      ++cooked;
+    }
+  }
+
+  std::atomic<int> cooked{0};
+};
+
+TEST(KitchenIntakeTest, DrainsOnKitchenScheduler) {
+  VirtualScheduler scheduler;
+  Kitchen kitchen({"test"}, &scheduler);
+  std::vector<Order*> taken;
+  KitchenIntake intake(&kitchen, {8, 64, [&](Order* order) {
+                                    taken.push_back(order);
+                                  }});
+
+  for (int i = 0; i < 3; ++i) {
+    auto order = TestOrder(absl::StrCat(i));
+    EXPECT_TRUE(intake.TrySubmit(&order));
+    EXPECT_EQ(order, nullptr);
+  }
+  EXPECT_EQ(kitchen.GetStats().received, 0);
+  EXPECT_EQ(intake.SizeApprox(), 3);
+
+  scheduler.RunUntil(scheduler.Now());
+  EXPECT_EQ(kitchen.GetStats().received, 3);
+  ASSERT_EQ(taken.size(), 3);
+  EXPECT_EQ(taken[0]->id_.ToString(), "0");
+  EXPECT_EQ(taken[2]->id_.ToString(), "2");
+  EXPECT_TRUE(kitchen.TemperatureShelf(TemperatureType::HOT).Holds(*taken[1]));
+}
+
+TEST(KitchenIntakeTest, PostsDrainsWhenAsked) {
+  VirtualScheduler scheduler;
+  Kitchen kitchen({"test"}, &scheduler);
+  std::vector<Scheduler::Handler> posted;
+  KitchenIntake::Options options = {8, 64};
+  options.post_drain = [&](Scheduler::Handler drain) {
+    posted.push_back(std::move(drain));
+  };
+  KitchenIntake intake(&kitchen, std::move(options));
+
+  for (int i = 0; i < 3; ++i) {
+    auto order = TestOrder(absl::StrCat(i));
+    EXPECT_TRUE(intake.TrySubmit(&order));
+  }
+  // One drain for the lot, and nothing on the kitchen's scheduler.
+  ASSERT_EQ(posted.size(), 1);
+  EXPECT_EQ(scheduler.PendingCount(), 0);
+
+  posted[0]();
+  EXPECT_EQ(kitchen.GetStats().received, 3);
+  EXPECT_EQ(intake.SizeApprox(), 0);
+}
+
+TEST(KitchenIntakeTest, HandsOrdersToCookingLine) {
+  VirtualScheduler scheduler;
+  Kitchen kitchen({"test"}, &scheduler);
+  std::vector<Order*> cooked;
+  CookingLine::Options cooking;
+  cooking.stations = {0, 1, 1, 1};
+  cooking.default_prep_time = absl::Seconds(2);
+  cooking.on_cooked = [&](Order* order) { cooked.push_back(order); };
+  CookingLine line(cooking, &kitchen);
+  KitchenIntake::Options options = {8, 64};
+  options.cooking_line = &line;
+  KitchenIntake intake(&kitchen, std::move(options));
+
+  for (int i = 0; i < 2; ++i) {
+    auto order = TestOrder(absl::StrCat(i));
+    ASSERT_TRUE(intake.TrySubmit(&order));
+  }
+  scheduler.RunUntil(scheduler.Now());
+  EXPECT_EQ(kitchen.GetStats().received, 0);
+  EXPECT_EQ(line.QueueDepth(TemperatureType::HOT), 1);
+
+  scheduler.RunUntil(absl::UnixEpoch() + absl::Seconds(4));
+  EXPECT_EQ(kitchen.GetStats().received, 2);
+  EXPECT_EQ(cooked.size(), 2);
+}
+
+TEST(KitchenIntakeTest, DropsBatchWithOrderNoStationCanCook) {
+  VirtualScheduler scheduler;
+  KitchenLayout layout = kLargeKitchenLayout;
+  layout.SetShelfCapacity(TemperatureType::FROZEN, KitchenLayout::kNoShelf);
+  Kitchen kitchen({"test", layout}, &scheduler);
+  CookingLine::Options cooking;
+  cooking.stations = {0, 0, 1, 1};
+  CookingLine line(cooking, &kitchen);
+  KitchenIntake::Options options = {8, 64};
+  options.cooking_line = &line;
+  KitchenIntake intake(&kitchen, std::move(options));
+
+  auto hot = TestOrder("1");
+  auto frozen = Order::CreateOrder("2", "ice cream", TemperatureType::FROZEN,
+                                   300, 0.5, absl::UnixEpoch());
+  ASSERT_TRUE(intake.TrySubmit(&hot));
+  ASSERT_TRUE(intake.TrySubmit(&frozen));
+  EXPECT_THROW(scheduler.RunUntil(scheduler.Now()), std::invalid_argument);
+  EXPECT_EQ(line.GetStats(TemperatureType::HOT).orders, 0);
+
+  // The next drain starts from an empty batch.
+  auto next = TestOrder("3");
+  ASSERT_TRUE(intake.TrySubmit(&next));
+  scheduler.RunUntil(scheduler.Now());
+  EXPECT_EQ(line.GetStats(TemperatureType::HOT).orders, 1);
+}
+
+TEST(KitchenIntakeTest, DrainsEverythingAcrossBatches) {
+  VirtualScheduler scheduler;
+  Kitchen kitchen({"test"}, &scheduler);
+  KitchenIntake intake(&kitchen, {16, /*max_batch=*/2});
+  for (int i = 0; i < 5; ++i) {
+    auto order = TestOrder(absl::StrCat(i));
+    ASSERT_TRUE(intake.TrySubmit(&order));
+  }
+  scheduler.RunUntil(scheduler.Now());
+  EXPECT_EQ(kitchen.GetStats().received, 5);
+  EXPECT_EQ(intake.SizeApprox(), 0);
+
+  // A drained intake schedules a fresh drain for the next submission.
+  auto order = TestOrder("5");
+  ASSERT_TRUE(intake.TrySubmit(&order));
+  scheduler.RunUntil(scheduler.Now());
+  EXPECT_EQ(kitchen.GetStats().received, 6);
+}
+
+TEST(KitchenIntakeTest, FullQueueHandsOrderBack) {
+  VirtualScheduler scheduler;
+  Kitchen kitchen({"test"}, &scheduler);
+  KitchenIntake intake(&kitchen, {/*capacity=*/2});
+  auto first = TestOrder("1");
+  auto second = TestOrder("2");
+  auto third = TestOrder("3");
+  ASSERT_TRUE(intake.TrySubmit(&first));
+  ASSERT_TRUE(intake.TrySubmit(&second));
+
+  EXPECT_FALSE(intake.TrySubmit(&third));
+  ASSERT_NE(third, nullptr);
+  EXPECT_EQ(third->id_.ToString(), "3");
+  EXPECT_EQ(intake.RejectedCount(), 1);
+
+  scheduler.RunUntil(scheduler.Now());
+  EXPECT_TRUE(intake.TrySubmit(&third));
+  scheduler.RunUntil(scheduler.Now());
+  EXPECT_EQ(kitchen.GetStats().received, 3);
+}
+
+TEST(KitchenIntakeTest, ConcurrentProducers) {
+  constexpr int kProducers = 4;
+  constexpr int kOrdersPerProducer = 500;
+  boost::asio::io_context context;
+  auto work = boost::asio::make_work_guard(context);
+  TimingWheel scheduler(context);
+  CookedCountingSink sink;
+  Kitchen::Options options = {"test"};
+  options.event_sink = &sink;
+  options.shelf_log_interval = absl::InfiniteDuration();
+  Kitchen kitchen(options, &scheduler);
+  KitchenIntake intake(&kitchen, {64, 16});
+  std::thread consumer([&] { context.run(); });
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&, p] {
+      for (int i = 0; i < kOrdersPerProducer; ++i) {
+        auto order = TestOrder(absl::StrCat(p, "-", i));
+        while (!intake.TrySubmit(&order)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  while (sink.cooked.load() < kProducers * kOrdersPerProducer) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  context.stop();
+  consumer.join();
+
+  EXPECT_EQ(kitchen.GetStats().received, kProducers * kOrdersPerProducer);
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,91 @@
+#ifndef KITCHEN_SIM_KITCHEN_LAYOUT_H_
+#define KITCHEN_SIM_KITCHEN_LAYOUT_H_
+
+#include <array>
+#include <optional>
+
+#include "absl/strings/string_view.h"
+#include "model/order.h"
+
+namespace kitchen_sim {
+
+// Number of TemperatureType values, UNKNOWN included.
+constexpr int kTemperatureCount = static_cast<int>(TemperatureType::HOT) + 1;
+
+// Shelf capacities of a kitchen. A plain array indexed by temperature, so the
+// predefined layouts below are compile-time constants, checked as they are
+// defined, and a kitchen sizes its shelves without hashing or allocating.
+struct KitchenLayout {
+  // Capacity of a temperature the kitchen has no shelf for, whose orders it
+  // rejects. Unlike a zero capacity, which sends them all to overflow.
+  static constexpr int kNoShelf = -1;
+
+  // |overflow_capacity|, and |shelf_capacity| for every temperature.
+  static constexpr KitchenLayout Uniform(int overflow_capacity,
+                                         int shelf_capacity) {
+    KitchenLayout layout;
+    layout.overflow_capacity = overflow_capacity;
+    for (TemperatureType temp : {TemperatureType::FROZEN, TemperatureType::COLD,
+                                 TemperatureType::HOT}) {
+      layout.SetShelfCapacity(temp, shelf_capacity);
+    }
+    return layout;
+  }
+
+  constexpr bool HasShelf(TemperatureType temp) const {
+    return ShelfCapacity(temp) != kNoShelf;
+  }
+  constexpr int ShelfCapacity(TemperatureType temp) const {
+    return shelf_capacities[static_cast<int>(temp)];
+  }
+  constexpr void SetShelfCapacity(TemperatureType temp, int capacity) {
+    shelf_capacities[static_cast<int>(temp)] = capacity;
+  }
+
+  // Orders the kitchen holds when full, overflow included.
+  constexpr int TotalCapacity() const {
+    int total = overflow_capacity;
+    for (int capacity : shelf_capacities) {
+      total += capacity == kNoShelf ? 0 : capacity;
+    }
+    return total;
+  }
+
+  // Whether every capacity is non-negative, UNKNOWN having no shelf.
+  constexpr bool IsValid() const {
+    if (overflow_capacity < 0 || HasShelf(TemperatureType::UNKNOWN)) {
+      return false;
+    }
+    for (int capacity : shelf_capacities) {
+      if (capacity < kNoShelf) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  int overflow_capacity = 0;
+  // Indexed by TemperatureType.
+  std::array<int, kTemperatureCount> shelf_capacities = {kNoShelf, kNoShelf,
+                                                         kNoShelf, kNoShelf};
+};
+
+constexpr KitchenLayout kSmallKitchenLayout = KitchenLayout::Uniform(6, 4);
+constexpr KitchenLayout kLargeKitchenLayout = KitchenLayout::Uniform(15, 10);
+static_assert(kSmallKitchenLayout.IsValid() && kLargeKitchenLayout.IsValid(),
+              "Predefined kitchen layouts must be valid");
+
+// The predefined layout for kitchen size |name|, "SMALL" or "LARGE".
+inline std::optional<KitchenLayout> FindKitchenLayout(absl::string_view name) {
+  if (name == "SMALL") {
+    return kSmallKitchenLayout;
+  }
+  if (name == "LARGE") {
+    return kLargeKitchenLayout;
+  }
+  return std::nullopt;
+}
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_KITCHEN_LAYOUT_H_
@@ -0,0 +1,42 @@
+#include "model/kitchen_layout.h"
+
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+namespace {
+
+TEST(KitchenLayoutTest, FindsPredefinedLayouts) {
+  ASSERT_TRUE(FindKitchenLayout("SMALL").has_value());
+  EXPECT_EQ(FindKitchenLayout("SMALL")->overflow_capacity, 6);
+  EXPECT_EQ(FindKitchenLayout("SMALL")->ShelfCapacity(TemperatureType::HOT),
+            4);
+  ASSERT_TRUE(FindKitchenLayout("LARGE").has_value());
+  EXPECT_EQ(FindKitchenLayout("LARGE")->TotalCapacity(), 45);
+  EXPECT_FALSE(FindKitchenLayout("MEDIUM").has_value());
+}
+
+TEST(KitchenLayoutTest, LeavesUnsetTemperaturesWithoutShelves) {
+  KitchenLayout layout;
+  layout.overflow_capacity = 2;
+  layout.SetShelfCapacity(TemperatureType::HOT, 3);
+  layout.SetShelfCapacity(TemperatureType::COLD, 0);
+  EXPECT_TRUE(layout.IsValid());
+  EXPECT_TRUE(layout.HasShelf(TemperatureType::HOT));
+  EXPECT_TRUE(layout.HasShelf(TemperatureType::COLD));
+  EXPECT_FALSE(layout.HasShelf(TemperatureType::FROZEN));
+  EXPECT_EQ(layout.TotalCapacity(), 5);
+}
+
+TEST(KitchenLayoutTest, RejectsInvalidLayouts) {
+  KitchenLayout negative_overflow = KitchenLayout::Uniform(-1, 1);
+  EXPECT_FALSE(negative_overflow.IsValid());
+  KitchenLayout negative_shelf = KitchenLayout::Uniform(1, 1);
+  negative_shelf.SetShelfCapacity(TemperatureType::COLD, -2);
+  EXPECT_FALSE(negative_shelf.IsValid());
+  KitchenLayout unknown_shelf = KitchenLayout::Uniform(1, 1);
+  unknown_shelf.SetShelfCapacity(TemperatureType::UNKNOWN, 1);
+  EXPECT_FALSE(unknown_shelf.IsValid());
+}
+
+}  // namespace
+}  // namespace kitchen_sim
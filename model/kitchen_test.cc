@@ -1,17 +1,70 @@
 #include "model/kitchen.h"
 
+#include "absl/strings/str_cat.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "runtime/scheduler.h"
 
 namespace kitchen_sim {
 
+// Keeps the type and order ID of every event.
+class RecordingEventSink : public EventSink {
+ public:
+  void Record(const Event& event, const Order& order) override {
+    events_.push_back(
+        absl::StrCat(EventTypeName(event.type), " ", order.id_.ToString(),
+                     event.overflow ? " (overflow)" : ""));
+  }
+
+  const std::vector<std::string>& Events() const { return events_; }
+
+ private:
+  std::vector<std::string> events_;
+};
+
+// Two hot slots, one cold and three overflow, with no frozen shelf.
+KitchenLayout HotAndColdLayout() {
+  KitchenLayout layout;
+  layout.overflow_capacity = 3;
+  layout.SetShelfCapacity(TemperatureType::HOT, 2);
+  layout.SetShelfCapacity(TemperatureType::COLD, 1);
+  return layout;
+}
+
 Kitchen BarebonesKitchen(boost::asio::io_context& context) {
-  return Kitchen({"test",
-                  1,
-                  {{TemperatureType::HOT, 1},
-                   {TemperatureType::COLD, 1},
-                   {TemperatureType::FROZEN, 1}}},
-                 context);
+  return Kitchen({"test", KitchenLayout::Uniform(1, 1)}, context);
+}
+
+Kitchen BarebonesKitchen(Scheduler* scheduler) {
+  return Kitchen({"test", KitchenLayout::Uniform(1, 1)}, scheduler);
+}
+
+TEST(ShelfTest, RemoveKeepsSlotsDense) {
+  Order* slots[3];
+  Kitchen::Shelf shelf(/*index=*/1, slots, /*max_capacity=*/3,
+                       /*decay_modifier=*/1);
+  auto tea = Order::CreateOrder("1", "tea", TemperatureType::COLD, 300, 0.5,
+                                absl::UnixEpoch());
+  auto soda = Order::CreateOrder("2", "soda", TemperatureType::COLD, 300, 0.5,
+                                 absl::UnixEpoch());
+  auto juice = Order::CreateOrder("3", "juice", TemperatureType::COLD, 300,
+                                  0.5, absl::UnixEpoch());
+  EXPECT_TRUE(shelf.AddOrder(tea.get()));
+  EXPECT_TRUE(shelf.AddOrder(soda.get()));
+  EXPECT_TRUE(shelf.AddOrder(juice.get()));
+  EXPECT_TRUE(shelf.AtCapacity());
+
+  shelf.RemoveOrder(tea.get());
+  EXPECT_FALSE(shelf.Holds(*tea));
+  EXPECT_THAT(shelf.Orders(), testing::ElementsAre(juice.get(), soda.get()));
+
+  // Removing an order twice is a no-op. Moved orders are found in their new
+  // slots.
+  shelf.RemoveOrder(tea.get());
+  shelf.RemoveOrder(juice.get());
+  EXPECT_THAT(shelf.Orders(), testing::ElementsAre(soda.get()));
+  shelf.RemoveOrder(soda.get());
+  EXPECT_TRUE(shelf.Orders().empty());
 }
 
 TEST(KitchenTest, TakeOrderUnknownTemperatureType) {
@@ -25,11 +78,11 @@ TEST(KitchenTest, TakeOrderUnknownTemperatureType) {
 TEST(KitchenTest, TakeOrderFulfillmentTimeRecorded) {
   boost::asio::io_context context;
   Kitchen kitchen({"test"}, context);
-  auto future = kitchen.TakeOrder(
+  auto taken = kitchen.TakeOrder(
       Order::CreateOrder("1", "ice cream", TemperatureType::COLD, 300, 0.5,
                          absl::UnixEpoch()),
       absl::UnixEpoch());
-  auto order = future.get();
+  auto order = taken.Get();
   EXPECT_EQ(order->FulfillmentTime().value(), absl::UnixEpoch());
 }
 
@@ -42,8 +95,8 @@ TEST(KitchenTest, TakeOrderOverflowUsed) {
                                  absl::UnixEpoch());
 
   const Order* overflow = soda.get();
-  kitchen.TakeOrder(std::move(tea)).wait();
-  kitchen.TakeOrder(std::move(soda)).wait();
+  kitchen.TakeOrder(std::move(tea)).Wait();
+  kitchen.TakeOrder(std::move(soda)).Wait();
 
   EXPECT_THAT(kitchen.OverflowShelf().Orders(), testing::ElementsAre(overflow));
 }
@@ -61,14 +114,14 @@ TEST(KitchenTest, TakeOrderOverflowRoomMade) {
   auto pizza = Order::CreateOrder("4", "pizza", TemperatureType::HOT, 300, 0.5,
                                   absl::UnixEpoch());
 
-  const std::string tea_id = tea->id_;
+  const OrderId tea_id = tea->id_;
   const Order* burger_ptr = burger.get();
   const Order* pizza_ptr = pizza.get();
-  kitchen.TakeOrder(std::move(tea)).wait();
-  kitchen.TakeOrder(std::move(soda)).wait();  // Moved to overflow.
-  kitchen.PickupOrder(tea_id);
-  kitchen.TakeOrder(std::move(burger)).wait();
-  kitchen.TakeOrder(std::move(pizza)).wait();  // Soda gets moved back.
+  kitchen.TakeOrder(std::move(tea)).Wait();
+  kitchen.TakeOrder(std::move(soda)).Wait();  // Moved to overflow.
+  kitchen.PickupOrder(tea_id);  // Soda moves to the freed cold slot.
+  kitchen.TakeOrder(std::move(burger)).Wait();
+  kitchen.TakeOrder(std::move(pizza)).Wait();
 
   EXPECT_THAT(kitchen.TemperatureShelf(TemperatureType::HOT).Orders(),
               testing::ElementsAre(burger_ptr));
@@ -88,9 +141,9 @@ TEST(KitchenTest, TakeOrderOverflowDiscarded) {
 
   const Order* tea_ptr = tea.get();
   const Order* juice_ptr = juice.get();
-  kitchen.TakeOrder(std::move(tea)).wait();
-  kitchen.TakeOrder(std::move(soda)).wait();
-  kitchen.TakeOrder(std::move(juice)).wait();  // Removes soda.
+  kitchen.TakeOrder(std::move(tea)).Wait();
+  kitchen.TakeOrder(std::move(soda)).Wait();
+  kitchen.TakeOrder(std::move(juice)).Wait();  // Removes soda.
 
   EXPECT_THAT(kitchen.TemperatureShelf(TemperatureType::COLD).Orders(),
               testing::ElementsAre(tea_ptr));
@@ -98,6 +151,45 @@ TEST(KitchenTest, TakeOrderOverflowDiscarded) {
               testing::ElementsAre(juice_ptr));
 }
 
+TEST(KitchenTest, TakeOrdersBatch) {
+  VirtualScheduler scheduler(absl::UnixEpoch());
+  Kitchen kitchen = BarebonesKitchen(&scheduler);
+  std::vector<std::unique_ptr<Order>> orders;
+  for (const std::string id : {"1", "2", "3", "4"}) {
+    orders.push_back(Order::CreateOrder(id, "tea", TemperatureType::COLD, 300,
+                                        0.5, absl::UnixEpoch()));
+  }
+  std::vector<Order*> taken =
+      kitchen.TakeOrders(absl::MakeSpan(orders), absl::UnixEpoch());
+
+  // "3" and "4" each needed the only overflow slot, so "2" and then "3" were
+  // discarded.
+  ASSERT_EQ(taken.size(), 4);
+  EXPECT_EQ(taken[0]->id_.ToString(), "1");
+  EXPECT_EQ(taken[1], nullptr);
+  EXPECT_EQ(taken[2], nullptr);
+  EXPECT_EQ(taken[3]->id_.ToString(), "4");
+  EXPECT_EQ(kitchen.GetStats().received, 4);
+  EXPECT_EQ(kitchen.GetStats().discarded, 2);
+}
+
+TEST(KitchenTest, TakeOrdersRejectsWholeBatch) {
+  VirtualScheduler scheduler(absl::UnixEpoch());
+  KitchenLayout layout;
+  layout.overflow_capacity = 1;
+  layout.SetShelfCapacity(TemperatureType::HOT, 1);
+  Kitchen kitchen({"test", layout}, &scheduler);
+  std::vector<std::unique_ptr<Order>> orders;
+  orders.push_back(Order::CreateOrder("1", "ramen", TemperatureType::HOT, 300,
+                                      0.5, absl::UnixEpoch()));
+  orders.push_back(Order::CreateOrder("2", "mochi", TemperatureType::FROZEN,
+                                      300, 0.5, absl::UnixEpoch()));
+  EXPECT_THROW(kitchen.TakeOrders(absl::MakeSpan(orders), absl::UnixEpoch()),
+               std::invalid_argument);
+  EXPECT_EQ(kitchen.GetStats().received, 0);
+  EXPECT_NE(orders[0], nullptr);
+}
+
 TEST(KitchenTest, OrderValueExpired) {
   boost::asio::io_context context;
   Kitchen kitchen({"test"}, context);
@@ -130,4 +222,293 @@ TEST(KitchenTest, OrderValueOverflow) {
       (300 - 2 * 100 * 1) / 300.);
 }
 
-}  // namespace kitchen_sim
\ No newline at end of file
+TEST(KitchenTest, ExpiredOrderRemoved) {
+  VirtualScheduler scheduler(absl::UnixEpoch());
+  Kitchen kitchen({"test"}, &scheduler);
+  kitchen.TakeOrder(Order::CreateOrder("1", "ice cream",
+                                       TemperatureType::FROZEN, 300, 1,
+                                       absl::UnixEpoch()),
+                    absl::UnixEpoch());
+  scheduler.Run();
+
+  EXPECT_EQ(scheduler.Now(), absl::UnixEpoch() + absl::Seconds(300));
+  EXPECT_TRUE(
+      kitchen.TemperatureShelf(TemperatureType::FROZEN).Orders().empty());
+  EXPECT_EQ(kitchen.PickupOrder("1", scheduler.Now()), nullptr);
+}
+
+TEST(KitchenTest, DiscardedOrderCannotBePickedUp) {
+  VirtualScheduler scheduler(absl::UnixEpoch());
+  Kitchen kitchen({"test", KitchenLayout::Uniform(1, 1), /*seed=*/42},
+                  &scheduler);
+  for (const std::string id : {"1", "2", "3"}) {
+    kitchen.TakeOrder(Order::CreateOrder(id, "tea", TemperatureType::COLD, 300,
+                                         0.5, absl::UnixEpoch()),
+                      absl::UnixEpoch());
+  }
+
+  // "2" was the only overflow order when "3" arrived.
+  EXPECT_EQ(kitchen.PickupOrder("2", absl::UnixEpoch()), nullptr);
+  EXPECT_NE(kitchen.PickupOrder("3", absl::UnixEpoch()), nullptr);
+}
+
+// Notes the ID, time and reason of each order it hears has left.
+class RemovalListener : public OrderListener {
+ public:
+  explicit RemovalListener(std::vector<std::string>* removed)
+      : removed_(removed) {}
+
+  void OnRemoved(Order* order, RemovalReason reason,
+                 absl::Time at_time) override {
+    static constexpr const char* kReasons[] = {"picked up", "expired",
+                                               "discarded"};
+    removed_->push_back(absl::StrCat(
+        order->id_.ToString(), "@",
+        absl::ToInt64Seconds(at_time - absl::UnixEpoch()), " ",
+        kReasons[static_cast<int>(reason)]));
+  }
+
+ private:
+  std::vector<std::string>* const removed_;
+};
+
+TEST(KitchenTest, ListenersToldOfRemoval) {
+  VirtualScheduler scheduler(absl::UnixEpoch());
+  Kitchen kitchen({"test", KitchenLayout::Uniform(1, 1), /*seed=*/42},
+                  &scheduler);
+  std::vector<std::string> removed;
+  for (const std::string id : {"1", "2", "3"}) {
+    auto order = Order::CreateOrder(id, "tea", TemperatureType::COLD, 300,
+                                    0.5, absl::UnixEpoch());
+    order->SetListener(std::make_unique<RemovalListener>(&removed));
+    kitchen.TakeOrder(std::move(order), absl::UnixEpoch());
+  }
+  EXPECT_THAT(removed, testing::ElementsAre("2@0 discarded"));
+
+  auto picked_up =
+      kitchen.PickupOrder("3", absl::UnixEpoch() + absl::Seconds(1));
+  ASSERT_NE(picked_up, nullptr);
+  scheduler.Run();
+  EXPECT_THAT(removed, testing::ElementsAre("2@0 discarded", "3@1 picked up",
+                                            "1@300 expired"));
+}
+
+TEST(KitchenTest, EvictionPolicyPicksDiscard) {
+  VirtualScheduler scheduler(absl::UnixEpoch());
+  Kitchen::Options options = {"test", KitchenLayout::Uniform(2, 1)};
+  options.eviction_policy = EvictionPolicyType::LOWEST_PICKUP_VALUE;
+  Kitchen kitchen(options, &scheduler);
+  std::vector<Order*> taken;
+  for (const std::string id : {"1", "2", "3"}) {
+    taken.push_back(WaitAndGet(kitchen.TakeOrder(
+        Order::CreateOrder(id, "tea", TemperatureType::COLD, 300, 0.5,
+                           absl::UnixEpoch()),
+        absl::UnixEpoch())));
+  }
+  kitchen.ExpectPickup(taken[1], absl::UnixEpoch() + absl::Seconds(2));
+  kitchen.ExpectPickup(taken[2], absl::UnixEpoch() + absl::Seconds(6));
+  kitchen.TakeOrder(Order::CreateOrder("4", "soda", TemperatureType::COLD, 300,
+                                       0.5, absl::UnixEpoch()),
+                    absl::UnixEpoch());
+
+  // "3" would have decayed the most by the time its courier arrives.
+  EXPECT_EQ(kitchen.PickupOrder("3", absl::UnixEpoch()), nullptr);
+  EXPECT_NE(kitchen.PickupOrder("2", absl::UnixEpoch()), nullptr);
+  EXPECT_EQ(kitchen.GetStats().discarded, 1);
+  EXPECT_DOUBLE_EQ(kitchen.GetStats().WasteRate(), 0.25);
+}
+
+TEST(KitchenTest, EventsRecorded) {
+  VirtualScheduler scheduler(absl::UnixEpoch());
+  RecordingEventSink sink;
+  Kitchen::Options options = {"test", KitchenLayout::Uniform(1, 1)};
+  options.event_sink = &sink;
+  options.shelf_log_interval = absl::InfiniteDuration();
+  Kitchen kitchen(options, &scheduler);
+  kitchen.TakeOrder(Order::CreateOrder("1", "tea", TemperatureType::COLD, 300,
+                                       0.5, absl::UnixEpoch()),
+                    absl::UnixEpoch());
+  kitchen.TakeOrder(Order::CreateOrder("2", "soda", TemperatureType::COLD, 10,
+                                       0.5, absl::UnixEpoch()),
+                    absl::UnixEpoch());
+  kitchen.PickupOrder("1", absl::UnixEpoch() + absl::Seconds(1));
+  scheduler.Run();
+
+  EXPECT_THAT(sink.Events(),
+              testing::ElementsAre("EXPIRY_SCHEDULED 1", "COOKED 1",
+                                   "EXPIRY_SCHEDULED 2 (overflow)",
+                                   "COOKED 2 (overflow)", "DELIVERED 1",
+                                   "MOVED 2", "EXPIRED 2"));
+}
+
+TEST(KitchenTest, FreedSlotFilledFromOverflow) {
+  VirtualScheduler scheduler(absl::UnixEpoch());
+  Kitchen kitchen = BarebonesKitchen(&scheduler);
+  kitchen.TakeOrder(Order::CreateOrder("1", "tea", TemperatureType::COLD, 300,
+                                       1, absl::UnixEpoch()),
+                    absl::UnixEpoch());
+  kitchen.TakeOrder(Order::CreateOrder("2", "soda", TemperatureType::COLD, 300,
+                                       1, absl::UnixEpoch()),
+                    absl::UnixEpoch());
+  ASSERT_EQ(kitchen.OverflowShelf().Orders().size(), 1);
+
+  const absl::Time pickup_time = absl::UnixEpoch() + absl::Seconds(100);
+  kitchen.PickupOrder("1", pickup_time);
+  EXPECT_TRUE(kitchen.OverflowShelf().Orders().empty());
+  ASSERT_EQ(kitchen.TemperatureShelf(TemperatureType::COLD).Orders().size(), 1);
+  EXPECT_EQ(kitchen.GetStats().moved_from_overflow, 1);
+
+  // Decays at the overflow rate until the move, then the regular rate.
+  EXPECT_DOUBLE_EQ(kitchen.OrderValue("2", pickup_time + absl::Seconds(50)),
+                   (300 - 2 * 100 - 50) / 300.);
+}
+
+TEST(KitchenTest, ExpiryFillsSlotFromOverflow) {
+  VirtualScheduler scheduler(absl::UnixEpoch());
+  Kitchen kitchen = BarebonesKitchen(&scheduler);
+  kitchen.TakeOrder(Order::CreateOrder("1", "tea", TemperatureType::COLD, 10,
+                                       1, absl::UnixEpoch()),
+                    absl::UnixEpoch());
+  kitchen.TakeOrder(Order::CreateOrder("2", "soda", TemperatureType::COLD, 300,
+                                       0.1, absl::UnixEpoch()),
+                    absl::UnixEpoch());
+  scheduler.RunUntil(absl::UnixEpoch() + absl::Seconds(10));
+
+  EXPECT_EQ(kitchen.GetStats().expired, 1);
+  EXPECT_TRUE(kitchen.OverflowShelf().Orders().empty());
+  EXPECT_EQ(kitchen.TemperatureShelf(TemperatureType::COLD).Orders().size(), 1);
+}
+
+TEST(KitchenTest, MetricsRecorded) {
+  VirtualScheduler scheduler(absl::UnixEpoch());
+  MetricsRegistry metrics;
+  Kitchen::Options options = {"test", KitchenLayout::Uniform(1, 1)};
+  options.metrics = &metrics;
+  Kitchen kitchen(options, &scheduler);
+  for (const char* id : {"1", "2", "3"}) {
+    kitchen.TakeOrder(Order::CreateOrder(id, "tea", TemperatureType::COLD, 300,
+                                         1, absl::UnixEpoch()),
+                      absl::UnixEpoch() + absl::Seconds(1));
+  }
+  kitchen.PickupOrder("1", absl::UnixEpoch() + absl::Seconds(5));
+
+  const auto orders = [&](absl::string_view event) {
+    return metrics
+        .GetCounter("kitchen_orders_total", "",
+                    {{"kitchen", "test"}, {"event", std::string(event)}})
+        ->Value();
+  };
+  EXPECT_EQ(orders("received"), 3);
+  EXPECT_EQ(orders("overflowed"), 2);
+  EXPECT_EQ(orders("discarded"), 1);
+  EXPECT_EQ(orders("delivered"), 1);
+  EXPECT_EQ(orders("moved_from_overflow"), 1);
+  const MetricsRegistry::Labels labels = {{"kitchen", "test"}};
+  EXPECT_EQ(metrics.GetGauge("kitchen_overflow_orders", "", labels)->Value(),
+            0);
+  EXPECT_EQ(
+      metrics.GetHistogram("kitchen_shelf_time_ms", "", labels)->Snapshot().max,
+      4000);
+  EXPECT_EQ(metrics.GetHistogram("kitchen_take_order_ns", "", labels)
+                ->Snapshot()
+                .count,
+            3);
+  EXPECT_EQ(metrics.GetHistogram("kitchen_make_overflow_room_ns", "", labels)
+                ->Snapshot()
+                .count,
+            1);
+}
+
+// Cooks an order each second in [from, to) on |kitchen|, which is too small
+// to hold them all, and picks up or expects couriers for some of them.
+void CookEverySecond(Kitchen* kitchen, VirtualScheduler* scheduler, int from,
+                     int to) {
+  for (int second = from; second < to; ++second) {
+    const absl::Time now = absl::UnixEpoch() + absl::Seconds(second);
+    scheduler->RunUntil(now);
+    kitchen->TakeOrder(
+        Order::CreateOrder(
+            absl::StrCat(second), "tea",
+            second % 2 == 0 ? TemperatureType::HOT : TemperatureType::COLD,
+            20 + second, 0.5 + 0.25 * (second % 3), now),
+        now);
+    if (second % 3 == 0) {
+      kitchen->PickupOrder(absl::StrCat(second - 4), now);
+    }
+    if (Order* order = kitchen->FindOrder(OrderId(absl::StrCat(second - 1)))) {
+      kitchen->ExpectPickup(order, now + absl::Seconds(second % 5));
+    }
+  }
+}
+
+TEST(KitchenTest, RestoresCheckpoint) {
+  for (EvictionPolicyType policy :
+       {EvictionPolicyType::RANDOM, EvictionPolicyType::LOWEST_VALUE,
+        EvictionPolicyType::EARLIEST_EXPIRY,
+        EvictionPolicyType::LOWEST_PICKUP_VALUE}) {
+    SCOPED_TRACE(EvictionPolicyName(policy));
+    RecordingEventSink sink;
+    Kitchen::Options options = {"test", HotAndColdLayout()};
+    options.seed = 3;
+    options.eviction_policy = policy;
+    options.event_sink = &sink;
+    options.shelf_log_interval = absl::InfiniteDuration();
+    VirtualScheduler scheduler;
+    Kitchen kitchen(options, &scheduler);
+    CookEverySecond(&kitchen, &scheduler, 0, 10);
+    std::string checkpoint;
+    BinaryWriter writer(&checkpoint);
+    kitchen.Checkpoint(&writer);
+    const size_t checkpoint_events = sink.Events().size();
+    CookEverySecond(&kitchen, &scheduler, 10, 40);
+    scheduler.Run();
+
+    // Carrying on from the checkpoint plays out exactly the same.
+    RecordingEventSink restored_sink;
+    options.event_sink = &restored_sink;
+    VirtualScheduler restored_scheduler;
+    restored_scheduler.RunUntil(absl::UnixEpoch() + absl::Seconds(9));
+    Kitchen restored(options, &restored_scheduler);
+    RestoredTimers timers;
+    BinaryReader reader(checkpoint);
+    restored.Restore(&reader, &timers);
+    EXPECT_TRUE(reader.AtEnd());
+    // An expiry for each held order.
+    EXPECT_GT(timers.size(), 0);
+    timers.ScheduleAll(&restored_scheduler);
+    CookEverySecond(&restored, &restored_scheduler, 10, 40);
+    restored_scheduler.Run();
+
+    EXPECT_THAT(restored_sink.Events(),
+                testing::ElementsAreArray(
+                    sink.Events().begin() + checkpoint_events,
+                    sink.Events().end()));
+    EXPECT_EQ(restored.GetStats().received, 40);
+    EXPECT_GT(restored.GetStats().discarded, 0);
+    EXPECT_EQ(restored.GetStats().discarded, kitchen.GetStats().discarded);
+    EXPECT_EQ(restored.GetStats().delivered_value,
+              kitchen.GetStats().delivered_value);
+  }
+}
+
+TEST(KitchenTest, RestoreRejectsMismatchedKitchen) {
+  VirtualScheduler scheduler;
+  Kitchen kitchen({"test", HotAndColdLayout()}, &scheduler);
+  CookEverySecond(&kitchen, &scheduler, 0, 5);
+  std::string checkpoint;
+  BinaryWriter writer(&checkpoint);
+  kitchen.Checkpoint(&writer);
+
+  RestoredTimers timers;
+  BinaryReader into_busy(checkpoint);
+  EXPECT_THROW(kitchen.Restore(&into_busy, &timers), std::invalid_argument);
+  Kitchen smaller = BarebonesKitchen(&scheduler);
+  BinaryReader into_smaller(checkpoint);
+  EXPECT_THROW(smaller.Restore(&into_smaller, &timers),
+               std::invalid_argument);
+  BinaryReader truncated(absl::string_view(checkpoint).substr(0, 20));
+  Kitchen empty({"test", HotAndColdLayout()}, &scheduler);
+  EXPECT_THROW(empty.Restore(&truncated, &timers), std::invalid_argument);
+}
+
+}  // namespace kitchen_sim
@@ -2,8 +2,21 @@
 
 namespace kitchen_sim {
 
-std::unique_ptr<Order> Order::CreateOrder(const std::string& id,
-                                          const std::string& name,
+std::string PrintTemperatureType(TemperatureType temp) {
+  switch (temp) {
+    case TemperatureType::HOT:
+      return "HOT";
+    case TemperatureType::COLD:
+      return "COLD";
+    case TemperatureType::FROZEN:
+      return "FROZEN";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+std::unique_ptr<Order> Order::CreateOrder(absl::string_view id,
+                                          absl::string_view name,
                                           TemperatureType temp,
                                           int shelf_life_s, double decay_rate,
                                           absl::Time receipt_time) {
@@ -33,9 +46,9 @@ std::string Order::LogMessage(absl::string_view event_type) const {
       .append(event_type)
       .append(" | name: ")
       .append(name_)
-      .append(" | id: ")
-      .append(id_)
-      .append(" ]");
+      .append(" | id: ");
+  id_.AppendTo(&message);
+  message.append(" ]");
   return message;
 }
 
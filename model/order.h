@@ -1,19 +1,48 @@
 #ifndef KITCHEN_SIM_ORDER_H_
 #define KITCHEN_SIM_ORDER_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <string>
 
+#include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "base.h"
+#include "model/order_id.h"
+#include "runtime/block_pool.h"
+#include "runtime/string_interner.h"
 
 namespace kitchen_sim {
 
 // Avaiable temperature groups for orders.
 enum class TemperatureType { UNKNOWN, FROZEN, COLD, HOT };
 
-// Represents a single food order.
+// "HOT", "COLD", "FROZEN" or "UNKNOWN".
+std::string PrintTemperatureType(TemperatureType temp);
+
+class Order;
+
+// How an order left its kitchen for good.
+enum class RemovalReason { PICKED_UP, EXPIRED, DISCARDED };
+constexpr int kRemovalReasonCount = 3;
+
+// Follows an order through its kitchen on behalf of whoever submitted it, e.g.
+// to resume whatever drives the order. Owned by the order.
+class OrderListener {
+ public:
+  virtual ~OrderListener() = default;
+
+  // Called by the kitchen holding |order| as it leaves for good at |at_time|,
+  // for |reason|. The order is freed, or handed to its courier, once this
+  // returns.
+  virtual void OnRemoved(Order* order, RemovalReason reason,
+                         absl::Time at_time) = 0;
+};
+
+// Represents a single food order. Orders are allocated from a BlockPool, so
+// the memory of delivered, expired and discarded orders is recycled.
 class Order {
  public:
   // Factory method that creates an order from the following parameters:
@@ -25,14 +54,19 @@ class Order {
   // |receipt_time| = Time when order was received in the system.
   // Returns an exception if parameters fail validation.
   static std::unique_ptr<Order> CreateOrder(
-      const std::string& id, const std::string& name, TemperatureType temp,
+      absl::string_view id, absl::string_view name, TemperatureType temp,
       int shelf_life_s, double decay_rate,
       absl::Time receipt_time = absl::Now());
 
-  Order(const std::string& id, const std::string& name, TemperatureType temp,
+  Order(absl::string_view id, absl::string_view name, TemperatureType temp,
+        int shelf_life_s, double decay_rate, absl::Time receipt_time)
+      : Order(OrderId(id), name, temp, shelf_life_s, decay_rate,
+              receipt_time) {}
+  // Like the above, for an ID already parsed.
+  Order(const OrderId& id, absl::string_view name, TemperatureType temp,
         int shelf_life_s, double decay_rate, absl::Time receipt_time)
       : id_(id),
-        name_(name),
+        name_(StringInterner::Global().Intern(name)),
         temp_(temp),
         shelf_life_s_(shelf_life_s),
         decay_rate_(decay_rate),
@@ -40,6 +74,18 @@ class Order {
   Order(Order const&) = delete;
   Order& operator=(Order const&) = delete;
 
+  static void* operator new(size_t size) {
+    return size == sizeof(Order) ? BlockPool<Order>::Allocate()
+                                 : ::operator new(size);
+  }
+  static void operator delete(void* block, size_t size) {
+    if (size == sizeof(Order)) {
+      BlockPool<Order>::Free(block);
+    } else {
+      ::operator delete(block);
+    }
+  }
+
   std::string LogMessage(absl::string_view event_type) const;
 
   void MoveFrom(int current_shelf_decay_modifier,
@@ -69,8 +115,35 @@ class Order {
   };
   void SetDeliveryTime(absl::Time at_time) { delivery_time_.emplace(at_time); }
 
-  const std::string id_;
-  const std::string name_;
+  // Value and time of the last shelf move, which Value() decays from. The
+  // time is unset until the order is cooked.
+  double LastValueAtMove() const { return last_value_at_move_; }
+  const std::optional<absl::Time>& LastMoveTime() const {
+    return last_move_time_;
+  }
+
+  // When the order's courier is expected, once one has been dispatched. Set
+  // through Kitchen::ExpectPickup(), which keeps the overflow shelf's eviction
+  // order up to date.
+  const std::optional<absl::Time>& PickupTime() const { return pickup_time_; }
+  void SetPickupTime(absl::Time at_time) { pickup_time_.emplace(at_time); }
+
+  // Told when the order leaves its kitchen, if set.
+  OrderListener* Listener() const { return listener_.get(); }
+  void SetListener(std::unique_ptr<OrderListener> listener) {
+    listener_ = std::move(listener);
+  }
+
+  // Puts back a move recorded by the above, e.g. from a checkpoint. Call after
+  // SetFulfillmentTime().
+  void RestoreLastMove(double value, absl::Time at_time) {
+    last_value_at_move_ = value;
+    last_move_time_.emplace(at_time);
+  }
+
+  const OrderId id_;
+  // Interned in StringInterner::Global().
+  const absl::string_view name_;
   const TemperatureType temp_ = TemperatureType::UNKNOWN;
   const int shelf_life_s_ = 0;      // Max seconds before considered waste.
   const double decay_rate_ = 0.0f;  // Per-second.
@@ -78,10 +151,31 @@ class Order {
   // Always set immediately once order comes in.
   const absl::Time receipt_time_;
 
-  std::unique_ptr<boost::asio::system_timer> expiration_timer_;
-  std::unique_ptr<boost::asio::system_timer> courier_timer_;
+  // Optional routing key, e.g. the delivery region. Empty if unknown.
+  std::string region_;
 
  private:
+  // Kitchen bookkeeping, so the kitchen holding the order finds its place in
+  // its shelves and timers without searching.
+  friend class Kitchen;
+  friend class EvictionPolicy;
+
+  // Scheduler::TimerId of the pending expiry, set by the holding kitchen.
+  std::optional<uint64_t> expiration_timer_;
+
+  // Handle to the order's place on its kitchen's shelves: which shelf (-1 if
+  // none) and which slot on it. Maintained by Kitchen::Shelf.
+  int shelf_index_ = -1;
+  uint32_t shelf_slot_ = 0;
+
+  // Positions in the kitchen's per-temperature overflow bucket and its
+  // EvictionPolicy index (if the policy keeps one) while on the overflow shelf.
+  uint32_t overflow_bucket_slot_ = 0;
+  uint32_t eviction_slot_ = 0;
+
+  std::optional<absl::Time> pickup_time_;
+  std::unique_ptr<OrderListener> listener_;
+
   // Set at later times in the processing pipeline.
   std::optional<absl::Time> fulfillment_time_;
   std::optional<absl::Time> delivery_time_;
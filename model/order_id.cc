@@ -0,0 +1,161 @@
+#include "model/order_id.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace kitchen_sim {
+namespace {
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+// Value of a lowercase hex digit, or -1.
+int HexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+bool IsUuidDash(size_t position) {
+  return position == 8 || position == 13 || position == 18 || position == 23;
+}
+
+uint64_t Mix(uint64_t value) {
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdULL;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ULL;
+  value ^= value >> 33;
+  return value;
+}
+
+}  // namespace
+
+OrderId::OrderId(absl::string_view id) {
+  if (id.size() <= kInlineSize) {
+    size_ = id.size();
+    std::memcpy(bytes_, id.data(), id.size());
+    return;
+  }
+  if (id.size() == kUuidSize) {
+    size_t nibble = 0;
+    for (size_t i = 0; i < kUuidSize; ++i) {
+      if (IsUuidDash(i)) {
+        if (id[i] != '-') {
+          break;
+        }
+        continue;
+      }
+      const int value = HexValue(id[i]);
+      if (value < 0) {
+        break;
+      }
+      bytes_[nibble / 2] |= value << (nibble % 2 == 0 ? 4 : 0);
+      ++nibble;
+    }
+    if (nibble == 2 * kInlineSize) {
+      kind_ = Kind::UUID;
+      return;
+    }
+    std::memset(bytes_, 0, sizeof(bytes_));
+  }
+  kind_ = Kind::HEAP;
+  heap_ = std::make_shared<const std::string>(id);
+}
+
+OrderId OrderId::FromPackedUuid(const unsigned char* bits) {
+  OrderId id;
+  id.kind_ = Kind::UUID;
+  std::memcpy(id.bytes_, bits, kPackedUuidSize);
+  return id;
+}
+
+bool OrderId::PackUuid(unsigned char* out) const {
+  if (kind_ != Kind::UUID) {
+    return false;
+  }
+  std::memcpy(out, bytes_, kPackedUuidSize);
+  return true;
+}
+
+size_t OrderId::size() const {
+  switch (kind_) {
+    case Kind::UUID:
+      return kUuidSize;
+    case Kind::HEAP:
+      return heap_->size();
+    default:
+      return size_;
+  }
+}
+
+size_t OrderId::CopyTo(char* out, size_t size) const {
+  switch (kind_) {
+    case Kind::UUID: {
+      char formatted[kUuidSize];
+      size_t nibble = 0;
+      for (size_t i = 0; i < kUuidSize; ++i) {
+        if (IsUuidDash(i)) {
+          formatted[i] = '-';
+          continue;
+        }
+        const unsigned char byte = bytes_[nibble / 2];
+        formatted[i] = kHexDigits[nibble % 2 == 0 ? byte >> 4 : byte & 0xf];
+        ++nibble;
+      }
+      size = std::min(size, kUuidSize);
+      std::memcpy(out, formatted, size);
+      return size;
+    }
+    case Kind::HEAP:
+      size = std::min(size, heap_->size());
+      std::memcpy(out, heap_->data(), size);
+      return size;
+    default:
+      size = std::min<size_t>(size, size_);
+      std::memcpy(out, bytes_, size);
+      return size;
+  }
+}
+
+void OrderId::AppendTo(std::string* out) const {
+  if (kind_ == Kind::HEAP) {
+    out->append(*heap_);
+    return;
+  }
+  char buffer[kMaxCompactSize];
+  out->append(buffer, CopyTo(buffer, sizeof(buffer)));
+}
+
+std::string OrderId::ToString() const {
+  std::string id;
+  AppendTo(&id);
+  return id;
+}
+
+size_t OrderId::Hash() const {
+  if (kind_ == Kind::HEAP) {
+    return std::hash<std::string>()(*heap_);
+  }
+  uint64_t high;
+  uint64_t low;
+  std::memcpy(&high, bytes_, sizeof(high));
+  std::memcpy(&low, bytes_ + sizeof(high), sizeof(low));
+  return Mix(high ^ Mix(low ^ (static_cast<uint64_t>(kind_) << 8 | size_)));
+}
+
+bool operator==(const OrderId& a, const OrderId& b) {
+  if (a.kind_ != b.kind_) {
+    return false;
+  }
+  if (a.kind_ == OrderId::Kind::HEAP) {
+    return *a.heap_ == *b.heap_;
+  }
+  return a.size_ == b.size_ &&
+         std::memcmp(a.bytes_, b.bytes_, sizeof(a.bytes_)) == 0;
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,80 @@
+#ifndef KITCHEN_SIM_ORDER_ID_H_
+#define KITCHEN_SIM_ORDER_ID_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "absl/strings/string_view.h"
+
+namespace kitchen_sim {
+
+// Compact, copyable order ID. Canonical lowercase UUIDs (the common case) are
+// packed into their 128 bits and IDs of up to 16 bytes are stored inline, so
+// neither touches the heap. Anything else is kept in a shared heap string.
+// Two IDs are equal iff their strings are.
+class OrderId {
+ public:
+  // Longest string any ID formats to without a heap string.
+  static constexpr size_t kMaxCompactSize = 36;
+
+  // Size of a UUID's packed bits.
+  static constexpr size_t kPackedUuidSize = 16;
+
+  OrderId() = default;
+  explicit OrderId(absl::string_view id);
+
+  // The UUID ID whose 128 bits, in written order, are |bits|.
+  static OrderId FromPackedUuid(const unsigned char* bits);
+  // Writes a UUID ID's kPackedUuidSize bytes of bits to |out| and returns
+  // true, or returns false for any other ID.
+  bool PackUuid(unsigned char* out) const;
+
+  std::string ToString() const;
+  void AppendTo(std::string* out) const;
+  // Writes up to |size| characters of the ID (unterminated) to |out| and
+  // returns how many were written.
+  size_t CopyTo(char* out, size_t size) const;
+
+  size_t size() const;
+  bool empty() const { return size() == 0; }
+
+  size_t Hash() const;
+  struct Hasher {
+    size_t operator()(const OrderId& id) const { return id.Hash(); }
+  };
+
+  friend bool operator==(const OrderId& a, const OrderId& b);
+  friend bool operator!=(const OrderId& a, const OrderId& b) {
+    return !(a == b);
+  }
+  friend bool operator==(const OrderId& a, absl::string_view b) {
+    return a == OrderId(b);
+  }
+  friend bool operator!=(const OrderId& a, absl::string_view b) {
+    return !(a == b);
+  }
+  friend std::ostream& operator<<(std::ostream& out, const OrderId& id) {
+    return out << id.ToString();
+  }
+
+ private:
+  enum class Kind : uint8_t { INLINE, UUID, HEAP };
+
+  static constexpr size_t kInlineSize = 16;
+  static constexpr size_t kUuidSize = 36;
+
+  Kind kind_ = Kind::INLINE;
+  // INLINE only.
+  uint8_t size_ = 0;
+  // INLINE: the ID's bytes. UUID: its 128 bits, in written order.
+  alignas(8) unsigned char bytes_[kInlineSize] = {};
+  // HEAP only.
+  std::shared_ptr<const std::string> heap_;
+};
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_ORDER_ID_H_
@@ -0,0 +1,48 @@
+#include "model/order_id.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+
+TEST(OrderIdTest, RoundTrips) {
+  for (const std::string id :
+       {"", "1", "exactly16bytes!!", "a8cfcb76-7f24-4420-a5ba-d46dd77bdffd",
+        "A8CFCB76-7F24-4420-A5BA-D46DD77BDFFD",
+        "a8cfcb76-7f24-4420-a5ba-d46dd77bdffg",
+        "an id that is too long to be stored inline"}) {
+    EXPECT_EQ(OrderId(id).ToString(), id);
+    EXPECT_EQ(OrderId(id).size(), id.size());
+  }
+}
+
+TEST(OrderIdTest, EqualityFollowsStrings) {
+  const std::string uuid = "a8cfcb76-7f24-4420-a5ba-d46dd77bdffd";
+  EXPECT_EQ(OrderId(uuid), OrderId(uuid));
+  EXPECT_EQ(OrderId(uuid).Hash(), OrderId(uuid).Hash());
+  EXPECT_NE(OrderId(uuid), OrderId("a8cfcb76-7f24-4420-a5ba-d46dd77bdffe"));
+  EXPECT_NE(OrderId("1"), OrderId("10"));
+  EXPECT_NE(OrderId("1"), OrderId(std::string("1\0", 2)));
+  EXPECT_EQ(OrderId("a long id that lives on the heap"),
+            "a long id that lives on the heap");
+}
+
+TEST(OrderIdTest, CopyToTruncates) {
+  char buffer[8];
+  EXPECT_EQ(OrderId("a8cfcb76-7f24-4420-a5ba-d46dd77bdffd")
+                .CopyTo(buffer, sizeof(buffer)),
+            8);
+  EXPECT_EQ(std::string(buffer, 8), "a8cfcb76");
+}
+
+TEST(OrderIdTest, PacksUuids) {
+  const OrderId uuid("a8cfcb76-7f24-4420-a5ba-d46dd77bdffd");
+  unsigned char bits[OrderId::kPackedUuidSize];
+  ASSERT_TRUE(uuid.PackUuid(bits));
+  EXPECT_EQ(bits[0], 0xa8);
+  EXPECT_EQ(OrderId::FromPackedUuid(bits), uuid);
+  EXPECT_EQ(OrderId::FromPackedUuid(bits).Hash(), uuid.Hash());
+  EXPECT_FALSE(OrderId("1").PackUuid(bits));
+}
+
+}  // namespace kitchen_sim
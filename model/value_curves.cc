@@ -0,0 +1,129 @@
+#include "model/value_curves.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace kitchen_sim {
+
+namespace {
+
+// Orders valued per step of the passes below. Lanes within a step are
+// independent, so the compiler packs them into vector registers even where it
+// won't vectorize whole loops, as GCC won't at -O2.
+constexpr size_t kLanes = 4;
+
+}  // namespace
+
+double ValueCurves::ToSeconds(absl::Time time) {
+  return absl::ToDoubleSeconds(time - absl::UnixEpoch());
+}
+
+void ValueCurves::Reserve(size_t capacity) {
+  for (auto* column : {&start_value_, &start_s_, &slope_, &cooked_s_,
+                       &spoiled_s_, &expiry_s_}) {
+    column->reserve(capacity);
+  }
+}
+
+void ValueCurves::Add(const Order& order, int decay_modifier) {
+  constexpr double kInfinity = std::numeric_limits<double>::infinity();
+  if (!order.FulfillmentTime().has_value()) {
+    // Worthless, and never expires, until cooked.
+    start_value_.push_back(0.);
+    start_s_.push_back(0.);
+    slope_.push_back(0.);
+    cooked_s_.push_back(kInfinity);
+    spoiled_s_.push_back(kInfinity);
+    expiry_s_.push_back(kInfinity);
+    return;
+  }
+  const double decay = order.decay_rate_ * decay_modifier;
+  const double cooked_s = ToSeconds(order.FulfillmentTime().value());
+  start_value_.push_back(order.LastValueAtMove());
+  start_s_.push_back(ToSeconds(order.LastMoveTime().value()));
+  slope_.push_back(order.shelf_life_s_ > 0 ? decay / order.shelf_life_s_
+                                           : (decay > 0. ? kInfinity : 0.));
+  cooked_s_.push_back(cooked_s);
+  spoiled_s_.push_back(cooked_s + order.shelf_life_s_ + 1);
+  expiry_s_.push_back(ToSeconds(order.Expiry(decay_modifier)));
+}
+
+void ValueCurves::Remove(size_t slot) {
+  for (auto* column : {&start_value_, &start_s_, &slope_, &cooked_s_,
+                       &spoiled_s_, &expiry_s_}) {
+    (*column)[slot] = column->back();
+    column->pop_back();
+  }
+}
+
+void ValueCurves::Values(absl::Time at_time,
+                         std::vector<double>* values) const {
+  const size_t size = Size();
+  values->resize(size);
+  const Columns columns = GetColumns();
+  const double now_s = ToSeconds(at_time);
+  double* out = values->data();
+  size_t i = 0;
+  for (; i + kLanes <= size; i += kLanes) {
+    // Loaded in full before storing, as |out| could alias the columns for all
+    // the compiler knows.
+    double step[kLanes];
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+      step[lane] = columns.Value(i + lane, now_s);
+    }
+    std::copy(step, step + kLanes, out + i);
+  }
+  for (; i < size; ++i) {
+    out[i] = columns.Value(i, now_s);
+  }
+}
+
+ValueCurves::Summary ValueCurves::Summarize(absl::Time at_time) const {
+  constexpr double kInfinity = std::numeric_limits<double>::infinity();
+  Summary summary;
+  const size_t size = Size();
+  if (size == 0) {
+    return summary;
+  }
+  const Columns columns = GetColumns();
+  const double now_s = ToSeconds(at_time);
+  // Per-lane extremes, merged once at the end.
+  double lowest[kLanes] = {kInfinity, kInfinity, kInfinity, kInfinity};
+  double earliest_expiry_s[kLanes] = {kInfinity, kInfinity, kInfinity,
+                                      kInfinity};
+  size_t i = 0;
+  for (; i + kLanes <= size; i += kLanes) {
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+      const double value = columns.Value(i + lane, now_s);
+      const double expiry_s = columns.expiry_s[i + lane];
+      lowest[lane] = value < lowest[lane] ? value : lowest[lane];
+      earliest_expiry_s[lane] = expiry_s < earliest_expiry_s[lane]
+                                    ? expiry_s
+                                    : earliest_expiry_s[lane];
+    }
+  }
+  for (; i < size; ++i) {
+    lowest[0] = std::min(lowest[0], columns.Value(i, now_s));
+    earliest_expiry_s[0] = std::min(earliest_expiry_s[0], columns.expiry_s[i]);
+  }
+  summary.lowest_value = *std::min_element(lowest, lowest + kLanes);
+  summary.earliest_expiry =
+      absl::UnixEpoch() +
+      absl::Seconds(
+          *std::min_element(earliest_expiry_s, earliest_expiry_s + kLanes));
+  // The first slot holding the lowest value, found by a scalar scan that
+  // usually stops early, rather than tracking slots in every lane above.
+  for (size_t slot = 0; slot < size; ++slot) {
+    if (columns.Value(slot, now_s) == summary.lowest_value) {
+      summary.lowest_slot = static_cast<int>(slot);
+      break;
+    }
+  }
+  return summary;
+}
+
+absl::Time ValueCurves::Expiry(size_t slot) const {
+  return absl::UnixEpoch() + absl::Seconds(expiry_s_[slot]);
+}
+
+}  // namespace kitchen_sim
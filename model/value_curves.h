@@ -0,0 +1,94 @@
+#ifndef KITCHEN_SIM_VALUE_CURVES_H_
+#define KITCHEN_SIM_VALUE_CURVES_H_
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "model/order.h"
+
+namespace kitchen_sim {
+
+// Value curves of the orders on one shelf, stored one array per parameter so
+// that a whole shelf is valued in a single pass the compiler can vectorize.
+//
+// While an order stays on a shelf its value falls linearly from its value at
+// the last move until it reaches zero or its shelf life runs out, so a handful
+// of numbers fixed when it lands describe it until it leaves. Slots are dense
+// and mirror the caller's own: Add() appends and Remove() fills the vacated
+// slot with the last one, like Kitchen::Shelf.
+class ValueCurves {
+ public:
+  struct Summary {
+    // Slot of the lowest-valued order (the first, on ties) and its value, or
+    // -1 and infinity if there are no orders.
+    int lowest_slot = -1;
+    double lowest_value = std::numeric_limits<double>::infinity();
+    // Earliest that any order's value reaches zero.
+    absl::Time earliest_expiry = absl::InfiniteFuture();
+  };
+
+  void Reserve(size_t capacity);
+
+  // Appends the curve of |order| on a shelf with |decay_modifier|. Orders not
+  // yet cooked are worth nothing until they are.
+  void Add(const Order& order, int decay_modifier);
+  void Remove(size_t slot);
+
+  size_t Size() const { return start_value_.size(); }
+
+  // Writes every order's value at |at_time| to |values|, in slot order.
+  // Matches Order::Value() to within rounding.
+  void Values(absl::Time at_time, std::vector<double>* values) const;
+
+  // Values the whole shelf at |at_time|, keeping only the extremes.
+  Summary Summarize(absl::Time at_time) const;
+
+  // Like Order::Expiry().
+  absl::Time Expiry(size_t slot) const;
+
+ private:
+  // Times are seconds since the Unix epoch, precise to well under a
+  // microsecond for any time this century.
+  static double ToSeconds(absl::Time time);
+
+  // Raw pointers into the columns, so that passes over them needn't assume
+  // the vectors alias.
+  struct Columns {
+    // Value at |now_s| of the order in |slot|, computed without branches.
+    double Value(size_t slot, double now_s) const {
+      const double value =
+          start_value[slot] - slope[slot] * (now_s - start_s[slot]);
+      // Bitwise rather than logical ands, so there is nothing to branch on.
+      const bool live = (now_s >= cooked_s[slot]) &
+                        (now_s < spoiled_s[slot]) & (value > 0.);
+      return live ? value : 0.;
+    }
+
+    const double* start_value;
+    const double* start_s;
+    const double* slope;
+    const double* cooked_s;
+    const double* spoiled_s;
+    const double* expiry_s;
+  };
+  Columns GetColumns() const {
+    return {start_value_.data(), start_s_.data(),   slope_.data(),
+            cooked_s_.data(),    spoiled_s_.data(), expiry_s_.data()};
+  }
+
+  // Value at |start_s_| and its loss per second.
+  std::vector<double> start_value_;
+  std::vector<double> start_s_;
+  std::vector<double> slope_;
+  // The order is worthless before |cooked_s_| and from |spoiled_s_| on, once
+  // a whole second past its shelf life.
+  std::vector<double> cooked_s_;
+  std::vector<double> spoiled_s_;
+  std::vector<double> expiry_s_;
+};
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_VALUE_CURVES_H_
@@ -0,0 +1,79 @@
+#include "model/value_curves.h"
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+
+std::unique_ptr<Order> CookedOrder(const std::string& id, int shelf_life_s,
+                                   double decay_rate, absl::Time cooked) {
+  auto order = Order::CreateOrder(id, "dumplings", TemperatureType::HOT,
+                                  shelf_life_s, decay_rate, cooked);
+  order->SetFulfillmentTime(cooked);
+  return order;
+}
+
+TEST(ValueCurvesTest, MatchesOrderValue) {
+  const absl::Time cooked = absl::FromUnixSeconds(1600000000);
+  std::vector<std::unique_ptr<Order>> orders;
+  ValueCurves curves;
+  // Enough to cover whole steps and a remainder.
+  for (int i = 0; i < 11; ++i) {
+    orders.push_back(CookedOrder(std::to_string(i), 10 + 30 * i, 0.1 * i,
+                                 cooked + absl::Seconds(i)));
+  }
+  // One order moved shelves partway through its life.
+  orders[3]->MoveFrom(2, cooked + absl::Seconds(20));
+  for (const auto& order : orders) {
+    curves.Add(*order, 1);
+  }
+
+  std::vector<double> values;
+  for (int s : {0, 5, 11, 50, 200, 400}) {
+    const absl::Time at_time =
+        cooked + absl::Seconds(s) + absl::Milliseconds(5);
+    curves.Values(at_time, &values);
+    ASSERT_EQ(values.size(), orders.size());
+    for (size_t slot = 0; slot < orders.size(); ++slot) {
+      EXPECT_NEAR(values[slot], orders[slot]->Value(1, at_time), 1e-9)
+          << "slot " << slot << " at +" << s << "s";
+    }
+  }
+}
+
+TEST(ValueCurvesTest, SummarizesLowestValueAndExpiry) {
+  const absl::Time cooked = absl::UnixEpoch();
+  auto slow = CookedOrder("1", 300, 0.1, cooked);
+  auto fast = CookedOrder("2", 300, 1, cooked);
+  auto short_lived = CookedOrder("3", 20, 0.01, cooked);
+  ValueCurves curves;
+  EXPECT_EQ(curves.Summarize(cooked).lowest_slot, -1);
+  EXPECT_EQ(ValueCurves::Summary().lowest_value,
+            std::numeric_limits<double>::infinity());
+  for (const Order* order : {slow.get(), fast.get(), short_lived.get()}) {
+    curves.Add(*order, 2);
+  }
+
+  ValueCurves::Summary summary = curves.Summarize(cooked + absl::Seconds(10));
+  EXPECT_EQ(summary.lowest_slot, 1);
+  EXPECT_DOUBLE_EQ(summary.lowest_value,
+                   fast->Value(2, cooked + absl::Seconds(10)));
+  EXPECT_EQ(summary.earliest_expiry, short_lived->Expiry(2));
+
+  // Past its shelf life, the short-lived order is worth nothing.
+  summary = curves.Summarize(cooked + absl::Seconds(21));
+  EXPECT_EQ(summary.lowest_slot, 2);
+  EXPECT_EQ(summary.lowest_value, 0.);
+
+  // Removing fills the slot with the last order.
+  curves.Remove(0);
+  ASSERT_EQ(curves.Size(), 2);
+  EXPECT_EQ(curves.Expiry(0), short_lived->Expiry(2));
+  EXPECT_EQ(curves.Summarize(cooked + absl::Seconds(10)).lowest_slot, 1);
+}
+
+}  // namespace kitchen_sim
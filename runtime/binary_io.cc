@@ -0,0 +1,28 @@
+#include "runtime/binary_io.h"
+
+#include <stdexcept>
+
+namespace kitchen_sim {
+
+uint64_t BinaryReader::ReadVarint() {
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    const uint8_t byte = Read<uint8_t>();
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+  throw std::invalid_argument("Malformed varint in binary input!");
+}
+
+const char* BinaryReader::Take(size_t size) {
+  if (size > in_.size()) {
+    throw std::invalid_argument("Unexpected end of binary input!");
+  }
+  const char* data = in_.data();
+  in_.remove_prefix(size);
+  return data;
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,136 @@
+#ifndef KITCHEN_SIM_RUNTIME_BINARY_IO_H_
+#define KITCHEN_SIM_RUNTIME_BINARY_IO_H_
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <type_traits>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+
+namespace kitchen_sim {
+
+namespace binary_io_internal {
+
+// Resolution of absl::Time.
+constexpr int kTicksPerNanosecond = 4;
+inline absl::Duration TimeTick() {
+  return absl::Nanoseconds(1) / kTicksPerNanosecond;
+}
+
+}  // namespace binary_io_internal
+
+// Appends fixed-width values in host byte order, varints and length-prefixed
+// strings to a buffer. Meant for checkpoints and traces read back by the same
+// build on the same machine, not for exchange.
+class BinaryWriter {
+ public:
+  // |out| must outlive the writer.
+  explicit BinaryWriter(std::string* out) : out_(out) {}
+
+  template <typename T>
+  void Write(const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only trivially copyable values are written raw");
+    out_->append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+  // In 7-bit groups, least significant first, so small values take a byte.
+  void WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+      out_->push_back(static_cast<char>(value | 0x80));
+      value >>= 7;
+    }
+    out_->push_back(static_cast<char>(value));
+  }
+  // Zigzag encoded, so small values of either sign stay small.
+  void WriteSignedVarint(int64_t value) {
+    WriteVarint((static_cast<uint64_t>(value) << 1) ^
+                static_cast<uint64_t>(value >> 63));
+  }
+  void WriteString(absl::string_view value) {
+    Write<uint32_t>(value.size());
+    out_->append(value.data(), value.size());
+  }
+  // As Unix seconds and the ticks past them, so that times round-trip at
+  // their full resolution, infinite ones included.
+  void WriteTime(absl::Time value) {
+    if (value == absl::InfiniteFuture() || value == absl::InfinitePast()) {
+      Write<int64_t>(value == absl::InfiniteFuture() ? INT64_MAX : INT64_MIN);
+      Write<uint32_t>(0);
+      return;
+    }
+    const int64_t seconds = absl::ToUnixSeconds(value);
+    Write<int64_t>(seconds);
+    // Exact, since a second's worth of ticks fits a double's mantissa, and
+    // much cheaper than absl::IDivDuration().
+    Write<uint32_t>(absl::ToDoubleNanoseconds(
+                        value - absl::FromUnixSeconds(seconds)) *
+                    binary_io_internal::kTicksPerNanosecond);
+  }
+  void WriteOptionalTime(const std::optional<absl::Time>& value) {
+    Write<bool>(value.has_value());
+    if (value.has_value()) {
+      WriteTime(value.value());
+    }
+  }
+
+ private:
+  std::string* const out_;
+};
+
+// Reads back what a BinaryWriter wrote. Every read throws
+// std::invalid_argument if the input ends first.
+class BinaryReader {
+ public:
+  // |in| must outlive the reader.
+  explicit BinaryReader(absl::string_view in) : in_(in) {}
+
+  template <typename T>
+  T Read() {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only trivially copyable values are read raw");
+    T value;
+    std::memcpy(&value, Take(sizeof(value)), sizeof(value));
+    return value;
+  }
+  uint64_t ReadVarint();
+  int64_t ReadSignedVarint() {
+    const uint64_t value = ReadVarint();
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+  // Points into the input.
+  absl::string_view ReadString() {
+    const uint32_t size = Read<uint32_t>();
+    return absl::string_view(Take(size), size);
+  }
+  absl::Time ReadTime() {
+    const int64_t seconds = Read<int64_t>();
+    const uint32_t ticks = Read<uint32_t>();
+    if (seconds == INT64_MAX || seconds == INT64_MIN) {
+      return seconds == INT64_MAX ? absl::InfiniteFuture()
+                                  : absl::InfinitePast();
+    }
+    return absl::FromUnixSeconds(seconds) +
+           ticks * binary_io_internal::TimeTick();
+  }
+  std::optional<absl::Time> ReadOptionalTime() {
+    if (!Read<bool>()) {
+      return std::nullopt;
+    }
+    return ReadTime();
+  }
+
+  bool AtEnd() const { return in_.empty(); }
+
+ private:
+  // Consumes |size| bytes and returns where they start.
+  const char* Take(size_t size);
+
+  absl::string_view in_;
+};
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_RUNTIME_BINARY_IO_H_
@@ -0,0 +1,72 @@
+#include "runtime/binary_io.h"
+
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+
+TEST(BinaryIoTest, RoundTrips) {
+  std::string buffer;
+  BinaryWriter writer(&buffer);
+  writer.Write<uint32_t>(42);
+  writer.Write<double>(0.25);
+  writer.WriteString("pho");
+  writer.WriteString("");
+  writer.WriteTime(absl::FromUnixNanos(123456789));
+  writer.WriteTime(absl::UnixEpoch() - absl::Seconds(1. / 3));
+  writer.WriteTime(absl::InfiniteFuture());
+  writer.WriteTime(absl::InfinitePast());
+  writer.WriteOptionalTime(std::nullopt);
+  writer.WriteOptionalTime(absl::UnixEpoch());
+
+  BinaryReader reader(buffer);
+  EXPECT_EQ(reader.Read<uint32_t>(), 42);
+  EXPECT_EQ(reader.Read<double>(), 0.25);
+  EXPECT_EQ(reader.ReadString(), "pho");
+  EXPECT_EQ(reader.ReadString(), "");
+  EXPECT_EQ(reader.ReadTime(), absl::FromUnixNanos(123456789));
+  EXPECT_EQ(reader.ReadTime(), absl::UnixEpoch() - absl::Seconds(1. / 3));
+  EXPECT_EQ(reader.ReadTime(), absl::InfiniteFuture());
+  EXPECT_EQ(reader.ReadTime(), absl::InfinitePast());
+  EXPECT_EQ(reader.ReadOptionalTime(), std::nullopt);
+  EXPECT_EQ(reader.ReadOptionalTime(), absl::UnixEpoch());
+  EXPECT_TRUE(reader.AtEnd());
+}
+
+TEST(BinaryIoTest, RoundTripsVarints) {
+  std::string buffer;
+  BinaryWriter writer(&buffer);
+  writer.WriteVarint(0);
+  writer.WriteVarint(127);
+  writer.WriteVarint(128);
+  writer.WriteVarint(UINT64_MAX);
+  EXPECT_EQ(buffer.size(), 1 + 1 + 2 + 10);
+  writer.WriteSignedVarint(-1);
+  writer.WriteSignedVarint(INT64_MIN);
+  writer.WriteSignedVarint(INT64_MAX);
+
+  BinaryReader reader(buffer);
+  EXPECT_EQ(reader.ReadVarint(), 0);
+  EXPECT_EQ(reader.ReadVarint(), 127);
+  EXPECT_EQ(reader.ReadVarint(), 128);
+  EXPECT_EQ(reader.ReadVarint(), UINT64_MAX);
+  EXPECT_EQ(reader.ReadSignedVarint(), -1);
+  EXPECT_EQ(reader.ReadSignedVarint(), INT64_MIN);
+  EXPECT_EQ(reader.ReadSignedVarint(), INT64_MAX);
+  EXPECT_TRUE(reader.AtEnd());
+
+  // Continues past the last byte.
+  EXPECT_THROW(BinaryReader("\x80").ReadVarint(), std::invalid_argument);
+}
+
+TEST(BinaryIoTest, ThrowsWhenTruncated) {
+  std::string buffer;
+  BinaryWriter(&buffer).WriteString("pho");
+  buffer.pop_back();
+  BinaryReader reader(buffer);
+  EXPECT_THROW(reader.ReadString(), std::invalid_argument);
+  EXPECT_THROW(BinaryReader("").Read<uint64_t>(), std::invalid_argument);
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,102 @@
+#ifndef KITCHEN_SIM_RUNTIME_BLOCK_POOL_H_
+#define KITCHEN_SIM_RUNTIME_BLOCK_POOL_H_
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace kitchen_sim {
+
+// Recycles memory blocks sized for T. Each thread frees into and allocates
+// from a cache of its own, trading batches of blocks with a shared depot only
+// when its cache runs dry or grows large, so steady-state allocation is a
+// thread-local pop. Blocks are kept for reuse rather than returned to the
+// system.
+//
+// Meant to back class-specific operator new/delete:
+//   static void* operator new(size_t) { return BlockPool<T>::Allocate(); }
+//   static void operator delete(void* p) { BlockPool<T>::Free(p); }
+template <typename T>
+class BlockPool {
+ public:
+  static void* Allocate() {
+    Cache& cache = LocalCache();
+    if (cache.blocks.empty() && !GetDepot().Take(&cache.blocks)) {
+      return ::operator new(sizeof(T));
+    }
+    void* block = cache.blocks.back();
+    cache.blocks.pop_back();
+    return block;
+  }
+
+  static void Free(void* block) {
+    Cache& cache = LocalCache();
+    cache.blocks.push_back(block);
+    if (cache.blocks.size() >= 2 * kBatchSize) {
+      cache.GiveBatch(kBatchSize);
+    }
+  }
+
+ private:
+  // Blocks moved between a thread's cache and the depot at a time.
+  static constexpr size_t kBatchSize = 256;
+
+  class Depot {
+   public:
+    void Give(std::vector<void*> batch) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      batches_.push_back(std::move(batch));
+    }
+
+    // Swaps a batch into |blocks|, which must be empty. Returns false if the
+    // depot has none.
+    bool Take(std::vector<void*>* blocks) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (batches_.empty()) {
+        return false;
+      }
+      blocks->swap(batches_.back());
+      batches_.pop_back();
+      return true;
+    }
+
+   private:
+    std::mutex mutex_;
+    std::vector<std::vector<void*>> batches_;
+  };
+
+  struct Cache {
+    Cache() { blocks.reserve(2 * kBatchSize); }
+    // Hands everything back so blocks freed on exiting threads are reused.
+    ~Cache() { GiveBatch(blocks.size()); }
+
+    void GiveBatch(size_t count) {
+      if (count == 0) {
+        return;
+      }
+      std::vector<void*> batch(blocks.end() - count, blocks.end());
+      blocks.resize(blocks.size() - count);
+      GetDepot().Give(std::move(batch));
+    }
+
+    std::vector<void*> blocks;
+  };
+
+  // Never destroyed, so that caches of threads outliving static destruction
+  // can still return to it.
+  static Depot& GetDepot() {
+    static Depot* depot = new Depot();
+    return *depot;
+  }
+
+  static Cache& LocalCache() {
+    thread_local Cache cache;
+    return cache;
+  }
+};
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_RUNTIME_BLOCK_POOL_H_
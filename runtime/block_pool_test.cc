@@ -0,0 +1,41 @@
+#include "runtime/block_pool.h"
+
+#include <thread>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+
+struct Block {
+  char bytes[48];
+};
+
+TEST(BlockPoolTest, ReusesFreedBlocks) {
+  void* first = BlockPool<Block>::Allocate();
+  BlockPool<Block>::Free(first);
+  EXPECT_EQ(BlockPool<Block>::Allocate(), first);
+  BlockPool<Block>::Free(first);
+}
+
+TEST(BlockPoolTest, ReusesBlocksFreedOnExitedThreads) {
+  void* block = nullptr;
+  std::thread([&] {
+    block = BlockPool<Block>::Allocate();
+    BlockPool<Block>::Free(block);
+  }).join();
+
+  // The exiting thread handed its cache to the depot.
+  std::vector<void*> blocks;
+  bool reused = false;
+  for (int i = 0; i < 1024 && !reused; ++i) {
+    blocks.push_back(BlockPool<Block>::Allocate());
+    reused = blocks.back() == block;
+  }
+  EXPECT_TRUE(reused);
+  for (void* allocated : blocks) {
+    BlockPool<Block>::Free(allocated);
+  }
+}
+
+}  // namespace kitchen_sim
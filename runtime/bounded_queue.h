@@ -0,0 +1,112 @@
+#ifndef KITCHEN_SIM_RUNTIME_BOUNDED_QUEUE_H_
+#define KITCHEN_SIM_RUNTIME_BOUNDED_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace kitchen_sim {
+
+// Fixed-capacity lock-free queue safe for any number of concurrent producers
+// and consumers (Vyukov's bounded MPMC design). Each slot carries a sequence
+// number that tells producers and consumers whose turn it is, so an operation
+// costs one CAS on the shared position plus one release store on the slot.
+//
+// T must be default-constructible and movable.
+template <typename T>
+class BoundedQueue {
+ public:
+  // |capacity| must be a power of two.
+  explicit BoundedQueue(size_t capacity)
+      : cells_(new Cell[capacity]), mask_(capacity - 1) {
+    if (capacity < 2 || (capacity & mask_) != 0) {
+      throw std::invalid_argument(
+          "BoundedQueue capacity must be a power of two!");
+    }
+    for (size_t i = 0; i < capacity; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+  BoundedQueue(BoundedQueue const&) = delete;
+  BoundedQueue& operator=(BoundedQueue const&) = delete;
+
+  // Returns false without blocking if the queue is full, leaving |value|
+  // untouched.
+  bool TryPush(T&& value) {
+    size_t position = enqueue_position_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells_[position & mask_];
+      const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      const intptr_t diff =
+          static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+      if (diff == 0) {
+        if (enqueue_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          cell.value = std::move(value);
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;  // Full.
+      } else {
+        position = enqueue_position_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+  bool TryPush(const T& value) {
+    T copy = value;
+    return TryPush(std::move(copy));
+  }
+
+  // Returns false without blocking if the queue is empty.
+  bool TryPop(T* value) {
+    size_t position = dequeue_position_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells_[position & mask_];
+      const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      const intptr_t diff = static_cast<intptr_t>(sequence) -
+                            static_cast<intptr_t>(position + 1);
+      if (diff == 0) {
+        if (dequeue_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          *value = std::move(cell.value);
+          cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;  // Empty.
+      } else {
+        position = dequeue_position_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  size_t Capacity() const { return mask_ + 1; }
+
+  // Approximate when called concurrently with pushes or pops.
+  size_t SizeApprox() const {
+    const size_t enqueued = enqueue_position_.load(std::memory_order_relaxed);
+    const size_t dequeued = dequeue_position_.load(std::memory_order_relaxed);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  static constexpr size_t kCacheLineSize = 64;
+
+  const std::unique_ptr<Cell[]> cells_;
+  const size_t mask_;
+  // Kept on separate cache lines so producers and consumers don't contend.
+  alignas(kCacheLineSize) std::atomic<size_t> enqueue_position_{0};
+  alignas(kCacheLineSize) std::atomic<size_t> dequeue_position_{0};
+};
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_RUNTIME_BOUNDED_QUEUE_H_
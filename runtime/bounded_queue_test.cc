@@ -0,0 +1,66 @@
+#include "runtime/bounded_queue.h"
+
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+
+TEST(BoundedQueueTest, FifoUntilFull) {
+  BoundedQueue<int> queue(4);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.TryPush(i));
+  }
+  EXPECT_FALSE(queue.TryPush(4));
+  EXPECT_EQ(queue.SizeApprox(), 4);
+
+  int value;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.TryPop(&value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(queue.TryPop(&value));
+}
+
+TEST(BoundedQueueTest, RejectsCapacityNotPowerOfTwo) {
+  EXPECT_THROW(BoundedQueue<int>(6), std::invalid_argument);
+}
+
+TEST(BoundedQueueTest, ConcurrentProducersLoseNothing) {
+  constexpr int kProducers = 4;
+  constexpr int kPerProducer = 10000;
+  BoundedQueue<int> queue(64);
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&, p] {
+      for (int i = 0; i < kPerProducer; ++i) {
+        while (!queue.TryPush(p * kPerProducer + i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  // Each producer's values must come out in the order pushed.
+  std::vector<int> next(kProducers, 0);
+  int popped = 0;
+  int value;
+  while (popped < kProducers * kPerProducer) {
+    if (!queue.TryPop(&value)) {
+      std::this_thread::yield();
+      continue;
+    }
+    const int producer = value / kPerProducer;
+    EXPECT_EQ(value % kPerProducer, next[producer]);
+    next[producer] = value % kPerProducer + 1;
+    ++popped;
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_FALSE(queue.TryPop(&value));
+}
+
+}  // namespace kitchen_sim
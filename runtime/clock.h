@@ -0,0 +1,45 @@
+#ifndef KITCHEN_SIM_RUNTIME_CLOCK_H_
+#define KITCHEN_SIM_RUNTIME_CLOCK_H_
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace kitchen_sim {
+
+// Source of the current simulation time.
+class Clock {
+ public:
+  virtual ~Clock() = default;
+
+  virtual absl::Time Now() const = 0;
+};
+
+// Wall clock time as reported by absl::Now().
+class RealClock : public Clock {
+ public:
+  absl::Time Now() const override { return absl::Now(); }
+};
+
+// Clock that only moves when explicitly advanced. Not thread-safe; intended to
+// be driven by a single discrete-event loop.
+class VirtualClock : public Clock {
+ public:
+  explicit VirtualClock(absl::Time start_time = absl::UnixEpoch())
+      : now_(start_time) {}
+
+  absl::Time Now() const override { return now_; }
+
+  // Moves the clock forward to |at_time|. Time never moves backwards.
+  void AdvanceTo(absl::Time at_time) {
+    if (at_time > now_) {
+      now_ = at_time;
+    }
+  }
+
+ private:
+  absl::Time now_;
+};
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_RUNTIME_CLOCK_H_
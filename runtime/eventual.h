@@ -0,0 +1,62 @@
+#ifndef KITCHEN_SIM_RUNTIME_EVENTUAL_H_
+#define KITCHEN_SIM_RUNTIME_EVENTUAL_H_
+
+#include <chrono>
+#include <utility>
+#include <variant>
+
+#include "base.h"
+
+namespace kitchen_sim {
+
+// Result of an operation that usually completes before returning but may
+// finish later. A ready value is held inline, so synchronous completion costs
+// neither an allocation nor any synchronization; a pending one is backed by a
+// fibers::future fulfilled by whoever completes the operation.
+//
+// Move-only, and like a future its value may only be taken once.
+template <typename T>
+class Eventual {
+ public:
+  // Ready with |value|.
+  Eventual(T value) : state_(std::in_place_index<0>, std::move(value)) {}
+  // Pending until |future| is.
+  Eventual(fibers::future<T> future)
+      : state_(std::in_place_index<1>, std::move(future)) {}
+  Eventual(Eventual&&) = default;
+  Eventual& operator=(Eventual&&) = default;
+
+  bool IsReady() const {
+    return state_.index() == 0 ||
+           std::get<1>(state_).wait_for(std::chrono::seconds(0)) ==
+               fibers::future_status::ready;
+  }
+
+  // Blocks the calling fiber until the value is available.
+  void Wait() const {
+    if (state_.index() == 1) {
+      std::get<1>(state_).wait();
+    }
+  }
+
+  // Waits for and takes the value.
+  T Get() {
+    if (state_.index() == 0) {
+      return std::move(std::get<0>(state_));
+    }
+    return std::get<1>(state_).get();
+  }
+
+ private:
+  std::variant<T, fibers::future<T>> state_;
+};
+
+}  // namespace kitchen_sim
+
+// Overloads WaitAndGet() from base.h, and so lives alongside it.
+template <typename T>
+T WaitAndGet(kitchen_sim::Eventual<T> eventual) {
+  return eventual.Get();
+}
+
+#endif  // KITCHEN_SIM_RUNTIME_EVENTUAL_H_
@@ -0,0 +1,39 @@
+#include "runtime/eventual.h"
+
+#include <memory>
+
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+
+TEST(EventualTest, ReadyValue) {
+  Eventual<std::unique_ptr<int>> eventual(std::make_unique<int>(7));
+  EXPECT_TRUE(eventual.IsReady());
+  eventual.Wait();
+  std::unique_ptr<int> value = eventual.Get();
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(*value, 7);
+}
+
+TEST(EventualTest, PendingUntilPromiseSet) {
+  fibers::promise<int> promise;
+  Eventual<int> eventual(promise.get_future());
+  EXPECT_FALSE(eventual.IsReady());
+
+  promise.set_value(3);
+  EXPECT_TRUE(eventual.IsReady());
+  EXPECT_EQ(WaitAndGet(std::move(eventual)), 3);
+}
+
+TEST(EventualTest, WaitsForAnotherFiber) {
+  fibers::promise<int> promise;
+  Eventual<int> eventual(promise.get_future());
+  fibers::fiber cook([&] {
+    boost::this_fiber::yield();
+    promise.set_value(5);
+  });
+  EXPECT_EQ(eventual.Get(), 5);
+  cook.join();
+}
+
+}  // namespace kitchen_sim
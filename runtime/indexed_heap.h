@@ -0,0 +1,105 @@
+#ifndef KITCHEN_SIM_RUNTIME_INDEXED_HEAP_H_
+#define KITCHEN_SIM_RUNTIME_INDEXED_HEAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace kitchen_sim {
+
+// Binary min-heap of T pointers ordered by Key. Each element records its own
+// position in the member named by |kSlot|, so besides the usual push and pop,
+// any element can be erased or re-keyed in O(log n) without searching.
+//
+// An element may be in at most one heap per slot member at a time.
+template <typename Key, typename T, uint32_t T::*kSlot>
+class IndexedHeap {
+ public:
+  bool empty() const { return entries_.empty(); }
+  size_t size() const { return entries_.size(); }
+
+  // Element with the smallest key. The heap must not be empty.
+  T* Top() const { return entries_.front().item; }
+  const Key& TopKey() const { return entries_.front().key; }
+
+  void Push(const Key& key, T* item) {
+    entries_.push_back({key, item});
+    item->*kSlot = entries_.size() - 1;
+    SiftUp(entries_.size() - 1);
+  }
+
+  // |item| must be in the heap.
+  void Erase(T* item) {
+    const size_t slot = item->*kSlot;
+    Swap(slot, entries_.size() - 1);
+    entries_.pop_back();
+    if (slot < entries_.size()) {
+      Restore(slot);
+    }
+  }
+
+  // |item| must be in the heap.
+  void Update(T* item, const Key& key) {
+    const size_t slot = item->*kSlot;
+    entries_[slot].key = key;
+    Restore(slot);
+  }
+
+  void Clear() { entries_.clear(); }
+
+ private:
+  struct Entry {
+    Key key;
+    T* item;
+  };
+
+  void Swap(size_t a, size_t b) {
+    std::swap(entries_[a], entries_[b]);
+    entries_[a].item->*kSlot = a;
+    entries_[b].item->*kSlot = b;
+  }
+
+  // Moves the entry at |slot| up or down to where it belongs.
+  void Restore(size_t slot) {
+    if (slot > 0 && entries_[slot].key < entries_[(slot - 1) / 2].key) {
+      SiftUp(slot);
+    } else {
+      SiftDown(slot);
+    }
+  }
+
+  void SiftUp(size_t slot) {
+    while (slot > 0) {
+      const size_t parent = (slot - 1) / 2;
+      if (!(entries_[slot].key < entries_[parent].key)) {
+        return;
+      }
+      Swap(slot, parent);
+      slot = parent;
+    }
+  }
+
+  void SiftDown(size_t slot) {
+    while (true) {
+      size_t smallest = slot;
+      for (size_t child = 2 * slot + 1;
+           child <= 2 * slot + 2 && child < entries_.size(); ++child) {
+        if (entries_[child].key < entries_[smallest].key) {
+          smallest = child;
+        }
+      }
+      if (smallest == slot) {
+        return;
+      }
+      Swap(slot, smallest);
+      slot = smallest;
+    }
+  }
+
+  std::vector<Entry> entries_;
+};
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_RUNTIME_INDEXED_HEAP_H_
@@ -0,0 +1,66 @@
+#include "runtime/indexed_heap.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+
+struct Item {
+  int value = 0;
+  uint32_t slot = 0;
+};
+
+using ItemHeap = IndexedHeap<int, Item, &Item::slot>;
+
+TEST(IndexedHeapTest, PopsInKeyOrder) {
+  std::vector<Item> items(100);
+  std::mt19937 rand(1);
+  ItemHeap heap;
+  for (Item& item : items) {
+    item.value = rand() % 1000;
+    heap.Push(item.value, &item);
+  }
+  std::vector<int> popped;
+  while (!heap.empty()) {
+    EXPECT_EQ(heap.TopKey(), heap.Top()->value);
+    popped.push_back(heap.TopKey());
+    heap.Erase(heap.Top());
+  }
+  EXPECT_EQ(popped.size(), items.size());
+  EXPECT_TRUE(std::is_sorted(popped.begin(), popped.end()));
+}
+
+TEST(IndexedHeapTest, EraseAnywhere) {
+  Item a{1}, b{2}, c{3}, d{4};
+  ItemHeap heap;
+  for (Item* item : {&a, &b, &c, &d}) {
+    heap.Push(item->value, item);
+  }
+  heap.Erase(&c);
+  heap.Erase(&a);
+  EXPECT_EQ(heap.size(), 2);
+  EXPECT_EQ(heap.Top(), &b);
+  heap.Erase(&b);
+  EXPECT_EQ(heap.Top(), &d);
+}
+
+TEST(IndexedHeapTest, UpdateReorders) {
+  Item a{1}, b{2}, c{3};
+  ItemHeap heap;
+  for (Item* item : {&a, &b, &c}) {
+    heap.Push(item->value, item);
+  }
+  heap.Update(&a, 10);
+  EXPECT_EQ(heap.Top(), &b);
+  heap.Update(&c, 0);
+  EXPECT_EQ(heap.Top(), &c);
+  heap.Erase(&c);
+  heap.Erase(&b);
+  EXPECT_EQ(heap.Top(), &a);
+  EXPECT_EQ(heap.TopKey(), 10);
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,260 @@
+#include "runtime/schedule_trace.h"
+
+#include <stdexcept>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+
+namespace kitchen_sim {
+namespace {
+
+// Start time of the handler running on this thread, if any.
+thread_local const absl::Time* step_time = nullptr;
+
+class ScopedStepTime {
+ public:
+  explicit ScopedStepTime(const absl::Time* at_time) : previous_(step_time) {
+    step_time = at_time;
+  }
+  ~ScopedStepTime() { step_time = previous_; }
+
+ private:
+  const absl::Time* const previous_;
+};
+
+// Writes |at_time| as the ticks since |*previous|, and moves |*previous| to it.
+void WriteTimeDelta(absl::Time at_time, absl::Time* previous,
+                    BinaryWriter* writer) {
+  absl::Duration remainder;
+  writer->WriteSignedVarint(absl::IDivDuration(
+      at_time - *previous, binary_io_internal::TimeTick(), &remainder));
+  *previous = at_time;
+}
+
+absl::Time ReadTimeDelta(absl::Time* previous, BinaryReader* reader) {
+  *previous += reader->ReadSignedVarint() * binary_io_internal::TimeTick();
+  return *previous;
+}
+
+}  // namespace
+
+void ScheduleTrace::Write(BinaryWriter* writer) const {
+  writer->WriteVarint(clock_reads.size());
+  writer->WriteVarint(steps.size());
+  absl::Time previous = !clock_reads.empty() ? clock_reads.front()
+                        : !steps.empty()     ? steps.front().at_time
+                                             : absl::UnixEpoch();
+  writer->WriteTime(previous);
+  for (absl::Time at_time : clock_reads) {
+    WriteTimeDelta(at_time, &previous, writer);
+  }
+  for (const Step& step : steps) {
+    writer->WriteVarint(step.scheduler);
+    writer->WriteVarint(step.timer);
+    WriteTimeDelta(step.at_time, &previous, writer);
+  }
+}
+
+ScheduleTrace ScheduleTrace::Read(BinaryReader* reader) {
+  ScheduleTrace trace;
+  const uint64_t clock_read_count = reader->ReadVarint();
+  const uint64_t step_count = reader->ReadVarint();
+  absl::Time previous = reader->ReadTime();
+  for (uint64_t i = 0; i < clock_read_count; ++i) {
+    trace.clock_reads.push_back(ReadTimeDelta(&previous, reader));
+  }
+  for (uint64_t i = 0; i < step_count; ++i) {
+    Step step;
+    step.scheduler = static_cast<uint32_t>(reader->ReadVarint());
+    step.timer = reader->ReadVarint();
+    step.at_time = ReadTimeDelta(&previous, reader);
+    trace.steps.push_back(step);
+  }
+  return trace;
+}
+
+// Reads the wall clock, or the start time of the handler running on this
+// thread.
+class TraceRecorder::RecordingClock : public Clock {
+ public:
+  explicit RecordingClock(TraceRecorder* recorder) : recorder_(recorder) {}
+
+  absl::Time Now() const override {
+    if (step_time != nullptr) {
+      return *step_time;
+    }
+    std::lock_guard<std::recursive_mutex> lock(recorder_->mutex_);
+    const absl::Time now = absl::Now();
+    if (recorder_->recording_) {
+      recorder_->trace_.clock_reads.push_back(now);
+    }
+    return now;
+  }
+
+ private:
+  TraceRecorder* const recorder_;
+};
+
+// Numbers timers itself, in the order they are scheduled, so that a replay
+// numbers them the same.
+class TraceRecorder::RecordingScheduler : public Scheduler {
+ public:
+  RecordingScheduler(TraceRecorder* recorder, uint32_t index,
+                     Scheduler* scheduler)
+      : recorder_(recorder), index_(index), scheduler_(scheduler) {}
+
+  const Clock& GetClock() const override { return *recorder_->clock_; }
+
+  TimerId ScheduleAt(absl::Time at_time, Handler handler) override {
+    std::lock_guard<std::recursive_mutex> lock(recorder_->mutex_);
+    const TimerId id = next_id_++;
+    // The handler cannot start before the lock is released.
+    scheduled_[id] = scheduler_->ScheduleAt(
+        at_time, [this, id, handler = std::move(handler)]() mutable {
+          recorder_->RunStep(this, id, &handler);
+        });
+    return id;
+  }
+
+  bool Cancel(TimerId id) override {
+    std::lock_guard<std::recursive_mutex> lock(recorder_->mutex_);
+    const auto it = scheduled_.find(id);
+    if (it == scheduled_.end()) {
+      return false;
+    }
+    // Even if it is due and waiting on the lock, it will not run.
+    scheduler_->Cancel(it->second);
+    scheduled_.erase(it);
+    return true;
+  }
+
+ private:
+  friend class TraceRecorder;
+
+  TraceRecorder* const recorder_;
+  const uint32_t index_;
+  Scheduler* const scheduler_;
+  TimerId next_id_ = 0;
+  // Pending timers and their ids on |scheduler_|.
+  absl::flat_hash_map<TimerId, TimerId> scheduled_;
+};
+
+TraceRecorder::TraceRecorder()
+    : clock_(std::make_unique<RecordingClock>(this)) {}
+
+TraceRecorder::~TraceRecorder() = default;
+
+Scheduler* TraceRecorder::Record(Scheduler* scheduler) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  schedulers_.push_back(std::make_unique<RecordingScheduler>(
+      this, static_cast<uint32_t>(schedulers_.size()), scheduler));
+  return schedulers_.back().get();
+}
+
+ScheduleTrace TraceRecorder::Finish() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  recording_ = false;
+  return std::move(trace_);
+}
+
+void TraceRecorder::RunStep(RecordingScheduler* scheduler,
+                            Scheduler::TimerId id,
+                            Scheduler::Handler* handler) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (scheduler->scheduled_.erase(id) == 0) {
+    return;  // Cancelled.
+  }
+  const absl::Time now = absl::Now();
+  if (recording_) {
+    trace_.steps.push_back({scheduler->index_, id, now});
+  }
+  ScopedStepTime step(&now);
+  (*handler)();
+}
+
+// Reads the start time of the step being replayed.
+class TraceReplayer::ReplayClock : public Clock {
+ public:
+  explicit ReplayClock(TraceReplayer* replayer) : replayer_(replayer) {}
+
+  absl::Time Now() const override {
+    return replayer_->in_step_ ? replayer_->now_ : replayer_->NextClockRead();
+  }
+
+ private:
+  TraceReplayer* const replayer_;
+};
+
+// Holds handlers until the trace runs them.
+class TraceReplayer::ReplayScheduler : public Scheduler {
+ public:
+  explicit ReplayScheduler(const Clock* clock) : clock_(clock) {}
+
+  const Clock& GetClock() const override { return *clock_; }
+
+  TimerId ScheduleAt(absl::Time at_time, Handler handler) override {
+    const TimerId id = next_id_++;
+    pending_.emplace(id, std::move(handler));
+    return id;
+  }
+
+  bool Cancel(TimerId id) override { return pending_.erase(id) > 0; }
+
+ private:
+  friend class TraceReplayer;
+
+  const Clock* const clock_;
+  TimerId next_id_ = 0;
+  absl::flat_hash_map<TimerId, Handler> pending_;
+};
+
+TraceReplayer::TraceReplayer(ScheduleTrace trace)
+    : trace_(std::move(trace)),
+      clock_(std::make_unique<ReplayClock>(this)),
+      now_(trace_.steps.empty() ? absl::UnixEpoch()
+                                : trace_.steps.front().at_time) {}
+
+TraceReplayer::~TraceReplayer() = default;
+
+Scheduler* TraceReplayer::AddScheduler() {
+  schedulers_.push_back(std::make_unique<ReplayScheduler>(clock_.get()));
+  return schedulers_.back().get();
+}
+
+void TraceReplayer::Run() {
+  for (size_t i = 0; i < trace_.steps.size(); ++i) {
+    const ScheduleTrace::Step& step = trace_.steps[i];
+    if (step.scheduler >= schedulers_.size()) {
+      throw std::runtime_error(absl::StrCat(
+          "Replay step ", i, " is for unknown scheduler ", step.scheduler));
+    }
+    auto& pending = schedulers_[step.scheduler]->pending_;
+    const auto it = pending.find(step.timer);
+    if (it == pending.end()) {
+      throw std::runtime_error(
+          absl::StrCat("Replay diverged from its trace at step ", i, "!"));
+    }
+    Scheduler::Handler handler = std::move(it->second);
+    pending.erase(it);
+    now_ = step.at_time;
+    in_step_ = true;
+    handler();
+    in_step_ = false;
+  }
+  finished_ = true;
+}
+
+absl::Time TraceReplayer::NextClockRead() {
+  if (finished_) {
+    return now_;
+  }
+  if (next_clock_read_ == trace_.clock_reads.size()) {
+    throw std::runtime_error(
+        "Replay read the clock more often than its trace!");
+  }
+  return trace_.clock_reads[next_clock_read_++];
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,117 @@
+#ifndef KITCHEN_SIM_RUNTIME_SCHEDULE_TRACE_H_
+#define KITCHEN_SIM_RUNTIME_SCHEDULE_TRACE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "runtime/binary_io.h"
+#include "runtime/clock.h"
+#include "runtime/scheduler.h"
+
+namespace kitchen_sim {
+
+// Every handler a set of Schedulers ran, in the order they ran, and every time
+// read outside of them. Together with what the handlers were seeded with,
+// this pins down a multi-threaded run completely.
+struct ScheduleTrace {
+  struct Step {
+    // Index of the scheduler, in the order they were added.
+    uint32_t scheduler;
+    Scheduler::TimerId timer;
+    // Time the handler started, which it saw throughout.
+    absl::Time at_time;
+  };
+
+  // Clock reads made outside of any handler, in order.
+  std::vector<absl::Time> clock_reads;
+  std::vector<Step> steps;
+
+  // Times are written as deltas from the previous one, and everything else
+  // as varints, so that a step usually takes under ten bytes.
+  void Write(BinaryWriter* writer) const;
+  static ScheduleTrace Read(BinaryReader* reader);
+};
+
+// Records a ScheduleTrace of wall clock Schedulers whose handlers run on any
+// number of threads. Like a single core would, it runs their handlers one at a
+// time, so every handler sees what the ones before it left, and latches the
+// time each one starts at: handlers read that time, from any of the recorded
+// schedulers' clocks, for as long as they run.
+class TraceRecorder {
+ public:
+  TraceRecorder();
+  ~TraceRecorder();
+  TraceRecorder(TraceRecorder const&) = delete;
+  TraceRecorder& operator=(TraceRecorder const&) = delete;
+
+  // Returns a Scheduler, owned by the recorder, that runs handlers on
+  // |scheduler| and records them. |scheduler| must outlive the recorder.
+  Scheduler* Record(Scheduler* scheduler);
+
+  // Stops recording and returns the trace. Handlers may keep running, one at
+  // a time, but are no longer recorded.
+  ScheduleTrace Finish();
+
+ private:
+  class RecordingClock;
+  class RecordingScheduler;
+
+  // Runs |handler|, scheduled on |scheduler| as |id|, unless it was cancelled
+  // since it became due.
+  void RunStep(RecordingScheduler* scheduler, Scheduler::TimerId id,
+               Scheduler::Handler* handler);
+
+  // Recursive, since handlers schedule and cancel while holding it.
+  std::recursive_mutex mutex_;  // Guards everything below.
+  std::unique_ptr<RecordingClock> clock_;
+  std::vector<std::unique_ptr<RecordingScheduler>> schedulers_;
+  bool recording_ = true;
+  ScheduleTrace trace_;
+};
+
+// Replays a ScheduleTrace on the calling thread, as fast as possible. Handlers
+// scheduled on its Schedulers run only when the trace says, at the time it
+// says, and clock reads outside of them return the recorded ones. Run the same
+// code, seeded the same way, on them and it plays out exactly as recorded.
+class TraceReplayer {
+ public:
+  explicit TraceReplayer(ScheduleTrace trace);
+  ~TraceReplayer();
+  TraceReplayer(TraceReplayer const&) = delete;
+  TraceReplayer& operator=(TraceReplayer const&) = delete;
+
+  // Returns a Scheduler, owned by the replayer, standing in for the one
+  // recorded with the same index. Add them in the order they were recorded.
+  Scheduler* AddScheduler();
+
+  // Runs every step of the trace. Throws std::runtime_error if a step's
+  // handler is not pending, or the clock is read more often than recorded, as
+  // happens when the code or its inputs differ from the recorded run's.
+  void Run();
+
+  size_t StepCount() const { return trace_.steps.size(); }
+
+ private:
+  class ReplayClock;
+  class ReplayScheduler;
+
+  // Time outside of a step: the next recorded clock read, or once the replay
+  // is over, the time of the last step.
+  absl::Time NextClockRead();
+
+  const ScheduleTrace trace_;
+  std::unique_ptr<ReplayClock> clock_;
+  std::vector<std::unique_ptr<ReplayScheduler>> schedulers_;
+  size_t next_clock_read_ = 0;
+  bool in_step_ = false;
+  bool finished_ = false;
+  absl::Time now_;
+};
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_RUNTIME_SCHEDULE_TRACE_H_
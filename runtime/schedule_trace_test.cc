@@ -0,0 +1,97 @@
+#include "runtime/schedule_trace.h"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+#include "runtime/timing_wheel.h"
+
+namespace kitchen_sim {
+namespace {
+
+// Handlers on |a| and |b| that race each other when run on several threads:
+// which of a's are cancelled by b, and when each ran, depend on the timing.
+void Race(Scheduler* a, Scheduler* b, std::vector<std::string>* log) {
+  const absl::Time start = a->Now();
+  const auto since_start = [=](Scheduler* scheduler) {
+    return absl::FormatDuration(scheduler->Now() - start);
+  };
+  auto a_ids = std::make_shared<std::vector<Scheduler::TimerId>>();
+  for (int i = 0; i < 20; ++i) {
+    a_ids->push_back(a->ScheduleAt(start + absl::Microseconds(100 * i), [=] {
+      log->push_back(absl::StrCat("a", i, " ", since_start(a)));
+      b->ScheduleAt(a->Now(), [=] {
+        log->push_back(absl::StrCat("b after a", i, " ", since_start(b)));
+      });
+    }));
+    b->ScheduleAt(start + absl::Microseconds(150 * i), [=] {
+      log->push_back(absl::StrCat("b", i, " cancels a", 19 - i, ": ",
+                                  a->Cancel((*a_ids)[19 - i])));
+    });
+  }
+}
+
+TEST(ScheduleTraceTest, ReplaysRecordedRun) {
+  std::vector<std::string> recorded;
+  std::string serialized;
+  {
+    boost::asio::io_context context;
+    TimingWheel wheel_a(context, absl::Microseconds(10));
+    TimingWheel wheel_b(context, absl::Microseconds(10));
+    TraceRecorder recorder;
+    Scheduler* a = recorder.Record(&wheel_a);
+    Race(a, recorder.Record(&wheel_b), &recorded);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back([&] { context.run(); });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    const ScheduleTrace trace = recorder.Finish();
+    EXPECT_EQ(trace.clock_reads.size(), 1);
+    EXPECT_EQ(trace.steps.size(), recorded.size());
+    BinaryWriter writer(&serialized);
+    trace.Write(&writer);
+  }
+
+  BinaryReader reader(serialized);
+  TraceReplayer replayer(ScheduleTrace::Read(&reader));
+  EXPECT_TRUE(reader.AtEnd());
+  std::vector<std::string> replayed;
+  Scheduler* a = replayer.AddScheduler();
+  Race(a, replayer.AddScheduler(), &replayed);
+  replayer.Run();
+  EXPECT_EQ(replayed, recorded);
+}
+
+TEST(ScheduleTraceTest, ThrowsWhenReplayDiverges) {
+  ScheduleTrace trace;
+  std::vector<std::string> recorded;
+  {
+    boost::asio::io_context context;
+    TimingWheel wheel_a(context);
+    TimingWheel wheel_b(context);
+    TraceRecorder recorder;
+    Scheduler* a = recorder.Record(&wheel_a);
+    Race(a, recorder.Record(&wheel_b), &recorded);
+    context.run();
+    trace = recorder.Finish();
+  }
+
+  TraceReplayer replayer(trace);
+  Scheduler* a = replayer.AddScheduler();
+  replayer.AddScheduler();
+  // Nothing was scheduled, so the first step has no handler to run.
+  EXPECT_THROW(replayer.Run(), std::runtime_error);
+  a->Now();
+  // Only one read was recorded.
+  EXPECT_THROW(a->Now(), std::runtime_error);
+}
+
+}  // namespace
+}  // namespace kitchen_sim
@@ -0,0 +1,50 @@
+#include "runtime/scheduler.h"
+
+#include <algorithm>
+
+namespace kitchen_sim {
+
+Scheduler::TimerId VirtualScheduler::ScheduleAt(absl::Time at_time,
+                                                Handler handler) {
+  const TimerId id = next_id_++;
+  // Events in the past run at the current time, preserving clock monotonicity.
+  events_.push({std::max(at_time, clock_.Now()), id, std::move(handler)});
+  pending_.insert(id);
+  return id;
+}
+
+bool VirtualScheduler::Cancel(TimerId id) { return pending_.erase(id) > 0; }
+
+void VirtualScheduler::RunUntil(absl::Time until) {
+  while (!events_.empty() && events_.top().at_time <= until) {
+    // priority_queue::top() is const; the event is popped before running so
+    // handlers are free to schedule more events.
+    Event event = std::move(const_cast<Event&>(events_.top()));
+    events_.pop();
+    if (pending_.erase(event.id) == 0) {
+      continue;  // Cancelled.
+    }
+    clock_.AdvanceTo(event.at_time);
+    event.handler();
+  }
+  if (until != absl::InfiniteFuture()) {
+    clock_.AdvanceTo(until);
+  }
+}
+
+void RestoredTimers::ScheduleAll(Scheduler* scheduler) {
+  std::sort(timers_.begin(), timers_.end(),
+            [](const Timer& a, const Timer& b) {
+              return a.original_id < b.original_id;
+            });
+  for (Timer& timer : timers_) {
+    const Scheduler::TimerId id =
+        scheduler->ScheduleAt(timer.at_time, std::move(timer.handler));
+    if (timer.new_id != nullptr) {
+      *timer.new_id = id;
+    }
+  }
+  timers_.clear();
+}
+
+}  // namespace kitchen_sim
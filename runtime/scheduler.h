@@ -0,0 +1,116 @@
+#ifndef KITCHEN_SIM_RUNTIME_SCHEDULER_H_
+#define KITCHEN_SIM_RUNTIME_SCHEDULER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <unordered_set>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "runtime/clock.h"
+#include "runtime/unique_function.h"
+
+namespace kitchen_sim {
+
+// Runs handlers at absolute times measured against a Clock. Handlers scheduled
+// on the same Scheduler never run concurrently with each other.
+class Scheduler {
+ public:
+  using Handler = UniqueFunction<void()>;
+
+  // Identifies a scheduled handler. Ids are never reused by a Scheduler.
+  using TimerId = uint64_t;
+
+  virtual ~Scheduler() = default;
+
+  virtual const Clock& GetClock() const = 0;
+  absl::Time Now() const { return GetClock().Now(); }
+
+  // Runs |handler| once the clock reaches |at_time|. Handlers due at the same
+  // time run in the order they were scheduled.
+  virtual TimerId ScheduleAt(absl::Time at_time, Handler handler) = 0;
+  TimerId ScheduleAfter(absl::Duration delay, Handler handler) {
+    return ScheduleAt(Now() + delay, std::move(handler));
+  }
+
+  // Prevents a pending handler from running. Returns false if it already ran
+  // or was cancelled before.
+  virtual bool Cancel(TimerId id) = 0;
+};
+
+// Discrete-event scheduler over a VirtualClock. Nothing runs until Run() is
+// called, which then executes handlers in time order as fast as possible,
+// jumping the clock from one event to the next. Handlers due at the same time
+// run in the order they were scheduled.
+class VirtualScheduler : public Scheduler {
+ public:
+  explicit VirtualScheduler(absl::Time start_time = absl::UnixEpoch())
+      : clock_(start_time) {}
+  VirtualScheduler(VirtualScheduler const&) = delete;
+  VirtualScheduler& operator=(VirtualScheduler const&) = delete;
+
+  const Clock& GetClock() const override { return clock_; }
+  TimerId ScheduleAt(absl::Time at_time, Handler handler) override;
+  bool Cancel(TimerId id) override;
+
+  // Runs events until none are pending, including any scheduled by handlers.
+  void Run() { RunUntil(absl::InfiniteFuture()); }
+
+  // Runs all events due at or before |until|, then advances the clock to
+  // |until| (unless it is infinite).
+  void RunUntil(absl::Time until);
+
+  size_t PendingCount() const { return pending_.size(); }
+
+ private:
+  struct Event {
+    absl::Time at_time;
+    TimerId id;
+    Handler handler;
+  };
+  struct Later {
+    bool operator()(const Event& a, const Event& b) const {
+      return a.at_time != b.at_time ? a.at_time > b.at_time : a.id > b.id;
+    }
+  };
+
+  VirtualClock clock_;
+  TimerId next_id_ = 0;
+  std::priority_queue<Event, std::vector<Event>, Later> events_;
+  std::unordered_set<TimerId> pending_;  // Excludes cancelled events.
+};
+
+// Timers read back from a checkpoint, keyed by the ids they had when it was
+// taken. Scheduling them in order of those ids keeps the order in which timers
+// due at the same time run, since VirtualScheduler breaks such ties by id, so
+// a restored simulation plays out exactly as the original would have.
+class RestoredTimers {
+ public:
+  // |new_id|, if set, receives the timer's id once scheduled.
+  void Add(Scheduler::TimerId original_id, absl::Time at_time,
+           Scheduler::Handler handler, Scheduler::TimerId* new_id = nullptr) {
+    timers_.push_back({original_id, at_time, std::move(handler), new_id});
+  }
+
+  // Schedules every timer added so far on |scheduler|, in order of their
+  // original ids, and forgets them.
+  void ScheduleAll(Scheduler* scheduler);
+
+  size_t size() const { return timers_.size(); }
+
+ private:
+  struct Timer {
+    Scheduler::TimerId original_id;
+    absl::Time at_time;
+    Scheduler::Handler handler;
+    Scheduler::TimerId* new_id;
+  };
+
+  std::vector<Timer> timers_;
+};
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_RUNTIME_SCHEDULER_H_
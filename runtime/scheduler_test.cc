@@ -0,0 +1,82 @@
+#include "runtime/scheduler.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+
+TEST(VirtualSchedulerTest, RunsInTimeOrder) {
+  VirtualScheduler scheduler;
+  std::vector<int> ran;
+  scheduler.ScheduleAt(absl::UnixEpoch() + absl::Seconds(3),
+                       [&] { ran.push_back(3); });
+  scheduler.ScheduleAt(absl::UnixEpoch() + absl::Seconds(1),
+                       [&] { ran.push_back(1); });
+  scheduler.ScheduleAt(absl::UnixEpoch() + absl::Seconds(1),
+                       [&] { ran.push_back(2); });  // Ties run FIFO.
+  scheduler.Run();
+
+  EXPECT_THAT(ran, testing::ElementsAre(1, 2, 3));
+  EXPECT_EQ(scheduler.Now(), absl::UnixEpoch() + absl::Seconds(3));
+}
+
+TEST(VirtualSchedulerTest, HandlersObserveEventTime) {
+  VirtualScheduler scheduler;
+  std::vector<absl::Time> seen;
+  scheduler.ScheduleAfter(absl::Seconds(5), [&] {
+    seen.push_back(scheduler.Now());
+    scheduler.ScheduleAfter(absl::Seconds(2),
+                            [&] { seen.push_back(scheduler.Now()); });
+  });
+  scheduler.Run();
+
+  EXPECT_THAT(seen, testing::ElementsAre(absl::UnixEpoch() + absl::Seconds(5),
+                                         absl::UnixEpoch() + absl::Seconds(7)));
+}
+
+TEST(VirtualSchedulerTest, Cancel) {
+  VirtualScheduler scheduler;
+  bool ran = false;
+  auto id = scheduler.ScheduleAfter(absl::Seconds(1), [&] { ran = true; });
+
+  EXPECT_TRUE(scheduler.Cancel(id));
+  EXPECT_FALSE(scheduler.Cancel(id));
+  scheduler.Run();
+  EXPECT_FALSE(ran);
+}
+
+TEST(VirtualSchedulerTest, RunUntil) {
+  VirtualScheduler scheduler;
+  int ran = 0;
+  scheduler.ScheduleAfter(absl::Seconds(1), [&] { ++ran; });
+  scheduler.ScheduleAfter(absl::Seconds(10), [&] { ++ran; });
+  scheduler.RunUntil(absl::UnixEpoch() + absl::Seconds(5));
+
+  EXPECT_EQ(ran, 1);
+  EXPECT_EQ(scheduler.Now(), absl::UnixEpoch() + absl::Seconds(5));
+  EXPECT_EQ(scheduler.PendingCount(), 1);
+}
+
+TEST(RestoredTimersTest, KeepsOriginalTieOrder) {
+  VirtualScheduler scheduler;
+  const absl::Time at_time = absl::UnixEpoch() + absl::Seconds(1);
+  std::vector<int> ran;
+  Scheduler::TimerId first_id = 0;
+  RestoredTimers timers;
+  timers.Add(/*original_id=*/9, at_time, [&] { ran.push_back(2); });
+  timers.Add(/*original_id=*/4, at_time, [&] { ran.push_back(1); },
+             &first_id);
+  timers.Add(/*original_id=*/2, at_time + absl::Seconds(1),
+             [&] { ran.push_back(3); });
+  EXPECT_EQ(timers.size(), 3);
+  timers.ScheduleAll(&scheduler);
+  EXPECT_EQ(timers.size(), 0);
+  EXPECT_EQ(scheduler.PendingCount(), 3);
+
+  EXPECT_TRUE(scheduler.Cancel(first_id));
+  scheduler.ScheduleAt(at_time, [&] { ran.push_back(4); });
+  scheduler.Run();
+  EXPECT_THAT(ran, testing::ElementsAre(2, 4, 3));
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,140 @@
+#include "runtime/sharded_executor.h"
+
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace kitchen_sim {
+namespace {
+
+std::vector<int> AllowedCpus() {
+  std::vector<int> cpus;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+#endif
+  return cpus;
+}
+
+// Best effort: the thread runs unpinned if this fails.
+void PinCurrentThread(int cpu) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+
+}  // namespace
+
+ShardedExecutor::ShardedExecutor(Options options)
+    : options_(options), cpus_(AllowedCpus()) {
+  if (options_.shard_count == 0) {
+    throw std::invalid_argument("ShardedExecutor needs at least one shard!");
+  }
+  for (size_t i = 0; i < options_.shard_count; ++i) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+}
+
+void ShardedExecutor::Post(size_t shard, Scheduler::Handler handler) {
+  Shard& target = *shards_[shard];
+  // Counted before it is visible, so the shard can't go idle for good with it
+  // queued. Pairs with the store to |idle| in RunShard().
+  target.queued.fetch_add(1, std::memory_order_seq_cst);
+  boost::asio::post(target.context,
+                    [&target, handler = std::move(handler)]() mutable {
+                      target.queued.fetch_sub(1, std::memory_order_relaxed);
+                      handler();
+                    });
+  if (target.idle.load(std::memory_order_seq_cst)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wake_.notify_all();
+  }
+}
+
+void ShardedExecutor::Run() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_ = false;
+    error_ = nullptr;
+    // Before any thread starts, so none mistakes the others for idle.
+    for (const auto& shard : shards_) {
+      shard->idle.store(false);
+      shard->context.restart();
+    }
+  }
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    threads.emplace_back([this, i] { RunShard(i); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+}
+
+void ShardedExecutor::RunShard(size_t index) {
+  if (options_.pin_threads && !cpus_.empty()) {
+    PinCurrentThread(cpus_[index % cpus_.size()]);
+  }
+  Shard& shard = *shards_[index];
+  try {
+    for (;;) {
+      shard.context.run();
+      std::unique_lock<std::mutex> lock(mutex_);
+      shard.idle.store(true, std::memory_order_seq_cst);
+      if (AllIdle()) {
+        // No handler is running, so none can post anything.
+        done_ = true;
+        wake_.notify_all();
+      }
+      wake_.wait(lock, [&] {
+        return done_ || shard.queued.load(std::memory_order_seq_cst) > 0;
+      });
+      if (done_) {
+        return;
+      }
+      shard.idle.store(false, std::memory_order_seq_cst);
+      lock.unlock();
+      shard.context.restart();
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!error_) {
+      error_ = std::current_exception();
+    }
+    done_ = true;
+    for (const auto& other : shards_) {
+      other->context.stop();
+    }
+    wake_.notify_all();
+  }
+}
+
+bool ShardedExecutor::AllIdle() const {
+  for (const auto& shard : shards_) {
+    if (!shard->idle.load(std::memory_order_seq_cst) ||
+        shard->queued.load(std::memory_order_seq_cst) > 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,87 @@
+#ifndef KITCHEN_SIM_RUNTIME_SHARDED_EXECUTOR_H_
+#define KITCHEN_SIM_RUNTIME_SHARDED_EXECUTOR_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "base.h"
+#include "runtime/scheduler.h"
+
+namespace kitchen_sim {
+
+// Thread-per-core executor: a fixed set of shards, each an io_context run by a
+// thread of its own, optionally pinned to a CPU. Whatever is bound to a
+// shard's context (timers, strands, TimingWheels) only ever runs on that
+// thread, so it neither contends with nor shares cache lines with the other
+// shards. The one way across is Post().
+//
+// Code bound to a shard must not touch another shard's context directly: a
+// shard that ran out of work waits for a Post(), and would never notice.
+class ShardedExecutor {
+ public:
+  struct Options {
+    size_t shard_count = 1;
+    // Whether to pin shard i's thread to the i-th CPU this process may run on,
+    // wrapping around. Ignored where thread affinity is unsupported.
+    bool pin_threads = false;
+  };
+
+  explicit ShardedExecutor(Options options);
+  ShardedExecutor(ShardedExecutor const&) = delete;
+  ShardedExecutor& operator=(ShardedExecutor const&) = delete;
+
+  size_t ShardCount() const { return shards_.size(); }
+
+  // Bind timers and schedulers to a shard by constructing them on this.
+  boost::asio::io_context& Context(size_t shard) {
+    return shards_[shard]->context;
+  }
+
+  // Runs |handler| on |shard|'s thread, waking it if it ran out of work.
+  // Thread-safe, but once Run() has started, only call it from handlers: that
+  // is how Run() knows nothing more is coming.
+  void Post(size_t shard, Scheduler::Handler handler);
+
+  // Runs every shard on a thread of its own until all of them are out of work
+  // at once with nothing posted, like io_context::run() running out of work.
+  // If a handler throws, stops every shard and rethrows the first exception.
+  void Run();
+
+ private:
+  struct Shard {
+    // Hints that a single thread runs the context.
+    Shard() : context(1) {}
+
+    boost::asio::io_context context;
+    // Posted handlers that have yet to start.
+    std::atomic<int64_t> queued{0};
+    // Set while the shard's thread waits for a Post(). Written with |mutex_|
+    // held, but read without by Post().
+    std::atomic<bool> idle{false};
+  };
+
+  void RunShard(size_t index);
+
+  // Requires |mutex_|.
+  bool AllIdle() const;
+
+  const Options options_;
+  // CPUs this process may run on, in order.
+  const std::vector<int> cpus_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  std::mutex mutex_;  // Guards everything below.
+  std::condition_variable wake_;
+  bool done_ = false;
+  std::exception_ptr error_;
+};
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_RUNTIME_SHARDED_EXECUTOR_H_
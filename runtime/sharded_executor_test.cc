@@ -0,0 +1,73 @@
+#include "runtime/sharded_executor.h"
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "runtime/timing_wheel.h"
+
+namespace kitchen_sim {
+namespace {
+
+TEST(ShardedExecutorTest, RunsEachShardOnAThreadOfItsOwn) {
+  ShardedExecutor executor({/*shard_count=*/3});
+  std::vector<std::thread::id> threads(3);
+  std::vector<int> ran(3);
+  for (size_t shard = 0; shard < 3; ++shard) {
+    for (int i = 0; i < 10; ++i) {
+      executor.Post(shard, [&, shard] {
+        if (ran[shard]++ == 0) {
+          threads[shard] = std::this_thread::get_id();
+        }
+        EXPECT_EQ(threads[shard], std::this_thread::get_id());
+      });
+    }
+  }
+  executor.Run();
+
+  EXPECT_EQ(ran, std::vector<int>({10, 10, 10}));
+  EXPECT_NE(threads[0], threads[1]);
+  EXPECT_NE(threads[1], threads[2]);
+  EXPECT_NE(threads[0], std::this_thread::get_id());
+}
+
+// Shard 1 has nothing to do until shard 0's timer posts to it, by which time
+// it has long been idle.
+TEST(ShardedExecutorTest, PostWakesIdleShard) {
+  ShardedExecutor executor({/*shard_count=*/2, /*pin_threads=*/true});
+  TimingWheel wheel_0(executor.Context(0));
+  TimingWheel wheel_1(executor.Context(1));
+  int bounces = 0;
+  wheel_0.ScheduleAfter(absl::Milliseconds(20), [&] {
+    executor.Post(1, [&] {
+      wheel_1.ScheduleAfter(absl::Milliseconds(5), [&] {
+        ++bounces;
+        executor.Post(0, [&] { ++bounces; });
+      });
+    });
+  });
+  executor.Run();
+
+  EXPECT_EQ(bounces, 2);
+  EXPECT_EQ(wheel_0.PendingCount(), 0);
+  EXPECT_EQ(wheel_1.PendingCount(), 0);
+}
+
+TEST(ShardedExecutorTest, StopsEveryShardOnException) {
+  ShardedExecutor executor({/*shard_count=*/2});
+  TimingWheel wheel(executor.Context(1));
+  bool ran = false;
+  wheel.ScheduleAfter(absl::Hours(1), [&] { ran = true; });
+  executor.Post(0, [] { throw std::runtime_error("boom"); });
+
+  EXPECT_THROW(executor.Run(), std::runtime_error);
+  EXPECT_FALSE(ran);
+}
+
+TEST(ShardedExecutorTest, RejectsNoShards) {
+  EXPECT_THROW(ShardedExecutor({/*shard_count=*/0}), std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace kitchen_sim
@@ -0,0 +1,30 @@
+#include "runtime/string_interner.h"
+
+#include <mutex>
+
+namespace kitchen_sim {
+
+StringInterner& StringInterner::Global() {
+  static StringInterner* interner = new StringInterner();
+  return *interner;
+}
+
+absl::string_view StringInterner::Intern(absl::string_view value) {
+  {
+    // Almost every lookup hits, so readers share the lock.
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = strings_.find(value);
+    if (it != strings_.end()) {
+      return *it;
+    }
+  }
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  return *strings_.emplace(value).first;
+}
+
+size_t StringInterner::size() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return strings_.size();
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,38 @@
+#ifndef KITCHEN_SIM_RUNTIME_STRING_INTERNER_H_
+#define KITCHEN_SIM_RUNTIME_STRING_INTERNER_H_
+
+#include <cstddef>
+#include <shared_mutex>
+#include <string>
+
+#include "absl/container/node_hash_set.h"
+#include "absl/strings/string_view.h"
+
+namespace kitchen_sim {
+
+// Thread-safe, append-only dictionary of strings. Interning a string returns a
+// view of the dictionary's single copy, valid for the interner's lifetime, so
+// values that repeat endlessly (e.g. menu item names) are stored once and
+// compare by pointer.
+class StringInterner {
+ public:
+  // Process-wide dictionary; never destroyed.
+  static StringInterner& Global();
+
+  StringInterner() = default;
+  StringInterner(StringInterner const&) = delete;
+  StringInterner& operator=(StringInterner const&) = delete;
+
+  absl::string_view Intern(absl::string_view value);
+
+  size_t size() const;
+
+ private:
+  mutable std::shared_mutex mutex_;
+  // Node-based, so interned strings never move.
+  absl::node_hash_set<std::string> strings_;
+};
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_RUNTIME_STRING_INTERNER_H_
@@ -0,0 +1,21 @@
+#include "runtime/string_interner.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+
+TEST(StringInternerTest, InternsOneCopy) {
+  StringInterner interner;
+  std::string pizza = "Cheese Pizza";
+  const absl::string_view first = interner.Intern(pizza);
+  pizza[0] = 'X';  // The interner keeps its own copy.
+  const absl::string_view second = interner.Intern("Cheese Pizza");
+
+  EXPECT_EQ(first, "Cheese Pizza");
+  EXPECT_EQ(first.data(), second.data());
+  EXPECT_NE(interner.Intern("Pad Thai").data(), first.data());
+  EXPECT_EQ(interner.size(), 2);
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,253 @@
+#include "runtime/timing_wheel.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace kitchen_sim {
+
+TimingWheel::TimingWheel(boost::asio::io_context& context,
+                         absl::Duration resolution)
+    : resolution_(resolution),
+      origin_(clock_.Now()),
+      strand_(context),
+      timer_(context) {
+  heads_.fill(kNil);
+  tails_.fill(kNil);
+}
+
+int64_t TimingWheel::CeilTick(absl::Time at_time) const {
+  return absl::ToInt64Nanoseconds(absl::Ceil(at_time - origin_, resolution_)) /
+         absl::ToInt64Nanoseconds(resolution_);
+}
+
+int64_t TimingWheel::FloorTick(absl::Time at_time) const {
+  return absl::ToInt64Nanoseconds(absl::Floor(at_time - origin_, resolution_)) /
+         absl::ToInt64Nanoseconds(resolution_);
+}
+
+Scheduler::TimerId TimingWheel::ScheduleAt(absl::Time at_time,
+                                           Handler handler) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_ == 0) {
+    // Nothing to cascade; skip the idle stretch instead of stepping through it.
+    current_tick_ = std::max(current_tick_, FloorTick(clock_.Now()));
+  }
+  uint32_t index;
+  if (free_nodes_.empty()) {
+    index = nodes_.size();
+    nodes_.emplace_back();
+  } else {
+    index = free_nodes_.back();
+    free_nodes_.pop_back();
+  }
+  Node& node = nodes_[index];
+  node.tick = CeilTick(at_time);
+  node.sequence = next_sequence_++;
+  node.handler = std::move(handler);
+  Insert(index);
+  ++pending_;
+  Arm();
+  return (static_cast<TimerId>(node.generation) << 32) | index;
+}
+
+bool TimingWheel::Cancel(TimerId id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const uint32_t index = static_cast<uint32_t>(id);
+  const uint32_t generation = static_cast<uint32_t>(id >> 32);
+  if (index >= nodes_.size() || nodes_[index].generation != generation ||
+      nodes_[index].list < 0) {
+    return false;
+  }
+  Unlink(index);
+  Release(index);
+  if (pending_ == 0 && armed_tick_ >= 0) {
+    // Let the io_context run out of work.
+    timer_.cancel();
+    armed_tick_ = -1;
+  }
+  return true;
+}
+
+size_t TimingWheel::PendingCount() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_;
+}
+
+void TimingWheel::Insert(uint32_t index) {
+  const int64_t tick = nodes_[index].tick;
+  if (tick <= current_tick_) {
+    Link(index, kDueList);
+    return;
+  }
+  const uint64_t delta = tick - current_tick_;
+  for (int level = 0; level < kLevels; ++level) {
+    const int shift = kSlotBits * level;
+    if (level == kLevels - 1 || delta < (uint64_t{1} << (shift + kSlotBits))) {
+      // Out of range deadlines wait in the last slot the top level can reach.
+      const int64_t slot_tick =
+          std::min<int64_t>(tick, current_tick_ + (int64_t{1} << 32) - 1);
+      Link(index, level * kSlots + ((slot_tick >> shift) & (kSlots - 1)));
+      return;
+    }
+  }
+}
+
+void TimingWheel::Link(uint32_t index, int list) {
+  Node& node = nodes_[index];
+  node.list = list;
+  node.prev = tails_[list];
+  if (list < kDueList) {
+    // Handlers cascading down were scheduled before any that went straight
+    // into this slot, so step back past those.
+    while (node.prev != kNil && nodes_[node.prev].sequence > node.sequence) {
+      node.prev = nodes_[node.prev].prev;
+    }
+  }
+  node.next = node.prev == kNil ? heads_[list] : nodes_[node.prev].next;
+  if (node.prev == kNil) {
+    heads_[list] = index;
+  } else {
+    nodes_[node.prev].next = index;
+  }
+  if (node.next == kNil) {
+    tails_[list] = index;
+  } else {
+    nodes_[node.next].prev = index;
+  }
+  if (list < kDueList) {
+    occupied_[list / kSlots].set(list % kSlots);
+  }
+}
+
+void TimingWheel::Unlink(uint32_t index) {
+  Node& node = nodes_[index];
+  const int list = node.list;
+  if (node.prev == kNil) {
+    heads_[list] = node.next;
+  } else {
+    nodes_[node.prev].next = node.next;
+  }
+  if (node.next == kNil) {
+    tails_[list] = node.prev;
+  } else {
+    nodes_[node.next].prev = node.prev;
+  }
+  if (list < kDueList && heads_[list] == kNil) {
+    occupied_[list / kSlots].reset(list % kSlots);
+  }
+  node.list = -1;
+  node.prev = node.next = kNil;
+}
+
+void TimingWheel::Release(uint32_t index) {
+  Node& node = nodes_[index];
+  node.handler = nullptr;
+  ++node.generation;  // Invalidates outstanding TimerIds.
+  free_nodes_.push_back(index);
+  --pending_;
+}
+
+void TimingWheel::Cascade(int level) {
+  const int list =
+      level * kSlots + ((current_tick_ >> (kSlotBits * level)) & (kSlots - 1));
+  uint32_t index = heads_[list];
+  heads_[list] = tails_[list] = kNil;
+  occupied_[level].reset(list % kSlots);
+  while (index != kNil) {
+    const uint32_t next = nodes_[index].next;
+    Insert(index);
+    index = next;
+  }
+}
+
+void TimingWheel::AdvanceTo(int64_t tick) {
+  while (current_tick_ < tick) {
+    // Jump straight to the next occupied level 0 slot or rotation boundary.
+    const int index = current_tick_ & (kSlots - 1);
+    int64_t next = (current_tick_ | (kSlots - 1)) + 1;
+    for (int slot = index + 1; slot < kSlots; ++slot) {
+      if (occupied_[0].test(slot)) {
+        next = current_tick_ - index + slot;
+        break;
+      }
+    }
+    current_tick_ = std::min(next, tick);
+
+    if ((current_tick_ & (kSlots - 1)) == 0) {
+      // Higher levels first so their handlers can land in lower levels that
+      // are cascaded next.
+      int top = 1;
+      while (top < kLevels - 1 &&
+             (current_tick_ & ((int64_t{1} << (kSlotBits * (top + 1))) - 1)) ==
+                 0) {
+        ++top;
+      }
+      for (int level = top; level >= 1; --level) {
+        Cascade(level);
+      }
+    }
+
+    const int list = current_tick_ & (kSlots - 1);
+    uint32_t index_to_move = heads_[list];
+    while (index_to_move != kNil) {
+      const uint32_t next_index = nodes_[index_to_move].next;
+      Unlink(index_to_move);
+      Link(index_to_move, kDueList);
+      index_to_move = next_index;
+    }
+  }
+}
+
+int64_t TimingWheel::NextTick() const {
+  if (pending_ == 0) {
+    return -1;
+  }
+  if (heads_[kDueList] != kNil) {
+    return current_tick_;
+  }
+  const int index = current_tick_ & (kSlots - 1);
+  for (int slot = index + 1; slot < kSlots; ++slot) {
+    if (occupied_[0].test(slot)) {
+      return current_tick_ - index + slot;
+    }
+  }
+  // Nothing more in this rotation; wake up to cascade.
+  return (current_tick_ | (kSlots - 1)) + 1;
+}
+
+void TimingWheel::Arm() {
+  const int64_t next = NextTick();
+  if (next < 0 || next == armed_tick_) {
+    return;
+  }
+  if (armed_tick_ >= 0 && armed_tick_ < next) {
+    // Already waking up earlier than needed.
+    return;
+  }
+  armed_tick_ = next;
+  // Re-arming aborts any earlier wait.
+  timer_.expires_at(absl::ToChronoTime(origin_ + next * resolution_));
+  timer_.async_wait(boost::asio::bind_executor(
+      strand_, [this](const boost::system::error_code& e) { OnTimer(e); }));
+}
+
+void TimingWheel::OnTimer(const boost::system::error_code& e) {
+  if (e == boost::asio::error::operation_aborted) return;
+  std::unique_lock<std::mutex> lock(mutex_);
+  armed_tick_ = -1;
+  AdvanceTo(FloorTick(clock_.Now()));
+  while (heads_[kDueList] != kNil) {
+    // Pop handlers one at a time so that a handler can still cancel others
+    // that became due in the same tick.
+    const uint32_t index = heads_[kDueList];
+    Handler handler = std::move(nodes_[index].handler);
+    Unlink(index);
+    Release(index);
+    lock.unlock();
+    handler();
+    lock.lock();
+  }
+  Arm();
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,90 @@
+#include "runtime/timing_wheel.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+
+TEST(TimingWheelTest, RunsInDeadlineOrder) {
+  boost::asio::io_context context;
+  // 10us ticks push the later deadlines into the second level.
+  TimingWheel wheel(context, absl::Microseconds(10));
+  std::vector<int> ran;
+  wheel.ScheduleAfter(absl::Milliseconds(8), [&] { ran.push_back(3); });
+  wheel.ScheduleAfter(absl::Milliseconds(1), [&] { ran.push_back(1); });
+  wheel.ScheduleAfter(absl::Milliseconds(4), [&] { ran.push_back(2); });
+  context.run();
+
+  EXPECT_THAT(ran, testing::ElementsAre(1, 2, 3));
+  EXPECT_EQ(wheel.PendingCount(), 0);
+}
+
+TEST(TimingWheelTest, SameDeadlineRunsInScheduleOrder) {
+  boost::asio::io_context context;
+  TimingWheel wheel(context);
+  const absl::Time deadline = wheel.Now() + absl::Milliseconds(300);
+  std::vector<int> ran;
+  // The first handler starts out in the second level; once the wheel has
+  // moved on, the second goes straight into the first level, where the first
+  // later cascades down to join it.
+  wheel.ScheduleAt(deadline, [&] { ran.push_back(1); });
+  wheel.ScheduleAfter(absl::Milliseconds(100), [&] {
+    wheel.ScheduleAt(deadline, [&] { ran.push_back(2); });
+    wheel.ScheduleAt(deadline, [&] { ran.push_back(3); });
+  });
+  context.run();
+
+  EXPECT_THAT(ran, testing::ElementsAre(1, 2, 3));
+}
+
+TEST(TimingWheelTest, NeverRunsEarly) {
+  boost::asio::io_context context;
+  TimingWheel wheel(context);
+  const absl::Time deadline = wheel.Now() + absl::Milliseconds(20);
+  absl::Time ran_at;
+  wheel.ScheduleAt(deadline, [&] { ran_at = wheel.Now(); });
+  context.run();
+
+  EXPECT_GE(ran_at, deadline);
+}
+
+TEST(TimingWheelTest, HandlerSchedulesMore) {
+  boost::asio::io_context context;
+  TimingWheel wheel(context);
+  int ran = 0;
+  wheel.ScheduleAfter(absl::Milliseconds(1), [&] {
+    ++ran;
+    wheel.ScheduleAfter(absl::ZeroDuration(), [&] { ++ran; });
+  });
+  context.run();
+
+  EXPECT_EQ(ran, 2);
+}
+
+TEST(TimingWheelTest, Cancel) {
+  boost::asio::io_context context;
+  TimingWheel wheel(context);
+  bool ran = false;
+  auto id = wheel.ScheduleAfter(absl::Hours(1), [&] { ran = true; });
+
+  EXPECT_TRUE(wheel.Cancel(id));
+  EXPECT_FALSE(wheel.Cancel(id));
+  // Returns straight away since the wheel's only timer was disarmed.
+  context.run();
+  EXPECT_FALSE(ran);
+}
+
+TEST(TimingWheelTest, StaleIdDoesNotCancelReusedNode) {
+  boost::asio::io_context context;
+  TimingWheel wheel(context);
+  int ran = 0;
+  auto first = wheel.ScheduleAfter(absl::Milliseconds(1), [&] { ++ran; });
+  wheel.Cancel(first);
+  wheel.ScheduleAfter(absl::Milliseconds(1), [&] { ++ran; });
+
+  EXPECT_FALSE(wheel.Cancel(first));
+  context.run();
+  EXPECT_EQ(ran, 1);
+}
+
+}  // namespace kitchen_sim
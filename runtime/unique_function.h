@@ -0,0 +1,52 @@
+#ifndef KITCHEN_SIM_RUNTIME_UNIQUE_FUNCTION_H_
+#define KITCHEN_SIM_RUNTIME_UNIQUE_FUNCTION_H_
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace kitchen_sim {
+
+template <typename Signature>
+class UniqueFunction;
+
+// Move-only counterpart to std::function, so callables may own resources such
+// as std::unique_ptr<Order>.
+template <typename R, typename... Args>
+class UniqueFunction<R(Args...)> {
+ public:
+  UniqueFunction() = default;
+  UniqueFunction(std::nullptr_t) {}
+  template <typename F,
+            typename = std::enable_if_t<
+                !std::is_same<std::decay_t<F>, UniqueFunction>::value>>
+  UniqueFunction(F&& f)
+      : callable_(std::make_unique<Callable<std::decay_t<F>>>(
+            std::forward<F>(f))) {}
+  UniqueFunction(UniqueFunction&&) = default;
+  UniqueFunction& operator=(UniqueFunction&&) = default;
+
+  R operator()(Args... args) const {
+    return callable_->Call(std::forward<Args>(args)...);
+  }
+  explicit operator bool() const { return callable_ != nullptr; }
+
+ private:
+  struct CallableBase {
+    virtual ~CallableBase() = default;
+    virtual R Call(Args... args) = 0;
+  };
+  template <typename F>
+  struct Callable : CallableBase {
+    explicit Callable(F&& f) : f(std::move(f)) {}
+    explicit Callable(const F& f) : f(f) {}
+    R Call(Args... args) override { return f(std::forward<Args>(args)...); }
+    F f;
+  };
+
+  std::unique_ptr<CallableBase> callable_;
+};
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_RUNTIME_UNIQUE_FUNCTION_H_
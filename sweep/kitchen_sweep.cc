@@ -0,0 +1,175 @@
+#include <iostream>
+#include <thread>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "gflags/gflags.h"
+#include "ingest/order_columns.h"
+#include "ingest/order_reader.h"
+#include "sweep/parameter_sweep.h"
+#include "workload/order_generator.h"
+
+DEFINE_string(json_path, "",
+              "Path to a JSON array or newline-delimited JSON file containing "
+              "serialized orders.");
+DEFINE_string(columns_path, "",
+              "If set, sweep orders from an order columns file instead.");
+DEFINE_string(workload, "",
+              "If set, sweep a generated workload instead: 'steady', "
+              "'poisson' or 'rush'.");
+DEFINE_uint64(workload_orders, 10000, "Number of orders in --workload.");
+DEFINE_uint32(seed, 1, "Seed shared by every configuration.");
+
+DEFINE_string(kitchen_sizes, "LARGE", "Comma-separated kitchen sizes.");
+DEFINE_string(orders_per_second, "2",
+              "Comma-separated order rates. Orders that carry their arrivals "
+              "(--workload, or columns that record them) ignore the rate, "
+              "but --workload generates at the first.");
+DEFINE_string(overflow_capacities, "",
+              "Comma-separated overflow shelf capacities, overriding the "
+              "kitchen sizes'.");
+DEFINE_string(shelf_capacities, "",
+              "Comma-separated temperature shelf capacities, overriding the "
+              "kitchen sizes'.");
+DEFINE_string(couriers, "", "Comma-separated couriers per kitchen.");
+DEFINE_string(eviction_policies, "", "Comma-separated eviction policies.");
+
+DEFINE_uint32(kitchen_count, 1, "Number of kitchens sharing the orders.");
+DEFINE_uint32(courier_capacity, 1, "Most orders a courier picks up per trip.");
+DEFINE_double(courier_delivery_s, 0.,
+              "Seconds a courier spends delivering before it is free again.");
+DEFINE_uint32(parallelism, std::thread::hardware_concurrency(),
+              "Configurations simulated at once.");
+DEFINE_double(max_waste_rate, -1.,
+              "If non-negative, also list the configurations that waste at "
+              "most this share of orders.");
+
+namespace {
+
+// Parses comma-separated |flag| with |parse|. Throws std::invalid_argument on
+// any value |parse| rejects.
+template <typename T, typename Parse>
+std::vector<T> ParseList(const std::string& name, const std::string& flag,
+                         Parse parse) {
+  std::vector<T> values;
+  for (absl::string_view value :
+       absl::StrSplit(flag, ',', absl::SkipWhitespace())) {
+    T parsed;
+    if (!parse(value, &parsed)) {
+      throw std::invalid_argument(
+          absl::StrCat("Invalid --", name, " value: ", value));
+    }
+    values.push_back(parsed);
+  }
+  return values;
+}
+
+template <typename T>
+std::vector<T> ParseNumbers(const std::string& name, const std::string& flag) {
+  return ParseList<T>(name, flag, [](absl::string_view value, T* parsed) {
+    return absl::SimpleAtoi(value, parsed);
+  });
+}
+
+// Loads every order to sweep, once. Sets |arrive_at_receipt_time| if they
+// carry their arrivals.
+std::vector<std::unique_ptr<kitchen_sim::Order>> LoadOrders(
+    double orders_per_second, bool* arrive_at_receipt_time) {
+  const kitchen_sim::VirtualClock clock;
+  std::vector<std::unique_ptr<kitchen_sim::Order>> orders;
+  if (!FLAGS_workload.empty()) {
+    auto workload = kitchen_sim::OrderGenerator::Preset(FLAGS_workload);
+    workload.order_count = FLAGS_workload_orders;
+    workload.orders_per_second = orders_per_second;
+    workload.seed = FLAGS_seed;
+    kitchen_sim::OrderGenerator generator(workload);
+    for (auto order = generator.Next(); order != nullptr;
+         order = generator.Next()) {
+      orders.push_back(std::move(order));
+    }
+    *arrive_at_receipt_time = true;
+  } else if (!FLAGS_columns_path.empty()) {
+    kitchen_sim::OrderColumnsReader reader(FLAGS_columns_path, &clock);
+    orders.reserve(reader.Size());
+    for (auto it = reader.begin(); it != reader.end(); ++it) {
+      orders.push_back(std::move(*it));
+    }
+    *arrive_at_receipt_time = reader.HasArrivals();
+  } else {
+    auto reader = kitchen_sim::OpenOrderReader(FLAGS_json_path, &clock,
+                                               {/*skip_invalid_orders=*/true});
+    for (auto it = reader->begin(); it != reader->end(); ++it) {
+      orders.push_back(std::move(*it));
+    }
+    *arrive_at_receipt_time = false;
+  }
+  return orders;
+}
+
+}  // namespace
+
+// Simulates the same orders under every combination of the swept flags, in
+// parallel on virtual clocks, and prints a summary table.
+int main(int argc, char* argv[]) {
+  gflags::SetUsageMessage(
+      "kitchen_sweep --json_path=<path> | --columns_path=<path> | "
+      "--workload=rush [ --kitchen_sizes=SMALL,LARGE "
+      "--orders_per_second=10,20 --shelf_capacities=4,6,8 "
+      "--max_waste_rate=0.05 ]");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  try {
+    kitchen_sim::ParameterSweep::Grid grid;
+    grid.kitchen_sizes = absl::StrSplit(FLAGS_kitchen_sizes, ',',
+                                        absl::SkipWhitespace());
+    grid.orders_per_second = ParseList<double>(
+        "orders_per_second", FLAGS_orders_per_second,
+        [](absl::string_view value, double* parsed) {
+          return absl::SimpleAtod(value, parsed) && *parsed > 0;
+        });
+    grid.overflow_capacities =
+        ParseNumbers<int>("overflow_capacities", FLAGS_overflow_capacities);
+    grid.shelf_capacities =
+        ParseNumbers<int>("shelf_capacities", FLAGS_shelf_capacities);
+    grid.couriers_per_kitchen =
+        ParseNumbers<size_t>("couriers", FLAGS_couriers);
+    for (absl::string_view policy : absl::StrSplit(
+             FLAGS_eviction_policies, ',', absl::SkipWhitespace())) {
+      grid.eviction_policies.push_back(
+          kitchen_sim::ParseEvictionPolicyType(policy));
+    }
+
+    kitchen_sim::KitchenSimulation::Options base;
+    base.kitchen_name = "sweep";
+    base.clock = kitchen_sim::ClockType::VIRTUAL;
+    base.seed = FLAGS_seed;
+    base.kitchen_count = FLAGS_kitchen_count;
+    base.courier_capacity = FLAGS_courier_capacity;
+    base.courier_delivery_time = absl::Seconds(FLAGS_courier_delivery_s);
+    const auto orders = LoadOrders(
+        grid.orders_per_second.empty() ? base.orders_per_second
+                                       : grid.orders_per_second.front(),
+        &base.arrive_at_receipt_time);
+
+    const auto configs = kitchen_sim::ParameterSweep::Configs(base, grid);
+    std::cout << "Sweeping " << configs.size() << " configurations over "
+              << orders.size() << " orders." << std::endl;
+    const auto results =
+        kitchen_sim::ParameterSweep({FLAGS_parallelism}).Run(orders, configs);
+    std::cout << kitchen_sim::SweepSummary(results);
+    if (FLAGS_max_waste_rate >= 0) {
+      std::cout << "Waste rate at most " << FLAGS_max_waste_rate << ":"
+                << std::endl;
+      for (const auto& result : results) {
+        if (result.stats.WasteRate() <= FLAGS_max_waste_rate) {
+          std::cout << "  " << result.config.label << std::endl;
+        }
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,226 @@
+#include "sweep/parameter_sweep.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "events/event_sink.h"
+#include "metrics/histogram.h"
+#include "model/kitchen_layout.h"
+
+namespace kitchen_sim {
+namespace {
+
+// Records how long each delivered order sat on its shelf. Kitchens run on
+// threads of their own, so this only touches the lock-free histogram.
+class ShelfTimeSink : public EventSink {
+ public:
+  void Record(const Event& event, const Order& order) override {
+    if (event.type == EventType::DELIVERED &&
+        order.FulfillmentTime().has_value()) {
+      shelf_time_ms_.Record(std::max<int64_t>(
+          0, absl::ToInt64Milliseconds(event.at_time -
+                                       *order.FulfillmentTime())));
+    }
+  }
+
+  HistogramSnapshot Snapshot() const { return shelf_time_ms_.Snapshot(); }
+
+ private:
+  Histogram shelf_time_ms_;
+};
+
+void AddCourierStats(const CourierFleet::Stats& stats,
+                     CourierFleet::Stats* total) {
+  total->trips += stats.trips;
+  total->picked_up += stats.picked_up;
+  total->missed += stats.missed;
+  total->backlogged += stats.backlogged;
+  total->peak_busy += stats.peak_busy;
+  total->busy_time += stats.busy_time;
+  total->first_set_off = std::min(total->first_set_off, stats.first_set_off);
+  total->last_free = std::max(total->last_free, stats.last_free);
+}
+
+// Runs one configuration to completion.
+SweepResult RunConfig(const std::vector<std::unique_ptr<Order>>& orders,
+                      const SweepConfig& config) {
+  SweepResult result;
+  result.config = config;
+  ShelfTimeSink sink;
+  KitchenSimulation::Options options = config.options;
+  options.event_sink = &sink;
+  options.shelf_log_interval = absl::InfiniteDuration();
+  options.print_summary = false;
+
+  const absl::Time start = absl::Now();
+  KitchenSimulation simulation(options);
+  simulation.RunCopies(orders);
+  result.run_time = absl::Now() - start;
+
+  result.stats = simulation.Fleet().AggregateStats();
+  for (size_t i = 0; i < simulation.Fleet().size(); ++i) {
+    AddCourierStats(simulation.Couriers(i).GetStats(), &result.courier_stats);
+  }
+  const HistogramSnapshot shelf_time_ms = sink.Snapshot();
+  result.shelf_time_p50_ms = shelf_time_ms.Quantile(0.5);
+  result.shelf_time_p99_ms = shelf_time_ms.Quantile(0.99);
+  return result;
+}
+
+// Crosses each of |configs| with each of |values|, applied by |apply|. Leaves
+// |configs| as they are if there are no values.
+template <typename T, typename Apply>
+std::vector<SweepConfig> Cross(const std::vector<SweepConfig>& configs,
+                               const std::vector<T>& values, Apply apply) {
+  if (values.empty()) {
+    return configs;
+  }
+  std::vector<SweepConfig> crossed;
+  crossed.reserve(configs.size() * values.size());
+  for (const SweepConfig& config : configs) {
+    for (const T& value : values) {
+      crossed.push_back(config);
+      apply(value, &crossed.back());
+    }
+  }
+  return crossed;
+}
+
+void AppendLabel(absl::string_view part, SweepConfig* config) {
+  absl::StrAppend(&config->label, config->label.empty() ? "" : " ", part);
+}
+
+// The config's shelf capacities, starting from its kitchen size's.
+KitchenLayout& Shelves(SweepConfig* config) {
+  KitchenSimulation::Options& options = config->options;
+  if (!options.layout.has_value()) {
+    options.layout = KitchenSimulation::KitchenSizeLayout(options.kitchen_size);
+  }
+  return options.layout.value();
+}
+
+}  // namespace
+
+std::vector<SweepConfig> ParameterSweep::Configs(
+    const KitchenSimulation::Options& base, const Grid& grid) {
+  std::vector<SweepConfig> configs = {{"", base}};
+  configs = Cross(configs, grid.kitchen_sizes,
+                  [](const std::string& size, SweepConfig* config) {
+                    config->options.kitchen_size = size;
+                    AppendLabel(absl::StrCat("size=", size), config);
+                  });
+  configs = Cross(configs, grid.orders_per_second,
+                  [](double rate, SweepConfig* config) {
+                    config->options.orders_per_second = rate;
+                    AppendLabel(absl::StrCat("rate=", rate), config);
+                  });
+  configs = Cross(configs, grid.overflow_capacities,
+                  [](int capacity, SweepConfig* config) {
+                    Shelves(config).overflow_capacity = capacity;
+                    AppendLabel(absl::StrCat("overflow=", capacity), config);
+                  });
+  configs = Cross(configs, grid.shelf_capacities,
+                  [](int capacity, SweepConfig* config) {
+                    KitchenLayout& layout = Shelves(config);
+                    for (TemperatureType temp :
+                         {TemperatureType::FROZEN, TemperatureType::COLD,
+                          TemperatureType::HOT}) {
+                      if (layout.HasShelf(temp)) {
+                        layout.SetShelfCapacity(temp, capacity);
+                      }
+                    }
+                    AppendLabel(absl::StrCat("shelf=", capacity), config);
+                  });
+  configs = Cross(configs, grid.couriers_per_kitchen,
+                  [](size_t couriers, SweepConfig* config) {
+                    config->options.couriers_per_kitchen = couriers;
+                    AppendLabel(absl::StrCat("couriers=", couriers), config);
+                  });
+  configs = Cross(configs, grid.eviction_policies,
+                  [](EvictionPolicyType policy, SweepConfig* config) {
+                    config->options.eviction_policy = policy;
+                    AppendLabel(
+                        absl::StrCat("eviction=", EvictionPolicyName(policy)),
+                        config);
+                  });
+  for (SweepConfig& config : configs) {
+    if (config.label.empty()) {
+      config.label = "base";
+    }
+  }
+  return configs;
+}
+
+ParameterSweep::ParameterSweep(Options options) : options_(options) {
+  if (options_.parallelism == 0) {
+    throw std::invalid_argument("Sweep parallelism must be positive!");
+  }
+}
+
+std::vector<SweepResult> ParameterSweep::Run(
+    const std::vector<std::unique_ptr<Order>>& orders,
+    const std::vector<SweepConfig>& configs) const {
+  for (const SweepConfig& config : configs) {
+    if (config.options.clock != ClockType::VIRTUAL) {
+      throw std::invalid_argument(absl::StrCat(
+          "Sweep configurations must use a virtual clock: ", config.label));
+    }
+  }
+
+  // Workers claim configurations in order until none are left.
+  std::vector<SweepResult> results(configs.size());
+  std::vector<std::exception_ptr> errors(configs.size());
+  std::atomic<size_t> next{0};
+  const auto work = [&] {
+    for (size_t i = next++; i < configs.size(); i = next++) {
+      try {
+        results[i] = RunConfig(orders, configs[i]);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  const size_t thread_count =
+      std::min<size_t>(options_.parallelism, configs.size());
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads.emplace_back(work);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const std::exception_ptr& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+  return results;
+}
+
+std::string SweepSummary(const std::vector<SweepResult>& results) {
+  size_t label_width = 6;
+  for (const SweepResult& result : results) {
+    label_width = std::max(label_width, result.config.label.size());
+  }
+  std::string summary = absl::StrFormat(
+      "%-*s %10s %10s %8s %12s %9s %9s %9s %9s\n", label_width, "config",
+      "received", "delivered", "waste%", "value", "shelf_p50", "shelf_p99",
+      "trips", "run_ms");
+  for (const SweepResult& result : results) {
+    absl::StrAppendFormat(
+        &summary, "%-*s %10d %10d %8.2f %12.2f %9d %9d %9d %9d\n",
+        label_width, result.config.label, result.stats.received,
+        result.stats.delivered, 100. * result.stats.WasteRate(),
+        result.stats.delivered_value, result.shelf_time_p50_ms,
+        result.shelf_time_p99_ms, result.courier_stats.trips,
+        absl::ToInt64Milliseconds(result.run_time));
+  }
+  return summary;
+}
+
+}  // namespace kitchen_sim
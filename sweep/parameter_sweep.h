@@ -0,0 +1,92 @@
+#ifndef KITCHEN_SIM_SWEEP_PARAMETER_SWEEP_H_
+#define KITCHEN_SIM_SWEEP_PARAMETER_SWEEP_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "kitchen_sim_lib.h"
+#include "model/courier_fleet.h"
+#include "model/kitchen.h"
+#include "model/order.h"
+
+namespace kitchen_sim {
+
+// One simulation in a sweep.
+struct SweepConfig {
+  // Describes how the configuration differs from the others, e.g.
+  // "size=SMALL rate=20".
+  std::string label;
+  KitchenSimulation::Options options;
+};
+
+// What happened to the orders under one SweepConfig.
+struct SweepResult {
+  SweepConfig config;
+  // Summed over the fleet.
+  Kitchen::Stats stats;
+  CourierFleet::Stats courier_stats;
+  // Simulated milliseconds delivered orders spent on shelves, from cooked
+  // until picked up.
+  uint64_t shelf_time_p50_ms = 0;
+  uint64_t shelf_time_p99_ms = 0;
+  // Wall time the simulation took.
+  absl::Duration run_time;
+};
+
+// Runs many configurations of the same order stream side by side, for
+// capacity planning: e.g. finding the smallest shelves that keep waste under a
+// target at a given order rate.
+class ParameterSweep {
+ public:
+  struct Options {
+    // Simulations run at once. Each runs its kitchens on threads of their
+    // own, so sweeps of multi-kitchen fleets may want fewer.
+    unsigned int parallelism = std::thread::hardware_concurrency();
+  };
+
+  // Values to sweep, each crossed with all the others. An empty axis keeps
+  // the base options' value.
+  struct Grid {
+    std::vector<std::string> kitchen_sizes;
+    std::vector<double> orders_per_second;
+    // Override the kitchen size's capacities, for every temperature shelf
+    // alike.
+    std::vector<int> overflow_capacities;
+    std::vector<int> shelf_capacities;
+    std::vector<size_t> couriers_per_kitchen;
+    std::vector<EvictionPolicyType> eviction_policies;
+  };
+
+  // Every combination of |grid|'s values applied to |base|, in row-major
+  // order (the last axis varies fastest).
+  static std::vector<SweepConfig> Configs(
+      const KitchenSimulation::Options& base, const Grid& grid);
+
+  explicit ParameterSweep(Options options);
+  ParameterSweep() : ParameterSweep(Options()) {}
+  ParameterSweep(ParameterSweep const&) = delete;
+  ParameterSweep& operator=(ParameterSweep const&) = delete;
+
+  // Simulates |orders| under each of |configs|, which must use a virtual
+  // clock, and returns their results in the same order. |orders| are only
+  // read, so they are parsed once and shared by every simulation. Each
+  // simulation's summary, shelf dumps and events are suppressed. Rethrows the
+  // first simulation's exception, if any, once all have finished.
+  std::vector<SweepResult> Run(
+      const std::vector<std::unique_ptr<Order>>& orders,
+      const std::vector<SweepConfig>& configs) const;
+
+ private:
+  const Options options_;
+};
+
+// A fixed-width table of |results|, one row per configuration.
+std::string SweepSummary(const std::vector<SweepResult>& results);
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_SWEEP_PARAMETER_SWEEP_H_
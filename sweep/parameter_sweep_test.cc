@@ -0,0 +1,77 @@
+#include "sweep/parameter_sweep.h"
+
+#include "bench/synthetic_orders.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+
+KitchenSimulation::Options BaseOptions() {
+  KitchenSimulation::Options options;
+  options.kitchen_name = "sweep";
+  options.orders_per_second = 10.;
+  options.clock = ClockType::VIRTUAL;
+  options.seed = 7;
+  return options;
+}
+
+TEST(ParameterSweepTest, CrossesGrid) {
+  ParameterSweep::Grid grid;
+  grid.kitchen_sizes = {"SMALL", "LARGE"};
+  grid.orders_per_second = {5., 50.};
+  grid.shelf_capacities = {2};
+  const auto configs = ParameterSweep::Configs(BaseOptions(), grid);
+  std::vector<std::string> labels;
+  for (const SweepConfig& config : configs) {
+    labels.push_back(config.label);
+  }
+  EXPECT_THAT(labels,
+              testing::ElementsAre(
+                  "size=SMALL rate=5 shelf=2", "size=SMALL rate=50 shelf=2",
+                  "size=LARGE rate=5 shelf=2", "size=LARGE rate=50 shelf=2"));
+  // Shelf capacities start from the kitchen size's.
+  ASSERT_TRUE(configs[0].options.layout.has_value());
+  EXPECT_EQ(configs[0].options.layout->overflow_capacity, 6);
+  EXPECT_EQ(configs[0].options.layout->ShelfCapacity(TemperatureType::HOT), 2);
+  EXPECT_EQ(configs[2].options.layout->overflow_capacity, 15);
+  EXPECT_EQ(configs[3].options.orders_per_second, 50.);
+
+  EXPECT_THAT(ParameterSweep::Configs(BaseOptions(), {}), testing::SizeIs(1));
+}
+
+TEST(ParameterSweepTest, RunsConfigsOverSharedOrders) {
+  const auto orders = SyntheticOrders(500, /*seed=*/1);
+  ParameterSweep::Grid grid;
+  grid.kitchen_sizes = {"SMALL", "LARGE"};
+  grid.orders_per_second = {100.};
+  const auto configs = ParameterSweep::Configs(BaseOptions(), grid);
+
+  const auto results = ParameterSweep({/*parallelism=*/2}).Run(orders, configs);
+  ASSERT_EQ(results.size(), 2);
+  for (const SweepResult& result : results) {
+    EXPECT_EQ(result.stats.received, orders.size());
+    EXPECT_EQ(result.stats.delivered + result.stats.expired +
+                  result.stats.discarded,
+              orders.size());
+  }
+  EXPECT_EQ(results[0].config.label, "size=SMALL rate=100");
+  // Smaller shelves waste more of the same stream.
+  EXPECT_GT(results[0].stats.WasteRate(), results[1].stats.WasteRate());
+
+  // The shared orders are untouched, so a rerun matches exactly.
+  const auto rerun = ParameterSweep({/*parallelism=*/1}).Run(orders, configs);
+  for (size_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(rerun[i].stats.delivered, results[i].stats.delivered);
+    EXPECT_EQ(rerun[i].stats.delivered_value, results[i].stats.delivered_value);
+  }
+  EXPECT_THAT(SweepSummary(results), testing::HasSubstr("size=LARGE rate=100"));
+}
+
+TEST(ParameterSweepTest, RequiresVirtualClock) {
+  KitchenSimulation::Options options = BaseOptions();
+  options.clock = ClockType::WALL;
+  EXPECT_THROW(ParameterSweep().Run({}, {{"wall", options}}),
+               std::invalid_argument);
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,102 @@
+#include <fstream>
+#include <iostream>
+
+#include "absl/strings/str_split.h"
+#include "gflags/gflags.h"
+#include "ingest/order_columns.h"
+#include "single_include/nlohmann/json.hpp"
+#include "workload/order_generator.h"
+
+DEFINE_string(workload, "poisson",
+              "Workload preset: 'steady', 'poisson' or 'rush' (diurnal with "
+              "lunch and dinner peaks).");
+DEFINE_uint64(order_count, 1000, "Number of orders to generate.");
+DEFINE_double(orders_per_second, 2., "Mean arrival rate before modulation.");
+DEFINE_uint32(seed, 1, "Seed; the same seed yields the same orders.");
+DEFINE_string(regions, "", "Comma-separated routing regions to draw from.");
+DEFINE_string(output, "", "File to write to instead of stdout.");
+DEFINE_string(format, "ndjson",
+              "Output format: 'ndjson', or 'columns' for an order columns "
+              "file that records arrivals (see //ingest:order_columns).");
+
+static bool IsValidWorkload(const char* flagname, const std::string& value) {
+  return value == "steady" || value == "poisson" || value == "rush";
+}
+DEFINE_validator(workload, &IsValidWorkload);
+
+static bool IsValidFormat(const char* flagname, const std::string& value) {
+  return value == "ndjson" || value == "columns";
+}
+DEFINE_validator(format, &IsValidFormat);
+
+static bool IsPositive(const char* flagname, double value) { return value > 0; }
+DEFINE_validator(orders_per_second, &IsPositive);
+
+namespace {
+
+const char* TemperatureString(kitchen_sim::TemperatureType temp) {
+  switch (temp) {
+    case kitchen_sim::TemperatureType::HOT:
+      return "hot";
+    case kitchen_sim::TemperatureType::COLD:
+      return "cold";
+    default:
+      return "frozen";
+  }
+}
+
+}  // namespace
+
+// Writes a generated workload as newline-delimited JSON orders, in arrival
+// order, for replay with kitchen_sim --json_path, or as an order columns file
+// for kitchen_sim --columns_path.
+int main(int argc, char* argv[]) {
+  gflags::SetUsageMessage(
+      "generate_orders [ --workload=rush --order_count=100000 "
+      "--orders_per_second=50 --seed=42 --regions=north,south "
+      "--output=orders.ndjson --format=ndjson ]");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  auto options = kitchen_sim::OrderGenerator::Preset(FLAGS_workload);
+  options.order_count = FLAGS_order_count;
+  options.orders_per_second = FLAGS_orders_per_second;
+  options.seed = FLAGS_seed;
+  if (!FLAGS_regions.empty()) {
+    options.regions = absl::StrSplit(FLAGS_regions, ',');
+  }
+
+  const bool columns = FLAGS_format == "columns";
+  std::ofstream file;
+  if (!FLAGS_output.empty()) {
+    file.open(FLAGS_output, columns ? std::ios::binary : std::ios::out);
+  }
+  std::ostream& out = FLAGS_output.empty() ? std::cout : file;
+  try {
+    kitchen_sim::OrderGenerator generator(options);
+    if (columns) {
+      kitchen_sim::OrderColumnsWriter writer({/*record_arrivals=*/true});
+      for (auto order = generator.Next(); order != nullptr;
+           order = generator.Next()) {
+        writer.Add(*order);
+      }
+      writer.WriteTo(out);
+      return 0;
+    }
+    for (auto order = generator.Next(); order != nullptr;
+         order = generator.Next()) {
+      nlohmann::json json = {{"id", order->id_.ToString()},
+                             {"name", std::string(order->name_)},
+                             {"temp", TemperatureString(order->temp_)},
+                             {"shelfLife", order->shelf_life_s_},
+                             {"decayRate", order->decay_rate_}};
+      if (!order->region_.empty()) {
+        json["region"] = order->region_;
+      }
+      out << json.dump() << '\n';
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return -1;
+  }
+  return out ? 0 : -1;
+}
@@ -0,0 +1,204 @@
+#include "workload/order_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "absl/strings/str_cat.h"
+
+namespace kitchen_sim {
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Fixed so that draws don't depend on unordered_map iteration order.
+constexpr TemperatureType kTemps[] = {
+    TemperatureType::HOT, TemperatureType::COLD, TemperatureType::FROZEN};
+
+const std::vector<std::string>& MenuFor(TemperatureType temp) {
+  static const auto* kHot = new std::vector<std::string>{
+      "Cheese Pizza", "Pad Thai", "Beef Stew", "Xiao Long Bao"};
+  static const auto* kCold = new std::vector<std::string>{
+      "Poke Bowl", "Caesar Salad", "Cold Brew"};
+  static const auto* kFrozen =
+      new std::vector<std::string>{"Ice Cream", "Acai Bowl", "Popsicle"};
+  switch (temp) {
+    case TemperatureType::HOT:
+      return *kHot;
+    case TemperatureType::COLD:
+      return *kCold;
+    default:
+      return *kFrozen;
+  }
+}
+
+void ValidateDistribution(const ValueDistribution& distribution,
+                          absl::string_view name) {
+  if (distribution.kind == ValueDistribution::Kind::UNIFORM
+          ? distribution.a > distribution.b
+          : distribution.b < 0.) {
+    throw std::invalid_argument(
+        absl::StrCat("Invalid ", name, " distribution!"));
+  }
+}
+
+}  // namespace
+
+OrderGenerator::Options OrderGenerator::Preset(absl::string_view name) {
+  Options options;
+  if (name == "steady") {
+    options.arrival = ArrivalProcess::FIXED;
+  } else if (name == "poisson") {
+    options.arrival = ArrivalProcess::POISSON;
+  } else if (name == "rush") {
+    // Offsets assume the stream starts at midnight.
+    options.arrival = ArrivalProcess::DIURNAL;
+    options.diurnal_amplitude = 0.6;
+    options.bursts = {
+        {absl::Hours(11) + absl::Minutes(30), absl::Hours(2), 3.},
+        {absl::Hours(17) + absl::Minutes(30), absl::Minutes(150), 4.},
+    };
+    options.temp_mix = {
+        {TemperatureType::HOT, 3.},
+        {TemperatureType::COLD, 2.},
+        {TemperatureType::FROZEN, 1.},
+    };
+  } else {
+    throw std::invalid_argument(absl::StrCat("Unknown workload: ", name));
+  }
+  return options;
+}
+
+OrderGenerator::OrderGenerator(const Options& options)
+    : options_(options), max_rate_(MaxRate()), rand_(options_.seed) {
+  if (!(options_.orders_per_second > 0.)) {
+    throw std::invalid_argument("Order rate must be positive!");
+  }
+  if (options_.diurnal_period <= absl::ZeroDuration() ||
+      options_.diurnal_amplitude < 0. || options_.diurnal_amplitude > 1.) {
+    throw std::invalid_argument("Invalid diurnal cycle!");
+  }
+  for (const Burst& burst : options_.bursts) {
+    if (!(burst.rate_multiplier > 0.)) {
+      throw std::invalid_argument("Burst rate multipliers must be positive!");
+    }
+  }
+  ValidateDistribution(options_.shelf_life_s, "shelf life");
+  ValidateDistribution(options_.decay_rate, "decay rate");
+
+  std::vector<double> weights;
+  for (const TemperatureType temp : kTemps) {
+    auto it = options_.temp_mix.find(temp);
+    if (it != options_.temp_mix.end() && it->second > 0.) {
+      temps_.push_back(temp);
+      weights.push_back(it->second);
+    }
+  }
+  if (temps_.empty()) {
+    throw std::invalid_argument("Temperature mix must have a positive weight!");
+  }
+  temp_dist_ = std::discrete_distribution<size_t>(weights.begin(),
+                                                  weights.end());
+}
+
+std::unique_ptr<Order> OrderGenerator::Next() {
+  started_ = true;
+  if (generated_ == options_.order_count) {
+    return nullptr;
+  }
+  if (generated_ > 0) {
+    offset_ = NextArrival();
+  }
+  const TemperatureType temp = temps_[temp_dist_(rand_)];
+  const auto& menu = MenuFor(temp);
+  const std::string& name =
+      menu[std::uniform_int_distribution<size_t>(0, menu.size() - 1)(rand_)];
+  // Zero shelf lives would make values undefined.
+  const int shelf_life_s =
+      std::max(1, static_cast<int>(std::lround(Draw(options_.shelf_life_s))));
+  const double decay_rate = Draw(options_.decay_rate);
+  auto order =
+      Order::CreateOrder(std::to_string(generated_), name, temp, shelf_life_s,
+                         decay_rate, options_.start_time + offset_);
+  if (!options_.regions.empty()) {
+    order->region_ = options_.regions[std::uniform_int_distribution<size_t>(
+        0, options_.regions.size() - 1)(rand_)];
+  }
+  ++generated_;
+  return order;
+}
+
+OrderGenerator::Iterator OrderGenerator::begin() {
+  if (!started_) {
+    Advance();
+  }
+  return Iterator(this);
+}
+
+double OrderGenerator::RateAt(absl::Duration offset) const {
+  double rate = options_.orders_per_second;
+  if (options_.arrival == ArrivalProcess::DIURNAL) {
+    const double phase = 2 * kPi *
+                         absl::FDivDuration(offset - options_.diurnal_peak,
+                                            options_.diurnal_period);
+    rate *= 1. + options_.diurnal_amplitude * std::cos(phase);
+  }
+  const absl::Duration time_of_period = offset % options_.diurnal_period;
+  for (const Burst& burst : options_.bursts) {
+    if (time_of_period >= burst.start &&
+        time_of_period < burst.start + burst.length) {
+      rate *= burst.rate_multiplier;
+    }
+  }
+  return rate;
+}
+
+double OrderGenerator::MaxRate() const {
+  double rate = options_.orders_per_second;
+  if (options_.arrival == ArrivalProcess::DIURNAL) {
+    rate *= 1. + options_.diurnal_amplitude;
+  }
+  // Any set of bursts that overlap is active together from the latest of
+  // their starts, so trying every start finds the largest product.
+  double max_multiplier = 1.;
+  for (const Burst& candidate : options_.bursts) {
+    const absl::Duration at = std::max(candidate.start, absl::ZeroDuration());
+    if (at >= options_.diurnal_period) {
+      continue;
+    }
+    double multiplier = 1.;
+    for (const Burst& burst : options_.bursts) {
+      if (at >= burst.start && at < burst.start + burst.length) {
+        multiplier *= std::max(1., burst.rate_multiplier);
+      }
+    }
+    max_multiplier = std::max(max_multiplier, multiplier);
+  }
+  return rate * max_multiplier;
+}
+
+absl::Duration OrderGenerator::NextArrival() {
+  if (options_.arrival == ArrivalProcess::FIXED) {
+    return offset_ + absl::Seconds(1. / RateAt(offset_));
+  }
+  // Thinning: candidates arrive at the maximum rate and each is kept with
+  // probability proportional to the rate at its time.
+  std::exponential_distribution<double> gap_s(max_rate_);
+  std::uniform_real_distribution<double> keep(0., max_rate_);
+  absl::Duration offset = offset_;
+  do {
+    offset += absl::Seconds(gap_s(rand_));
+  } while (keep(rand_) >= RateAt(offset));
+  return offset;
+}
+
+double OrderGenerator::Draw(const ValueDistribution& distribution) {
+  if (distribution.kind == ValueDistribution::Kind::NORMAL) {
+    return std::max(0., std::normal_distribution<double>(
+                            distribution.a, distribution.b)(rand_));
+  }
+  return std::uniform_real_distribution<double>(distribution.a,
+                                                distribution.b)(rand_);
+}
+
+}  // namespace kitchen_sim
@@ -0,0 +1,177 @@
+#ifndef KITCHEN_SIM_WORKLOAD_ORDER_GENERATOR_H_
+#define KITCHEN_SIM_WORKLOAD_ORDER_GENERATOR_H_
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "model/order.h"
+
+namespace kitchen_sim {
+
+// How gaps between order arrivals are drawn.
+enum class ArrivalProcess {
+  // Exactly 1 / rate apart.
+  FIXED,
+  // Exponentially distributed with mean 1 / rate.
+  POISSON,
+  // Poisson with a rate that rises and falls sinusoidally over each
+  // |diurnal_period|.
+  DIURNAL
+};
+
+// Distribution of a numeric order attribute.
+struct ValueDistribution {
+  enum class Kind {
+    // Uniform over [a, b].
+    UNIFORM,
+    // Normal with mean a and standard deviation b, clamped to non-negative.
+    NORMAL
+  };
+
+  Kind kind = Kind::UNIFORM;
+  double a = 0.;
+  double b = 0.;
+};
+
+// Window of elevated (or depressed) demand, e.g. a lunch rush. Repeats every
+// |diurnal_period|.
+struct Burst {
+  // Offset into each period at which the burst starts.
+  absl::Duration start;
+  absl::Duration length;
+  // Multiplies the arrival rate during the burst.
+  double rate_multiplier = 1.;
+};
+
+// Produces a reproducible stream of synthetic orders in memory, each stamped
+// with its arrival time as its receipt time. Identical options (seed
+// included) always yield identical orders.
+class OrderGenerator {
+ public:
+  struct Options {
+    uint32_t seed = 1;
+    uint64_t order_count = 1000;
+
+    ArrivalProcess arrival = ArrivalProcess::POISSON;
+    // Mean arrival rate before diurnal and burst modulation.
+    double orders_per_second = 2.;
+    // Receipt time of the start of the stream.
+    absl::Time start_time = absl::UnixEpoch();
+
+    // DIURNAL only: the rate swings by +/- |diurnal_amplitude| (in [0, 1])
+    // of |orders_per_second|, peaking |diurnal_peak| into each period.
+    absl::Duration diurnal_period = absl::Hours(24);
+    absl::Duration diurnal_peak = absl::Hours(19);
+    double diurnal_amplitude = 0.5;
+
+    std::vector<Burst> bursts;
+
+    // Relative weight of each temperature group.
+    std::unordered_map<TemperatureType, double> temp_mix = {
+        {TemperatureType::HOT, 1.},
+        {TemperatureType::COLD, 1.},
+        {TemperatureType::FROZEN, 1.},
+    };
+    // Shelf lives are rounded to whole seconds.
+    ValueDistribution shelf_life_s = {ValueDistribution::Kind::UNIFORM, 100.,
+                                      400.};
+    ValueDistribution decay_rate = {ValueDistribution::Kind::UNIFORM, 0.1,
+                                    1.};
+
+    // Routing keys, drawn uniformly. Orders have no region if empty.
+    std::vector<std::string> regions;
+  };
+
+  // Named starting points for Options:
+  // "steady": fixed rate, even temperature mix.
+  // "poisson": Poisson arrivals, even temperature mix.
+  // "rush": diurnal arrivals with lunch and dinner bursts, hot-heavy mix.
+  // Throws std::invalid_argument for any other name.
+  static Options Preset(absl::string_view name);
+
+  // Single-pass input iterator over the remaining orders, like
+  // OrderReader::Iterator.
+  class Iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::unique_ptr<Order>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type*;
+    using reference = value_type&;
+
+    Iterator() = default;
+
+    reference operator*() const { return generator_->current_; }
+    Iterator& operator++() {
+      generator_->Advance();
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+
+    // Only meaningful against end().
+    bool operator==(const Iterator& other) const {
+      return AtEnd() == other.AtEnd();
+    }
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+   private:
+    friend class OrderGenerator;
+    explicit Iterator(OrderGenerator* generator) : generator_(generator) {}
+
+    bool AtEnd() const {
+      return generator_ == nullptr || generator_->current_ == nullptr;
+    }
+
+    OrderGenerator* generator_ = nullptr;
+  };
+
+  // Throws std::invalid_argument if |options| are inconsistent.
+  explicit OrderGenerator(const Options& options);
+  OrderGenerator(OrderGenerator const&) = delete;
+  OrderGenerator& operator=(OrderGenerator const&) = delete;
+
+  // Returns the next order, or nullptr once |order_count| have been
+  // generated.
+  std::unique_ptr<Order> Next();
+
+  // Starts generating on first call; all iterators share this generator's
+  // position.
+  Iterator begin();
+  Iterator end() { return Iterator(); }
+
+ private:
+  // Arrivals per second |offset| into the stream.
+  double RateAt(absl::Duration offset) const;
+  // Upper bound on RateAt(), for thinning: the diurnal peak times the largest
+  // product of multipliers over bursts that overlap, ignoring those below 1.
+  double MaxRate() const;
+  // Offset of the arrival following one at |offset_|.
+  absl::Duration NextArrival();
+  double Draw(const ValueDistribution& distribution);
+
+  void Advance() { current_ = Next(); }
+
+  const Options options_;
+  const double max_rate_;
+
+  std::mt19937_64 rand_;
+  std::vector<TemperatureType> temps_;
+  std::discrete_distribution<size_t> temp_dist_;
+
+  uint64_t generated_ = 0;
+  absl::Duration offset_ = absl::ZeroDuration();
+
+  bool started_ = false;
+  std::unique_ptr<Order> current_;
+};
+
+}  // namespace kitchen_sim
+
+#endif  // KITCHEN_SIM_WORKLOAD_ORDER_GENERATOR_H_
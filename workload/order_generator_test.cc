@@ -0,0 +1,128 @@
+#include "workload/order_generator.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace kitchen_sim {
+
+TEST(OrderGeneratorTest, SameSeedSameOrders) {
+  OrderGenerator::Options options = OrderGenerator::Preset("rush");
+  options.order_count = 100;
+  options.regions = {"north", "south"};
+  OrderGenerator first(options);
+  OrderGenerator second(options);
+  for (int i = 0; i < 100; ++i) {
+    auto a = first.Next();
+    auto b = second.Next();
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    EXPECT_EQ(a->id_, b->id_);
+    EXPECT_EQ(a->name_, b->name_);
+    EXPECT_EQ(a->temp_, b->temp_);
+    EXPECT_EQ(a->shelf_life_s_, b->shelf_life_s_);
+    EXPECT_EQ(a->decay_rate_, b->decay_rate_);
+    EXPECT_EQ(a->receipt_time_, b->receipt_time_);
+    EXPECT_EQ(a->region_, b->region_);
+  }
+  EXPECT_EQ(first.Next(), nullptr);
+}
+
+TEST(OrderGeneratorTest, IteratesOrderCountOrders) {
+  OrderGenerator::Options options;
+  options.order_count = 42;
+  OrderGenerator generator(options);
+  int count = 0;
+  absl::Time last = absl::InfinitePast();
+  for (auto it = generator.begin(); it != generator.end(); ++it) {
+    EXPECT_GE((*it)->receipt_time_, last);
+    last = (*it)->receipt_time_;
+    ++count;
+  }
+  EXPECT_EQ(count, 42);
+}
+
+TEST(OrderGeneratorTest, FixedArrivals) {
+  OrderGenerator::Options options = OrderGenerator::Preset("steady");
+  options.orders_per_second = 4.;
+  options.order_count = 3;
+  OrderGenerator generator(options);
+  std::vector<absl::Time> times;
+  for (auto order = generator.Next(); order != nullptr;
+       order = generator.Next()) {
+    times.push_back(order->receipt_time_);
+  }
+  EXPECT_THAT(times, testing::ElementsAre(
+                         absl::UnixEpoch(),
+                         absl::UnixEpoch() + absl::Milliseconds(250),
+                         absl::UnixEpoch() + absl::Milliseconds(500)));
+}
+
+TEST(OrderGeneratorTest, FollowsTemperatureMix) {
+  OrderGenerator::Options options;
+  options.order_count = 100;
+  options.temp_mix = {{TemperatureType::HOT, 0.}, {TemperatureType::COLD, 1.}};
+  OrderGenerator generator(options);
+  for (auto order = generator.Next(); order != nullptr;
+       order = generator.Next()) {
+    EXPECT_EQ(order->temp_, TemperatureType::COLD);
+  }
+}
+
+TEST(OrderGeneratorTest, BurstsRaiseArrivalRate) {
+  OrderGenerator::Options options;
+  options.order_count = 4000;
+  options.orders_per_second = 1.;
+  options.diurnal_period = absl::Minutes(20);
+  // Ten times the rate for the second half of every period.
+  options.bursts = {{absl::Minutes(10), absl::Minutes(10), 10.}};
+  OrderGenerator generator(options);
+  int in_burst = 0;
+  for (auto order = generator.Next(); order != nullptr;
+       order = generator.Next()) {
+    if ((order->receipt_time_ - absl::UnixEpoch()) % options.diurnal_period >=
+        absl::Minutes(10)) {
+      ++in_burst;
+    }
+  }
+  EXPECT_GT(in_burst, 4000 * 0.85);
+  EXPECT_LT(in_burst, 4000 * 0.97);
+}
+
+TEST(OrderGeneratorTest, OverlappingBurstsCompound) {
+  OrderGenerator::Options options;
+  options.order_count = 7500;
+  options.orders_per_second = 1.;
+  options.diurnal_period = absl::Minutes(20);
+  // Four times the rate for minutes 0-15 of every period, and sixteen times
+  // where the two bursts overlap.
+  options.bursts = {{absl::ZeroDuration(), absl::Minutes(10), 4.},
+                    {absl::Minutes(5), absl::Minutes(10), 4.}};
+  OrderGenerator generator(options);
+  int in_overlap = 0;
+  for (auto order = generator.Next(); order != nullptr;
+       order = generator.Next()) {
+    const absl::Duration time_of_period =
+        (order->receipt_time_ - absl::UnixEpoch()) % options.diurnal_period;
+    if (time_of_period >= absl::Minutes(5) &&
+        time_of_period < absl::Minutes(10)) {
+      ++in_overlap;
+    }
+  }
+  // 4800 of every 7500 orders.
+  EXPECT_GT(in_overlap, 7500 * 0.6);
+  EXPECT_LT(in_overlap, 7500 * 0.68);
+}
+
+TEST(OrderGeneratorTest, RejectsInvalidOptions) {
+  OrderGenerator::Options options;
+  options.orders_per_second = 0.;
+  EXPECT_THROW(OrderGenerator{options}, std::invalid_argument);
+
+  options = OrderGenerator::Options();
+  options.temp_mix = {};
+  EXPECT_THROW(OrderGenerator{options}, std::invalid_argument);
+
+  EXPECT_THROW(OrderGenerator::Preset("brunch"), std::invalid_argument);
+}
+
+}  // namespace kitchen_sim